@@ -0,0 +1,594 @@
+#include "supernova.h"
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    using Opcodes = supernova::inspx;
+    using decoded_instruction = supernova::decoded_instruction;
+    using namespace supernova::headers;
+
+    /**
+     * @brief range of memory holding executable code
+     */
+    struct code_range
+    {
+        uint64_t start; /**< first byte */
+        uint64_t end;   /**< byte after the last one */
+    };
+
+    /**
+     * @brief everything known about an image before emitting code
+     */
+    struct program
+    {
+        uint8_t const *memory;                               /**< image memory */
+        std::vector<code_range> code;                        /**< executable regions */
+        std::map<uint64_t, decoded_instruction> reachable{}; /**< instructions found from the entry point */
+        std::set<uint64_t> targets{};                        /**< addresses reached by direct jumps */
+    };
+
+    [[nodiscard]] auto is_code(program const &prog, uint64_t address) -> bool
+    {
+        for (auto const &range : prog.code)
+        {
+            if (address >= range.start && address < range.end && range.end - address >= sizeof(uint64_t))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief check if an instruction has a native translation, everything else is interpreted
+     */
+    [[nodiscard]] auto is_native(Opcodes opcode) -> bool
+    {
+        switch (opcode)
+        {
+        case Opcodes::andr_instrc: case Opcodes::andi_instrc: case Opcodes::xorr_instrc: case Opcodes::xori_instrc:
+        case Opcodes::orr_instrc: case Opcodes::ori_instrc: case Opcodes::not_instrc: case Opcodes::cnt_instrc:
+        case Opcodes::llsr_instrc: case Opcodes::llsi_instrc: case Opcodes::lrsr_instrc: case Opcodes::lrsi_instrc:
+        case Opcodes::addr_instrc: case Opcodes::addi_instrc: case Opcodes::subr_instrc: case Opcodes::subi_instrc:
+        case Opcodes::umulr_instrc: case Opcodes::umuli_instrc: case Opcodes::smulr_instrc: case Opcodes::smuli_instrc:
+        case Opcodes::ld_byte_instrc: case Opcodes::ld_half_instrc: case Opcodes::ld_word_instrc: case Opcodes::ld_dwrd_instrc:
+        case Opcodes::st_byte_instrc: case Opcodes::st_half_instrc: case Opcodes::st_word_instrc: case Opcodes::st_dwrd_instrc:
+        case Opcodes::jal_instrc: case Opcodes::jalr_instrc: case Opcodes::je_instrc: case Opcodes::jne_instrc:
+        case Opcodes::jgu_instrc: case Opcodes::jgs_instrc: case Opcodes::jleu_instrc: case Opcodes::jles_instrc:
+        case Opcodes::setgur_instrc: case Opcodes::setgui_instrc: case Opcodes::setgsr_instrc: case Opcodes::setgsi_instrc:
+        case Opcodes::setleur_instrc: case Opcodes::setleui_instrc: case Opcodes::setlesr_instrc: case Opcodes::setlesi_instrc:
+        case Opcodes::lui_instrc: case Opcodes::auipc_instrc:
+        case Opcodes::cmovz_instrc: case Opcodes::cmovnz_instrc: case Opcodes::cmovgs_instrc: case Opcodes::cmovles_instrc:
+        case Opcodes::cmovzi_instrc: case Opcodes::cmovnzi_instrc:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief walk every instruction statically reachable from the entry point
+     *
+     * indirect jumps have no known successor, but the address their link
+     * register points to is still followed as it is the usual return site
+     */
+    void discover(program &prog, uint64_t entry_point)
+    {
+        std::deque<uint64_t> pending{entry_point};
+
+        while (!pending.empty())
+        {
+            const auto address = pending.front();
+            pending.pop_front();
+
+            if (prog.reachable.count(address) != 0 || !is_code(prog, address))
+            {
+                continue;
+            }
+
+            uint64_t raw = 0;
+            std::memcpy(&raw, prog.memory + address, sizeof(raw));
+            const auto instr = supernova::decode(raw, address);
+            prog.reachable.emplace(address, instr);
+
+            const auto next = address + sizeof(uint64_t);
+
+            switch (instr.opcode)
+            {
+            case Opcodes::jal_instrc:
+                prog.targets.insert(next + static_cast<uint64_t>(instr.imm));
+                pending.push_back(next + static_cast<uint64_t>(instr.imm));
+                pending.push_back(next + sizeof(uint64_t));
+                break;
+            case Opcodes::je_instrc:
+            case Opcodes::jne_instrc:
+            case Opcodes::jgu_instrc:
+            case Opcodes::jgs_instrc:
+            case Opcodes::jleu_instrc:
+            case Opcodes::jles_instrc:
+                prog.targets.insert(next + static_cast<uint64_t>(instr.imm));
+                pending.push_back(next + static_cast<uint64_t>(instr.imm));
+                pending.push_back(next);
+                break;
+            case Opcodes::jalr_instrc:
+            case Opcodes::call_instrc:
+                // the callee returns past the instruction after the call
+                pending.push_back(next + sizeof(uint64_t));
+                break;
+            case Opcodes::retn_instrc:
+                break;
+            case Opcodes::pcall_instrc:
+                if (instr.imm != supernova::ProcessorCall::Halt)
+                {
+                    pending.push_back(next);
+                }
+                break;
+            default:
+                pending.push_back(next);
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief FNV-1a over the executable regions, checked before trusting translated code
+     */
+    [[nodiscard]] auto checksum(program const &prog) -> uint64_t
+    {
+        constexpr uint64_t offset_basis = 0xCBF29CE484222325LLU;
+        constexpr uint64_t prime = 0x100000001B3LLU;
+
+        auto hash = offset_basis;
+        for (auto const &range : prog.code)
+        {
+            for (auto address = range.start; address < range.end; ++address)
+            {
+                hash = (hash ^ prog.memory[address]) * prime;
+            }
+        }
+        return hash;
+    }
+
+    /**
+     * @brief writes the generated C++ for a program
+     */
+    class generator
+    {
+    public:
+        generator(program const &prog, std::ostream &output) : m_prog{prog}, m_out{output} {}
+
+        void emit(char const *filename, uint64_t memory_size, supernova::aot::translation_stats &stats)
+        {
+            header(filename, memory_size);
+
+            for (auto it = m_prog.reachable.begin(); it != m_prog.reachable.end(); ++it)
+            {
+                auto const &[address, instr] = *it;
+                auto next = std::next(it);
+                const auto falls_through = next != m_prog.reachable.end() && next->first == address + sizeof(uint64_t);
+
+                m_out << "            case 0x" << std::hex << address << "LLU:\n";
+                if (m_prog.targets.count(address) != 0)
+                {
+                    m_out << "            i_" << address << ":\n";
+                }
+                m_out << std::dec;
+
+                // jumps and falling onto another page skip the check done before the switch
+                const auto last_page = (address + sizeof(uint64_t) - 1) >> supernova::Thread::code_page_bits;
+                if (m_prog.targets.count(address) != 0 || address == 0 || last_page != (address - 1) >> supernova::Thread::code_page_bits)
+                {
+                    line("if (thread.code_written() && stale(pages, " + hex(address) + "))");
+                    line("{");
+                    line("    interpret(thread, " + hex(address) + ");");
+                    line("    continue;");
+                    line("}");
+                }
+
+                if (is_native(instr.opcode))
+                {
+                    ++stats.translated;
+                    native(instr, address);
+                }
+                else
+                {
+                    ++stats.interpreted;
+                    line("interpret(thread, " + hex(address) + ");");
+                    line("continue;");
+                    continue;
+                }
+
+                if (ends_flow(instr.opcode))
+                {
+                    continue;
+                }
+
+                if (falls_through)
+                {
+                    line("[[fallthrough]];");
+                }
+                else
+                {
+                    leave(address + sizeof(uint64_t));
+                }
+            }
+
+            stats.instructions = m_prog.reachable.size();
+            footer();
+        }
+
+    private:
+        static auto hex(uint64_t value) -> std::string
+        {
+            std::ostringstream stream;
+            stream << "0x" << std::hex << value << "LLU";
+            return stream.str();
+        }
+
+        static auto reg(uint8_t index) -> std::string { return "regs[" + std::to_string(index) + "]"; }
+
+        static auto ends_flow(Opcodes opcode) -> bool
+        {
+            return opcode == Opcodes::jal_instrc || opcode == Opcodes::jalr_instrc;
+        }
+
+        void line(std::string const &text) { m_out << "                " << text << '\n'; }
+
+        /** write to a register, r0 always stays zero */
+        void assign(uint8_t index, std::string const &value)
+        {
+            if (index != 0)
+            {
+                line(reg(index) + " = " + value + ";");
+            }
+        }
+
+        /** continue on a known address, jumping straight to it if it was translated */
+        void leave(uint64_t target)
+        {
+            if (m_prog.reachable.count(target) != 0 && m_prog.targets.count(target) != 0)
+            {
+                m_out << "                goto i_" << std::hex << target << std::dec << ";\n";
+                return;
+            }
+            line("thread.progc() = " + hex(target) + ";");
+            line("continue;");
+        }
+
+        void access(decoded_instruction const &instr, uint64_t address, uint8_t base, unsigned size)
+        {
+            line("address = " + reg(base) + " + " + hex(static_cast<uint64_t>(instr.imm)) + ";");
+            line("if (address >= memsize || memsize - address < " + std::to_string(size) + ")");
+            line("{");
+            line("    interpret(thread, " + hex(address) + ");");
+            line("    continue;");
+            line("}");
+        }
+
+        void native(decoded_instruction const &instr, uint64_t address)
+        {
+            const auto next = address + sizeof(uint64_t);
+            const auto r1 = reg(instr.r1);
+            const auto r2 = reg(instr.r2);
+            const auto uimm = hex(instr.uimm);
+            const auto simm = hex(static_cast<uint64_t>(instr.imm));
+            const auto signed_reg = [](std::string const &value) { return "static_cast<int64_t>(" + value + ")"; };
+
+            switch (instr.opcode)
+            {
+            case Opcodes::andr_instrc: assign(instr.rd, r1 + " & " + r2); break;
+            case Opcodes::andi_instrc: assign(instr.rd, r1 + " & " + uimm); break;
+            case Opcodes::xorr_instrc: assign(instr.rd, r1 + " ^ " + r2); break;
+            case Opcodes::xori_instrc: assign(instr.rd, r1 + " ^ " + uimm); break;
+            case Opcodes::orr_instrc: assign(instr.rd, r1 + " | " + r2); break;
+            case Opcodes::ori_instrc: assign(instr.rd, r1 + " | " + uimm); break;
+            case Opcodes::not_instrc: assign(instr.rd, "~" + r1); break;
+            case Opcodes::cnt_instrc: assign(instr.rd, "supernova::helpers::popcount(" + r1 + ", " + uimm + ")"); break;
+            case Opcodes::llsr_instrc: assign(instr.rd, "supernova::helpers::left_shift(" + r1 + ", " + r2 + ")"); break;
+            case Opcodes::llsi_instrc: assign(instr.rd, "supernova::helpers::left_shift(" + r1 + ", " + uimm + ")"); break;
+            case Opcodes::lrsr_instrc: assign(instr.rd, "supernova::helpers::right_shift(" + r1 + ", " + r2 + ")"); break;
+            case Opcodes::lrsi_instrc: assign(instr.rd, "supernova::helpers::right_shift(" + r1 + ", " + uimm + ")"); break;
+            case Opcodes::addr_instrc: assign(instr.rd, r1 + " + " + r2); break;
+            case Opcodes::addi_instrc: assign(instr.rd, r1 + " + " + uimm); break;
+            case Opcodes::subr_instrc: assign(instr.rd, r1 + " - " + r2); break;
+            case Opcodes::subi_instrc: assign(instr.rd, r1 + " - " + uimm); break;
+            // the low 64 bits are the same for signed and unsigned multiplication
+            case Opcodes::umulr_instrc: assign(instr.rd, r1 + " * " + r2); break;
+            case Opcodes::umuli_instrc: assign(instr.rd, r1 + " * " + uimm); break;
+            case Opcodes::smulr_instrc: assign(instr.rd, r1 + " * " + r2); break;
+            case Opcodes::smuli_instrc: assign(instr.rd, r1 + " * " + simm); break;
+            /**/
+            case Opcodes::setgur_instrc: assign(instr.rd, "static_cast<uint64_t>(" + r1 + " > " + r2 + ")"); break;
+            case Opcodes::setgui_instrc: assign(instr.rd, "static_cast<uint64_t>(" + r1 + " > " + uimm + ")"); break;
+            case Opcodes::setgsr_instrc: assign(instr.rd, "static_cast<uint64_t>(" + signed_reg(r1) + " > " + signed_reg(r2) + ")"); break;
+            case Opcodes::setgsi_instrc: assign(instr.rd, "static_cast<uint64_t>(" + signed_reg(r1) + " > " + signed_reg(simm) + ")"); break;
+            case Opcodes::setleur_instrc: assign(instr.rd, "static_cast<uint64_t>(" + r1 + " <= " + r2 + ")"); break;
+            case Opcodes::setleui_instrc: assign(instr.rd, "static_cast<uint64_t>(" + r1 + " <= " + uimm + ")"); break;
+            case Opcodes::setlesr_instrc: assign(instr.rd, "static_cast<uint64_t>(" + signed_reg(r1) + " <= " + signed_reg(r2) + ")"); break;
+            case Opcodes::setlesi_instrc: assign(instr.rd, "static_cast<uint64_t>(" + signed_reg(r1) + " <= " + signed_reg(simm) + ")"); break;
+            case Opcodes::cmovz_instrc: assign(instr.rd, r2 + " == 0 ? " + r1 + " : " + reg(instr.rd)); break;
+            case Opcodes::cmovnz_instrc: assign(instr.rd, r2 + " != 0 ? " + r1 + " : " + reg(instr.rd)); break;
+            case Opcodes::cmovgs_instrc: assign(instr.rd, signed_reg(r2) + " > 0 ? " + r1 + " : " + reg(instr.rd)); break;
+            case Opcodes::cmovles_instrc: assign(instr.rd, signed_reg(r2) + " <= 0 ? " + r1 + " : " + reg(instr.rd)); break;
+            case Opcodes::cmovzi_instrc: assign(instr.rd, r1 + " == 0 ? " + simm + " : " + reg(instr.rd)); break;
+            case Opcodes::cmovnzi_instrc: assign(instr.rd, r1 + " != 0 ? " + simm + " : " + reg(instr.rd)); break;
+            case Opcodes::lui_instrc: assign(instr.r1, r1 + " | " + hex(static_cast<uint64_t>(instr.imm) << 13U)); break;
+            case Opcodes::auipc_instrc: assign(instr.r1, hex(next + (static_cast<uint64_t>(instr.imm) << 13U))); break;
+            /**/
+            case Opcodes::ld_byte_instrc:
+            case Opcodes::ld_half_instrc:
+            case Opcodes::ld_word_instrc:
+            case Opcodes::ld_dwrd_instrc:
+            {
+                static const char *const types[] = {"uint8_t", "uint16_t", "uint32_t", "uint64_t"};
+                const auto width = instr.opcode - Opcodes::ld_byte_instrc;
+                access(instr, address, instr.r1, 1U << width);
+                if (instr.rd != 0)
+                {
+                    line("regs[" + std::to_string(instr.rd) + "] = load<" + types[width] + ">(memory, address);");
+                }
+                break;
+            }
+            case Opcodes::st_byte_instrc:
+            case Opcodes::st_half_instrc:
+            case Opcodes::st_word_instrc:
+            case Opcodes::st_dwrd_instrc:
+            {
+                static const char *const types[] = {"uint8_t", "uint16_t", "uint32_t", "uint64_t"};
+                const auto width = instr.opcode - Opcodes::st_byte_instrc;
+                access(instr, address, instr.rd, 1U << width);
+                line("if (in_code(address, " + std::to_string(1U << width) + ") || in_vector(thread, address, " + std::to_string(1U << width) + "))");
+                line("{");
+                line("    // code writing over itself or the interrupt vector, the interpreter drops what went stale");
+                line("    interpret(thread, " + hex(address) + ");");
+                line("    continue;");
+                line("}");
+                line("store<" + std::string(types[width]) + ">(memory, address, " + r1 + ");");
+                break;
+            }
+            /**/
+            case Opcodes::jal_instrc:
+                assign(instr.r1, hex(next + sizeof(uint64_t)));
+                leave(next + static_cast<uint64_t>(instr.imm));
+                break;
+            case Opcodes::jalr_instrc:
+                // indirect, goes back through the address switch. the interpreter links
+                // first, `jalr rX, rX` jumps relative to the link (r0 included)
+                if (instr.rd == instr.r1)
+                {
+                    line("thread.progc() = " + hex(next + static_cast<uint64_t>(instr.imm) + next + sizeof(uint64_t)) + ";");
+                }
+                else
+                {
+                    line("thread.progc() = " + hex(next + static_cast<uint64_t>(instr.imm)) + " + " + r1 + ";");
+                }
+                assign(instr.rd, hex(next + sizeof(uint64_t)));
+                line("continue;");
+                break;
+            case Opcodes::je_instrc:
+            case Opcodes::jne_instrc:
+            case Opcodes::jgu_instrc:
+            case Opcodes::jgs_instrc:
+            case Opcodes::jleu_instrc:
+            case Opcodes::jles_instrc:
+            {
+                static const char *const comparisons[] = {" == ", " != ", " > ", " > ", " <= ", " <= "};
+                const auto index = instr.opcode - Opcodes::je_instrc;
+                const auto is_signed = instr.opcode == Opcodes::jgs_instrc || instr.opcode == Opcodes::jles_instrc;
+                const auto left = is_signed ? signed_reg(reg(instr.rd)) : reg(instr.rd);
+                const auto right = is_signed ? signed_reg(r1) : r1;
+                line("if (" + left + comparisons[index] + right + ")");
+                line("{");
+                m_out << "    ";
+                leave(next + static_cast<uint64_t>(instr.imm));
+                line("}");
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        void header(char const *filename, uint64_t memory_size)
+        {
+            m_out << "// generated by snvm-aot from \"" << filename << "\", changes will be overwritten\n"
+                  << "#include \"supernova.h\"\n"
+                  << "#include <cstring>\n"
+                  << "#include <iostream>\n"
+                  << "#include <vector>\n"
+                  << "\n"
+                  << "namespace\n"
+                  << "{\n"
+                  << "    constexpr auto image_name = \"" << filename << "\";\n"
+                  << "    constexpr uint64_t image_memory_size = " << hex(memory_size) << ";\n"
+                  << "    constexpr uint64_t image_checksum = " << hex(checksum(m_prog)) << ";\n"
+                  << "\n"
+                  << "    struct code_range\n"
+                  << "    {\n"
+                  << "        uint64_t start;\n"
+                  << "        uint64_t end;\n"
+                  << "    };\n"
+                  << "\n"
+                  << "    constexpr code_range code_ranges[] = {\n";
+            for (auto const &range : m_prog.code)
+            {
+                m_out << "        {" << hex(range.start) << ", " << hex(range.end) << "},\n";
+            }
+            m_out << "    };\n"
+                  << "\n"
+                  << "    auto checksum(uint8_t const *memory) -> uint64_t\n"
+                  << "    {\n"
+                  << "        auto hash = 0xCBF29CE484222325LLU;\n"
+                  << "        for (auto const &range : code_ranges)\n"
+                  << "        {\n"
+                  << "            for (auto address = range.start; address < range.end; ++address)\n"
+                  << "            {\n"
+                  << "                hash = (hash ^ memory[address]) * 0x100000001B3LLU;\n"
+                  << "            }\n"
+                  << "        }\n"
+                  << "        return hash;\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    [[maybe_unused]] auto in_code(uint64_t address, uint64_t size) -> bool\n"
+                  << "    {\n"
+                  << "        for (auto const &range : code_ranges)\n"
+                  << "        {\n"
+                  << "            if (address < range.end && address + size > range.start)\n"
+                  << "            {\n"
+                  << "                return true;\n"
+                  << "            }\n"
+                  << "        }\n"
+                  << "        return false;\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    /** check if a store may change a handler the thread cached from its interrupt vector */\n"
+                  << "    [[maybe_unused]] auto in_vector(supernova::Thread &thread, uint64_t address, uint64_t size) -> bool\n"
+                  << "    {\n"
+                  << "        constexpr auto span = supernova::Thread::vector_cache_size * sizeof(uint64_t);\n"
+                  << "        const auto base = thread.intvec();\n"
+                  << "        return address >= base ? address - base < span : base - address < size;\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    template <typename integer>\n"
+                  << "    auto load(uint8_t const *memory, uint64_t address) -> uint64_t\n"
+                  << "    {\n"
+                  << "        integer value{};\n"
+                  << "        std::memcpy(&value, memory + address, sizeof(value));\n"
+                  << "        return value;\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    template <typename integer>\n"
+                  << "    void store(uint8_t *memory, uint64_t address, uint64_t value)\n"
+                  << "    {\n"
+                  << "        const auto narrow = static_cast<integer>(value);\n"
+                  << "        std::memcpy(memory + address, &narrow, sizeof(narrow));\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    /** check if translated code at an address was written to after translation */\n"
+                  << "    [[maybe_unused]] auto stale(std::vector<uint8_t> const &pages, uint64_t address) -> bool\n"
+                  << "    {\n"
+                  << "        constexpr auto bits = supernova::Thread::code_page_bits;\n"
+                  << "        for (auto page = address >> bits; page <= (address + sizeof(uint64_t) - 1) >> bits && page < pages.size(); ++page)\n"
+                  << "        {\n"
+                  << "            if (pages[page] == supernova::Thread::code_page_written)\n"
+                  << "            {\n"
+                  << "                return true;\n"
+                  << "            }\n"
+                  << "        }\n"
+                  << "        return false;\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    void interpret(supernova::Thread &thread, uint64_t address)\n"
+                  << "    {\n"
+                  << "        thread.progc() = address;\n"
+                  << "        supernova::run(0, nullptr, thread, true);\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    /** run translated code, code on pages written to since is interpreted */\n"
+                  << "    void run_native(supernova::Thread &thread)\n"
+                  << "    {\n"
+                  << "        auto &regs = thread.allregs();\n"
+                  << "        [[maybe_unused]] auto *memory = thread.memory().get();\n"
+                  << "        [[maybe_unused]] const auto memsize = thread.memsize();\n"
+                  << "        [[maybe_unused]] uint64_t address = 0;\n"
+                  << "\n"
+                  << "        // interpreted stores and pushes mark the pages, the same way they do for the jit\n"
+                  << "        constexpr auto bits = supernova::Thread::code_page_bits;\n"
+                  << "        std::vector<uint8_t> pages((memsize >> bits) + 2, 0);\n"
+                  << "        for (auto const &range : code_ranges)\n"
+                  << "        {\n"
+                  << "            for (auto page = range.start >> bits; range.end > range.start && page <= (range.end - 1) >> bits; ++page)\n"
+                  << "            {\n"
+                  << "                pages[page] = supernova::Thread::code_page_translated;\n"
+                  << "            }\n"
+                  << "        }\n"
+                  << "        thread.watch_code(pages.data());\n"
+                  << "\n"
+                  << "        // translated code accesses memory directly, paged threads go back to the interpreter\n"
+                  << "        while (thread.signal() == supernova::DoNotDestroy && !thread.paging())\n"
+                  << "        {\n"
+                  << "            if (thread.code_written() && stale(pages, thread.progc()))\n"
+                  << "            {\n"
+                  << "                interpret(thread, thread.progc());\n"
+                  << "                continue;\n"
+                  << "            }\n"
+                  << "\n"
+                  << "            switch (thread.progc())\n"
+                  << "            {\n";
+        }
+
+        void footer()
+        {
+            m_out << "            default:\n"
+                  << "                interpret(thread, thread.progc());\n"
+                  << "                continue;\n"
+                  << "            }\n"
+                  << "        }\n"
+                  << "\n"
+                  << "        thread.watch_code(nullptr);\n"
+                  << "    }\n"
+                  << "} // namespace\n"
+                  << "\n"
+                  << "int main(int argc, char **argv)\n"
+                  << "{\n"
+                  << "    auto file_info = supernova::headers::read_file(argc > 1 ? argv[1] : image_name);\n"
+                  << "\n"
+                  << "    if (file_info.status != supernova::headers::read_status::ReadOk)\n"
+                  << "    {\n"
+                  << "        std::cerr << \"could not run file, status code = \" << static_cast<int>(file_info.status) << '\\n';\n"
+                  << "        return file_info.status;\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    auto thread = supernova::Thread(std::move(file_info.memory_pointer), file_info.memory_size, nullptr, file_info.entry_point);\n"
+                  << "    thread.registers(supernova::Thread::pcall_1stret) = 0;\n"
+                  << "    thread.registers(supernova::Thread::pcall_2ndret) = 0;\n"
+                  << "\n"
+                  << "    // a different image only gets interpreted\n"
+                  << "    if (thread.memsize() == image_memory_size && checksum(thread.memory().get()) == image_checksum)\n"
+                  << "    {\n"
+                  << "        run_native(thread);\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    while (thread.signal() == supernova::DoNotDestroy)\n"
+                  << "    {\n"
+                  << "        supernova::dispatch(thread, supernova::default_dispatch(), ~0LLU);\n"
+                  << "    }\n"
+                  << "\n"
+                  << "    return thread.signal() == supernova::ProgramEnd ? static_cast<int>(thread.registers(1)) : thread.signal();\n"
+                  << "}\n";
+        }
+
+        program const &m_prog;
+        std::ostream &m_out;
+    };
+} // namespace
+
+namespace supernova::aot
+{
+    auto translate(headers::read_return const &image, char const *filename, std::ostream &output) -> translation_stats
+    {
+        translation_stats stats{};
+        program prog{image.memory_pointer.get(), {}};
+
+        for (uint64_t i = 0; i < image.region_count; ++i)
+        {
+            auto const &region = image.regions[i];
+            if ((region.flags & mem_exists) != 0 && (region.flags & mem_execute) != 0)
+            {
+                prog.code.push_back({region.offset, region.offset + region.size});
+            }
+        }
+
+        discover(prog, image.entry_point);
+        generator{prog, output}.emit(filename, image.memory_size, stats);
+
+        return stats;
+    }
+} // namespace supernova::aot
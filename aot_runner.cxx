@@ -0,0 +1,42 @@
+#include "supernova.h"
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#ifndef SUPERNOVA_VERSION
+#define SUPERNOVA_VERSION ""
+#endif
+
+[[gnu::cold]]
+void print_help() {
+    std::cout <<
+        "Supernova v" SUPERNOVA_VERSION ": Zenith ahead of time translator\n"
+        " usage: snvm-aot \"executable name\" \"output file\"\n"
+        "options:\n"
+        "  -h --help           | display this help\n";
+}
+
+int main(int argc, char ** argv) {
+    if (argc != 3 || argv[1] == std::string_view("-h") || argv[1] == std::string_view("--help")) {
+        print_help();
+        return argc != 3;
+    }
+
+    auto file_info = supernova::headers::read_file(argv[1]);
+
+    if (file_info.status != supernova::headers::read_status::ReadOk) {
+        std::cerr << "could not read file, status code = " << static_cast<int>(file_info.status) << '\n';
+        return file_info.status;
+    }
+
+    std::ofstream output(argv[2]);
+    if (!output) {
+        std::cerr << "could not open \"" << argv[2] << "\" for writing\n";
+        return 1;
+    }
+
+    const auto stats = supernova::aot::translate(file_info, argv[1], output);
+
+    std::cout << argv[1] << ": " << stats.instructions << " reachable instructions, "
+              << stats.translated << " translated, " << stats.interpreted << " interpreted\n";
+    return 0;
+}
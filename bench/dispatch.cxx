@@ -0,0 +1,152 @@
+#include "../supernova.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+/// compares instructions per second between dispatch engines, running the same images on each
+
+using namespace supernova;
+
+namespace
+{
+    struct workload
+    {
+        const char *name;
+        std::vector<uint64_t> code;
+    };
+
+    /**
+     * @brief write code into an image readable by `headers::read_file`
+     *
+     * @param filename file to write
+     * @param code instructions, loaded at address 0
+     * @param memory_size memory the image asks for
+     */
+    void write_image(std::string const &filename, std::vector<uint64_t> const &code, uint64_t memory_size)
+    {
+        using namespace supernova::headers;
+
+        const main_header main{master_magic, snvm_version, memory_size, 0, 1};
+        const memory_map region{
+            memmap_magic,
+            sizeof(main_header) + sizeof(memory_map),
+            code.size() * sizeof(uint64_t),
+            0,
+            static_cast<memory_flags>(mem_exists | mem_read | mem_execute),
+        };
+
+        auto file = std::ofstream(filename, std::ios::binary);
+        file.write(reinterpret_cast<char const *>(&main), sizeof(main));
+        file.write(reinterpret_cast<char const *>(&region), sizeof(region));
+        file.write(reinterpret_cast<char const *>(code.data()), static_cast<std::streamsize>(code.size() * sizeof(uint64_t)));
+    }
+
+    auto raw(RInstruction instr) { return static_cast<uint64_t>(instr); }
+    auto raw(SInstruction instr) { return static_cast<uint64_t>(instr); }
+    auto raw(LInstruction instr) { return static_cast<uint64_t>(instr); }
+
+    constexpr auto halt = LInstruction(pcall_instrc, 0, ProcessorCall::Halt);
+    constexpr uint64_t iterations = 4'000'000;
+
+    /** register only loop, r3 counts up to r6 */
+    auto alu_loop() -> workload
+    {
+        return {"alu", {
+            raw(SInstruction(addi_instrc, 0, 6, iterations)),
+            raw(SInstruction(addi_instrc, 4, 4, 3)),
+            raw(RInstruction(xorr_instrc, 5, 4, 5)),
+            raw(SInstruction(llsi_instrc, 5, 7, 1)),
+            raw(RInstruction(addr_instrc, 7, 4, 8)),
+            raw(SInstruction(andi_instrc, 8, 9, 0xFFFF)),
+            raw(SInstruction(addi_instrc, 3, 3, 1)),
+            raw(SInstruction(jne_instrc, 6, 3, -7 * sizeof(uint64_t))),
+            raw(halt),
+        }};
+    }
+
+    /** load, update and store a counter in memory */
+    auto memory_loop() -> workload
+    {
+        return {"memory", {
+            raw(SInstruction(addi_instrc, 0, 6, iterations)),
+            raw(SInstruction(addi_instrc, 0, 10, 0x100)),
+            raw(SInstruction(ld_dwrd_instrc, 10, 4, 0)),
+            raw(SInstruction(addi_instrc, 4, 4, 1)),
+            raw(SInstruction(st_dwrd_instrc, 4, 10, 0)),
+            raw(SInstruction(ld_byte_instrc, 10, 5, 0)),
+            raw(SInstruction(addi_instrc, 3, 3, 1)),
+            raw(SInstruction(jne_instrc, 6, 3, -6 * sizeof(uint64_t))),
+            raw(halt),
+        }};
+    }
+
+    auto engine_name(dispatch_engine engine) -> const char *
+    {
+        switch (engine)
+        {
+        case SwitchDispatch:
+            return "switch";
+        case TailCallDispatch:
+            return "tailcall";
+        case GotoDispatch:
+            return "goto";
+        case BlockDispatch:
+            return "block";
+        }
+        return "unknown";
+    }
+} // namespace
+
+int main()
+{
+    std::cout << "default engine: " << engine_name(default_dispatch()) << "\n\n"
+              << std::left << std::setw(10) << "image" << std::setw(10) << "engine" << std::setw(10) << "memory"
+              << std::right << std::setw(14) << "instructions" << std::setw(12) << "seconds" << std::setw(16) << "instr/s" << '\n';
+
+    for (auto const &work : {alu_loop(), memory_loop()})
+    {
+        const auto filename = std::string("dispatch_") + work.name + ".spn";
+        write_image(filename, work.code, 0x1000);
+
+        for (auto engine : {SwitchDispatch, TailCallDispatch, GotoDispatch, BlockDispatch})
+        {
+            if (!dispatch_available(engine))
+            {
+                continue;
+            }
+
+            for (auto backend : {CheckedMemory, GuardedMemory})
+            {
+                auto image = headers::read_file(filename.c_str());
+                if (image.status != headers::ReadOk)
+                {
+                    std::cerr << "could not read " << filename << ", status code = " << static_cast<int>(image.status) << '\n';
+                    return 1;
+                }
+
+                auto thread = Thread(std::move(image.memory_pointer), image.memory_size, nullptr, image.entry_point);
+                if (backend == GuardedMemory && !thread.use_guard_pages())
+                {
+                    continue;
+                }
+
+                const auto start = std::chrono::steady_clock::now();
+                uint64_t executed = 0;
+                while (thread.signal() == DoNotDestroy)
+                {
+                    executed += dispatch(thread, engine, ~0LLU);
+                }
+                const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                std::cout << std::left << std::setw(10) << work.name << std::setw(10) << engine_name(engine)
+                          << std::setw(10) << (backend == GuardedMemory ? "guarded" : "checked")
+                          << std::right << std::setw(14) << executed << std::setw(12) << std::fixed << std::setprecision(4) << seconds
+                          << std::setw(16) << std::setprecision(0) << static_cast<double>(executed) / seconds << '\n';
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "../supernova.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+/// measures how instructions per second scale with the amount of scheduler workers
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x1000;
+    constexpr auto instances = 256;
+    constexpr uint64_t iterations = 100'000;
+
+    auto raw(RInstruction instr) { return static_cast<uint64_t>(instr); }
+    auto raw(SInstruction instr) { return static_cast<uint64_t>(instr); }
+    auto raw(LInstruction instr) { return static_cast<uint64_t>(instr); }
+
+    /** register and memory loop, every instance touches its own memory */
+    auto make_thread() -> std::unique_ptr<Thread>
+    {
+        const std::vector<uint64_t> code{
+            raw(SInstruction(addi_instrc, 0, 6, iterations)),
+            raw(SInstruction(addi_instrc, 0, 10, 0x800)),
+            raw(SInstruction(ld_dwrd_instrc, 10, 4, 0)),
+            raw(RInstruction(xorr_instrc, 4, 3, 5)),
+            raw(SInstruction(addi_instrc, 5, 4, 1)),
+            raw(SInstruction(st_dwrd_instrc, 4, 10, 0)),
+            raw(SInstruction(addi_instrc, 3, 3, 1)),
+            raw(SInstruction(jne_instrc, 6, 3, -6 * sizeof(uint64_t))),
+            raw(LInstruction(pcall_instrc, 0, ProcessorCall::Halt)),
+        };
+
+        auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[memory_size]{});
+        std::copy(code.begin(), code.end(), reinterpret_cast<uint64_t *>(memory.get()));
+        return std::make_unique<Thread>(std::move(memory), memory_size, nullptr);
+    }
+} // namespace
+
+int main()
+{
+    const auto hardware = std::max(1U, std::thread::hardware_concurrency());
+    const auto total = static_cast<double>(instances * (2 + iterations * 6 + 1));
+
+    std::cout << instances << " instances, " << hardware << " hardware threads, quantum " << scheduler::default_quantum << "\n\n"
+              << std::right << std::setw(8) << "workers" << std::setw(12) << "seconds" << std::setw(16) << "instr/s" << std::setw(10) << "speedup" << '\n';
+
+    double baseline = 0;
+    for (unsigned workers = 1; workers <= std::max(hardware, 4U); workers *= 2)
+    {
+        std::vector<std::unique_ptr<Thread>> threads;
+        for (auto i = 0; i < instances; ++i)
+        {
+            threads.push_back(make_thread());
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            scheduler pool{workers};
+            for (auto &thread : threads)
+            {
+                pool.submit(std::move(thread));
+            }
+            while (pool.wait().thread != nullptr)
+            {
+            }
+        }
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        baseline = baseline == 0 ? seconds : baseline;
+        std::cout << std::setw(8) << workers << std::setw(12) << std::fixed << std::setprecision(4) << seconds
+                  << std::setw(16) << std::setprecision(0) << total / seconds
+                  << std::setw(10) << std::setprecision(2) << baseline / seconds << '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,578 @@
+#include "../supernova.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+/// micro and macro benchmarks, printed as a table or as JSON with --json, --no-fusion turns superinstructions off
+
+#ifndef SUPERNOVA_VERSION
+#define SUPERNOVA_VERSION ""
+#endif
+
+using namespace supernova;
+
+namespace
+{
+    auto raw(RInstruction instr) { return static_cast<uint64_t>(instr); }
+    auto raw(SInstruction instr) { return static_cast<uint64_t>(instr); }
+    auto raw(LInstruction instr) { return static_cast<uint64_t>(instr); }
+
+    constexpr auto halt = LInstruction(pcall_instrc, 0, ProcessorCall::Halt);
+    constexpr uint64_t word = sizeof(uint64_t);
+
+    /** times every benchmark runs, the fastest run is kept */
+    constexpr auto repeats = 3;
+
+    /**
+     * @brief guest program, along with what it should leave on r1
+     */
+    struct program
+    {
+        char const *name;           /**< benchmark name */
+        char const *kind;           /**< "micro" or "macro" */
+        std::vector<uint64_t> code; /**< instructions, loaded at address 0 */
+        uint64_t memory_size;       /**< memory given to the thread */
+        uint64_t expected;          /**< value of r1 once the program ends */
+    };
+
+    /**
+     * @brief one line of results
+     */
+    struct measurement
+    {
+        std::string name;    /**< benchmark name */
+        char const *kind;    /**< "micro" or "macro" */
+        char const *unit;    /**< what `operations` counts */
+        uint64_t operations; /**< instructions, bytes, ... done on the fastest run */
+        double seconds;      /**< time taken by the fastest run */
+    };
+
+    /**
+     * @brief repeat a body, counting r3 up to `iterations`
+     *
+     * r3 and r6 belong to the loop, `setup` runs once before it
+     */
+    auto loop(std::vector<uint64_t> setup, std::vector<uint64_t> const &body, uint64_t iterations) -> std::vector<uint64_t>
+    {
+        auto code = std::move(setup);
+        code.push_back(raw(SInstruction(addi_instrc, 0, 6, iterations)));
+
+        const auto start = code.size();
+        code.insert(code.end(), body.begin(), body.end());
+        code.push_back(raw(SInstruction(addi_instrc, 3, 3, 1)));
+        code.push_back(raw(SInstruction(jne_instrc, 6, 3, (start - code.size() - 1) * word)));
+        code.push_back(raw(halt));
+        return code;
+    }
+
+    constexpr uint64_t micro_iterations = 1'000'000;
+
+    /** first data page of the paging benchmarks, pages after it are `tlb_stride` apart */
+    constexpr uint64_t paged_data = 0x1000;
+
+    /** pages this far apart share a single TLB entry */
+    constexpr uint64_t tlb_stride = Thread::tlb_size * default_page_size;
+
+    /** data pages mapped by the TLB miss benchmark, every load replaces the entry the last one left */
+    constexpr uint64_t tlb_conflicts = 8;
+
+    /** root of the 3 level identity map, the two tables below it follow */
+    constexpr uint64_t paged_tables = paged_data + tlb_conflicts * tlb_stride;
+
+    constexpr uint64_t paged_memory = paged_tables + 3 * default_page_size;
+
+    /**
+     * @brief identity map the code page and `pages` data pages, then enable paging with `pcall -1` 1:1
+     */
+    auto map_pages(uint64_t pages) -> std::vector<uint64_t>
+    {
+        std::vector<uint64_t> code;
+        const auto entry = [&code](uint64_t slot, uint64_t value)
+        {
+            code.push_back(raw(SInstruction(addi_instrc, 0, 4, value)));
+            code.push_back(raw(SInstruction(st_dwrd_instrc, 4, 0, slot)));
+        };
+
+        constexpr auto last_level = paged_tables + 2 * default_page_size;
+        entry(paged_tables, (paged_tables + default_page_size) | PageRead);
+        entry(paged_tables + default_page_size, last_level | PageRead);
+        entry(last_level, PageRead | PageExecute);
+        for (uint64_t i = 0; i < pages; ++i)
+        {
+            const auto page = paged_data + i * tlb_stride;
+            entry(last_level + (page / default_page_size) * word, page | PageRead);
+        }
+
+        code.push_back(raw(SInstruction(addi_instrc, 0, Thread::pcall_reg, 1)));
+        code.push_back(raw(SInstruction(umuli_instrc, Thread::pcall_reg, Thread::pcall_reg, 0x100000000)));
+        code.push_back(raw(SInstruction(addi_instrc, Thread::pcall_reg, Thread::pcall_reg, 1)));
+        code.push_back(raw(SInstruction(addi_instrc, 0, Thread::pcall_1stret, paged_tables)));
+        code.push_back(raw(SInstruction(addi_instrc, 0, Thread::pcall_2ndret, 1)));
+        code.push_back(raw(LInstruction(pcall_instrc, 0, static_cast<uint64_t>(ProcessorCall::Functions))));
+        return code;
+    }
+
+    auto micro_programs() -> std::vector<program>
+    {
+        std::vector<program> programs;
+
+        programs.push_back({"group0", "micro", loop({raw(SInstruction(addi_instrc, 0, 5, 0x1234))}, {
+            raw(RInstruction(andr_instrc, 4, 5, 7)),
+            raw(SInstruction(ori_instrc, 4, 4, 0x10)),
+            raw(RInstruction(xorr_instrc, 4, 5, 4)),
+            raw(RInstruction(not_instrc, 7, 0, 8)),
+            raw(SInstruction(cnt_instrc, 8, 9, 0)),
+            raw(SInstruction(llsi_instrc, 4, 7, 3)),
+            raw(RInstruction(lrsr_instrc, 7, 9, 8)),
+            raw(SInstruction(xori_instrc, 8, 5, 0x55)),
+        }, micro_iterations), 0x1000, 0});
+
+        programs.push_back({"group1", "micro", loop({raw(SInstruction(addi_instrc, 0, 5, 7))}, {
+            raw(RInstruction(addr_instrc, 4, 5, 4)),
+            raw(SInstruction(subi_instrc, 4, 7, 1)),
+            raw(RInstruction(umulr_instrc, 7, 5, 8)),
+            raw(SInstruction(umuli_instrc, 4, 9, 3)),
+            raw(RInstruction(smulr_instrc, 9, 5, 10)),
+            raw(SInstruction(smuli_instrc, 7, 11, 5)),
+            raw(SInstruction(udivi_instrc, 8, 12, 3)),
+            raw(RInstruction(sdivr_instrc, 10, 5, 13)),
+        }, micro_iterations), 0x1000, 0});
+
+        programs.push_back({"group2-jumps", "micro", loop({}, {
+            raw(LInstruction(jal_instrc, 9, 0)),
+            raw(LInstruction(jal_instrc, 9, 0)),
+            raw(LInstruction(jal_instrc, 9, 0)),
+            raw(LInstruction(jal_instrc, 9, 0)),
+            raw(SInstruction(je_instrc, 0, 0, 0)),
+            raw(SInstruction(je_instrc, 0, 0, 0)),
+            raw(SInstruction(jne_instrc, 0, 0, 0)),
+            raw(SInstruction(jne_instrc, 0, 0, 0)),
+        }, micro_iterations), 0x1000, 0});
+
+        programs.push_back({"group3", "micro", loop({raw(SInstruction(addi_instrc, 0, 5, 0x40))}, {
+            raw(RInstruction(setgur_instrc, 3, 5, 4)),
+            raw(SInstruction(setgui_instrc, 3, 7, 0x80)),
+            raw(RInstruction(setgsr_instrc, 5, 3, 8)),
+            raw(SInstruction(setgsi_instrc, 3, 9, 0x10)),
+            raw(RInstruction(setleur_instrc, 3, 5, 10)),
+            raw(SInstruction(setleui_instrc, 3, 11, 0x20)),
+            raw(RInstruction(setlesr_instrc, 5, 3, 12)),
+            raw(SInstruction(setlesi_instrc, 3, 13, 0x30)),
+        }, micro_iterations), 0x1000, 0});
+
+        programs.push_back({"group4", "micro", loop({
+            raw(SInstruction(addi_instrc, 0, 5, 3)),
+            raw(RInstruction(flt_ldu_instrc, 5, 0, 1)),
+            raw(RInstruction(flt_lds_instrc, 5, 0, 2)),
+        }, {
+            raw(RInstruction(flt_add_instrc, 1, 2, 3)),
+            raw(RInstruction(flt_mul_instrc, 3, 2, 4)),
+            raw(RInstruction(flt_div_instrc, 4, 1, 5)),
+            raw(RInstruction(flt_sub_instrc, 5, 2, 6)),
+            raw(RInstruction(flt_cgt_instrc, 6, 3, 7)),
+            raw(SInstruction(flt_flr_instrc, 5, 7, 0)),
+            raw(RInstruction(flt_sts_instrc, 7, 0, 8)),
+            raw(RInstruction(flt_lds_instrc, 8, 0, 1)),
+        }, micro_iterations), 0x1000, 0});
+
+        // max, min and abs of the loop counter, the selects a compiler would otherwise branch around
+        programs.push_back({"group5", "micro", loop({raw(SInstruction(addi_instrc, 0, 5, 0x40))}, {
+            raw(RInstruction(setgur_instrc, 3, 5, 4)),
+            raw(RInstruction(orr_instrc, 5, 0, 7)),
+            raw(RInstruction(cmovnz_instrc, 3, 4, 7)),
+            raw(RInstruction(orr_instrc, 3, 0, 8)),
+            raw(RInstruction(cmovnz_instrc, 5, 4, 8)),
+            raw(RInstruction(subr_instrc, 5, 3, 9)),
+            raw(RInstruction(subr_instrc, 3, 5, 10)),
+            raw(RInstruction(cmovles_instrc, 10, 9, 9)),
+        }, micro_iterations), 0x1000, 0});
+
+        programs.push_back({"group6", "micro", loop({
+            raw(SInstruction(addi_instrc, 0, 10, 0x800)),
+            raw(SInstruction(addi_instrc, 0, 11, 1)),
+            raw(SInstruction(addi_instrc, 0, 12, 0x810)),
+            raw(SInstruction(addi_instrc, 0, 13, 0x818)),
+        }, {
+            raw(SInstruction(ld_acq_instrc, 10, 4, 0)),
+            raw(SInstruction(st_rel_instrc, 4, 10, 8)),
+            raw(RInstruction(xadd_instrc, 10, 11, 5)),
+            raw(RInstruction(cas_instrc, 12, 11, 7)),
+            raw(RInstruction(xchg_instrc, 13, 4, 8)),
+            raw(RInstruction(fence_acq_instrc, 0, 0, 0)),
+            raw(RInstruction(fence_rel_instrc, 0, 0, 0)),
+            raw(RInstruction(fence_seq_instrc, 0, 0, 0)),
+        }, micro_iterations), 0x1000, 0});
+
+        // vectors as wide as the host runs them, 64 bytes apart so every width fits
+        programs.push_back({"group7", "micro", loop({
+            raw(SInstruction(addi_instrc, 0, 10, 0x800)),
+            raw(SInstruction(addi_instrc, 0, 11, 3)),
+            raw(RInstruction(vbrd_instrc, 11, 0, 2)),
+        }, {
+            raw(SInstruction(vld_instrc, 10, 1, 0)),
+            raw(RInstruction(vadd_instrc, 1, 2, 3)),
+            raw(RInstruction(vmul_instrc, 3, 2, 4)),
+            raw(RInstruction(vxor_instrc, 4, 1, 5)),
+            raw(RInstruction(vcgtu_instrc, 5, 3, 6)),
+            raw(RInstruction(vand_instrc, 6, 4, 7)),
+            raw(SInstruction(vst_instrc, 7, 10, 0x40)),
+            raw(SInstruction(vext_instrc, 7, 4, 0)),
+        }, micro_iterations), 0x1000, 0});
+
+        // every width loads and stores at the same place
+        const std::pair<char const *, std::pair<inspx, inspx>> widths[] = {
+            {"memory-byte", {ld_byte_instrc, st_byte_instrc}},
+            {"memory-half", {ld_half_instrc, st_half_instrc}},
+            {"memory-word", {ld_word_instrc, st_word_instrc}},
+            {"memory-dwrd", {ld_dwrd_instrc, st_dwrd_instrc}},
+        };
+        for (auto const &[name, opcodes] : widths)
+        {
+            const auto [load, store] = opcodes;
+            programs.push_back({name, "micro", loop({raw(SInstruction(addi_instrc, 0, 10, 0x800))}, {
+                raw(SInstruction(load, 10, 4, 0)),
+                raw(SInstruction(store, 4, 10, 8)),
+                raw(SInstruction(load, 10, 5, 16)),
+                raw(SInstruction(store, 5, 10, 24)),
+                raw(SInstruction(load, 10, 7, 32)),
+                raw(SInstruction(store, 7, 10, 40)),
+                raw(SInstruction(load, 10, 8, 48)),
+                raw(SInstruction(store, 8, 10, 56)),
+            }, micro_iterations), 0x1000, 0});
+        }
+
+        // `pcall -1` asking for paging information goes to the host and straight back
+        const auto functions = raw(LInstruction(pcall_instrc, 0, static_cast<uint64_t>(ProcessorCall::Functions)));
+        programs.push_back({"pcall", "micro", loop({
+            raw(SInstruction(addi_instrc, 0, Thread::pcall_reg, 1)),
+            raw(SInstruction(umuli_instrc, Thread::pcall_reg, Thread::pcall_reg, 0x100000000)),
+        }, std::vector<uint64_t>(8, functions), micro_iterations), 0x1000, 0});
+
+        // the same loads with paging on, hitting a single TLB entry or missing on every load
+        programs.push_back({"paging-tlb-hit", "micro", loop(map_pages(1), {
+            raw(SInstruction(ld_dwrd_instrc, 0, 4, paged_data + 0 * word)),
+            raw(SInstruction(ld_dwrd_instrc, 0, 5, paged_data + 1 * word)),
+            raw(SInstruction(ld_dwrd_instrc, 0, 7, paged_data + 2 * word)),
+            raw(SInstruction(ld_dwrd_instrc, 0, 8, paged_data + 3 * word)),
+            raw(SInstruction(ld_dwrd_instrc, 0, 4, paged_data + 4 * word)),
+            raw(SInstruction(ld_dwrd_instrc, 0, 5, paged_data + 5 * word)),
+            raw(SInstruction(ld_dwrd_instrc, 0, 7, paged_data + 6 * word)),
+            raw(SInstruction(ld_dwrd_instrc, 0, 8, paged_data + 7 * word)),
+        }, micro_iterations), paged_memory, 0});
+
+        std::vector<uint64_t> misses;
+        for (uint64_t i = 0; i < tlb_conflicts; ++i)
+        {
+            misses.push_back(raw(SInstruction(ld_dwrd_instrc, 0, 4, paged_data + i * tlb_stride)));
+        }
+        programs.push_back({"paging-tlb-miss", "micro", loop(map_pages(tlb_conflicts), misses, micro_iterations), paged_memory, 0});
+
+        return programs;
+    }
+
+    /** counts r3 up to 10 million */
+    auto tight_loop() -> program
+    {
+        return {"loop", "macro", loop({}, {}, 10'000'000), 0x1000, 0};
+    }
+
+    /** naive recursive fibonacci, argument on r4 and result on r1 */
+    auto fib() -> program
+    {
+        constexpr uint64_t argument = 27;
+        constexpr uint64_t function = 6 * word;
+        constexpr auto filler = RInstruction(andr_instrc, 0, 0, 0);
+
+        return {"fib", "macro", {
+            raw(SInstruction(addi_instrc, 0, 2, 0x8000)),
+            raw(SInstruction(addi_instrc, 0, 4, argument)),
+            raw(SInstruction(addi_instrc, 0, 5, function)),
+            raw(RInstruction(call_instrc, 2, 3, 5)),
+            raw(filler), // calls return two instructions past themselves
+            raw(halt),
+            // function:
+            raw(SInstruction(setleui_instrc, 4, 8, 1)),
+            raw(SInstruction(je_instrc, 0, 8, 2 * word)),
+            raw(RInstruction(addr_instrc, 4, 0, 1)),
+            raw(RInstruction(retn_instrc, 2, 3, 0)),
+            raw(SInstruction(push_instrc, 2, 4, 0)),
+            raw(SInstruction(subi_instrc, 4, 4, 1)),
+            raw(SInstruction(addi_instrc, 0, 5, function)),
+            raw(RInstruction(call_instrc, 2, 3, 5)),
+            raw(filler),
+            raw(SInstruction(pull_instrc, 2, 4, 0)),
+            raw(SInstruction(push_instrc, 2, 1, 0)),
+            raw(SInstruction(subi_instrc, 4, 4, 2)),
+            raw(SInstruction(addi_instrc, 0, 5, function)),
+            raw(RInstruction(call_instrc, 2, 3, 5)),
+            raw(filler),
+            raw(SInstruction(pull_instrc, 2, 9, 0)),
+            raw(RInstruction(addr_instrc, 1, 9, 1)),
+            raw(RInstruction(retn_instrc, 2, 3, 0)),
+        }, 0x10000, 196418};
+    }
+
+    /** copies 32KiB between two buffers 64 times */
+    auto memcpy_loop() -> program
+    {
+        constexpr uint64_t source = 0x10000;
+        constexpr uint64_t destination = 0x20000;
+        constexpr uint64_t size = 0x8000;
+
+        return {"memcpy", "macro", loop({}, {
+            raw(SInstruction(addi_instrc, 0, 10, source)),
+            raw(SInstruction(addi_instrc, 0, 11, destination)),
+            raw(SInstruction(addi_instrc, 0, 12, source + size)),
+            // copy:
+            raw(SInstruction(ld_dwrd_instrc, 10, 7, 0)),
+            raw(SInstruction(st_dwrd_instrc, 7, 11, 0)),
+            raw(SInstruction(addi_instrc, 10, 10, word)),
+            raw(SInstruction(addi_instrc, 11, 11, word)),
+            raw(SInstruction(jne_instrc, 10, 12, -5 * static_cast<int64_t>(word))),
+        }, 64), 0x30000, 0};
+    }
+
+    /** fills 2048 double words from a generator, insertion sorts them and counts pairs out of order into r1 */
+    auto sort() -> program
+    {
+        constexpr uint64_t base = 0x1000;
+        constexpr uint64_t count = 2048;
+        constexpr uint64_t end = base + count * word;
+
+        return {"sort", "macro", {
+            raw(SInstruction(addi_instrc, 0, 10, base)),
+            raw(SInstruction(addi_instrc, 0, 11, end)),
+            raw(SInstruction(addi_instrc, 0, 4, 12345)),
+            raw(SInstruction(addi_instrc, 0, 12, base)),
+            // fill:
+            raw(SInstruction(umuli_instrc, 4, 4, 1103515245)),
+            raw(SInstruction(addi_instrc, 4, 4, 12345)),
+            raw(SInstruction(andi_instrc, 4, 4, 0x7FFFFFFF)),
+            raw(SInstruction(st_dwrd_instrc, 4, 12, 0)),
+            raw(SInstruction(addi_instrc, 12, 12, word)),
+            raw(SInstruction(jne_instrc, 12, 11, -6 * static_cast<int64_t>(word))),
+            // sort, r12 walks the keys and r13 the sorted part below them
+            raw(SInstruction(addi_instrc, 10, 12, word)),
+            raw(SInstruction(ld_dwrd_instrc, 12, 4, 0)),
+            raw(SInstruction(subi_instrc, 12, 13, word)),
+            raw(SInstruction(jgu_instrc, 13, 10, 5 * word)),
+            raw(SInstruction(ld_dwrd_instrc, 13, 5, 0)),
+            raw(SInstruction(jleu_instrc, 4, 5, 3 * word)),
+            raw(SInstruction(st_dwrd_instrc, 5, 13, word)),
+            raw(SInstruction(subi_instrc, 13, 13, word)),
+            raw(LInstruction(jal_instrc, 9, -6 * static_cast<int64_t>(word))),
+            raw(SInstruction(st_dwrd_instrc, 4, 13, word)),
+            raw(SInstruction(addi_instrc, 12, 12, word)),
+            raw(SInstruction(jne_instrc, 12, 11, -11 * static_cast<int64_t>(word))),
+            // check
+            raw(SInstruction(addi_instrc, 10, 12, word)),
+            raw(SInstruction(ld_dwrd_instrc, 12, 4, -static_cast<int64_t>(word))),
+            raw(SInstruction(ld_dwrd_instrc, 12, 5, 0)),
+            raw(RInstruction(setgur_instrc, 4, 5, 7)),
+            raw(RInstruction(addr_instrc, 1, 7, 1)),
+            raw(SInstruction(addi_instrc, 12, 12, word)),
+            raw(SInstruction(jne_instrc, 12, 11, -6 * static_cast<int64_t>(word))),
+            raw(halt),
+        }, end, 0};
+    }
+
+    constexpr uint64_t hash_size = 0x100000;
+    constexpr uint64_t hash_basis = 0x84222325;
+    constexpr uint64_t hash_prime = 0x100000001B3;
+
+    /** FNV-1a over every byte of memory, into r1 */
+    auto hash() -> program
+    {
+        return {"hash", "macro", {
+            raw(SInstruction(addi_instrc, 0, 1, hash_basis)),
+            raw(SInstruction(addi_instrc, 0, 8, hash_prime)),
+            raw(SInstruction(addi_instrc, 0, 11, hash_size)),
+            // hash:
+            raw(SInstruction(ld_byte_instrc, 10, 5, 0)),
+            raw(RInstruction(xorr_instrc, 1, 5, 1)),
+            raw(RInstruction(umulr_instrc, 1, 8, 1)),
+            raw(SInstruction(addi_instrc, 10, 10, 1)),
+            raw(SInstruction(jne_instrc, 10, 11, -5 * static_cast<int64_t>(word))),
+            raw(halt),
+        }, hash_size, 0};
+    }
+
+    /** same hash `hash()` leaves on r1, over the same memory */
+    auto expected_hash(std::vector<uint64_t> const &code) -> uint64_t
+    {
+        std::vector<uint8_t> memory(hash_size);
+        std::copy(code.begin(), code.end(), reinterpret_cast<uint64_t *>(memory.data()));
+
+        auto value = hash_basis;
+        for (auto byte : memory)
+        {
+            value = (value ^ byte) * hash_prime;
+        }
+        return value;
+    }
+
+    auto make_thread(program const &work) -> Thread
+    {
+        auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[work.memory_size]{});
+        std::copy(work.code.begin(), work.code.end(), reinterpret_cast<uint64_t *>(memory.get()));
+        return Thread{std::move(memory), work.memory_size, nullptr};
+    }
+
+    /**
+     * @brief run a program a few times
+     * @return fastest run, `seconds` is negative if the program gave a wrong result
+     */
+    auto measure(program const &work, bool fusion) -> measurement
+    {
+        measurement best{work.name, work.kind, "instructions", 0, -1};
+
+        for (auto i = 0; i < repeats; ++i)
+        {
+            auto thread = make_thread(work);
+            thread.use_fusion(fusion);
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto result = run_for(thread, ~0LLU);
+            const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (result.status != ProgramEnded || thread.registers(1) != work.expected)
+            {
+                std::cerr << work.name << ": expected " << work.expected << " on r1, got " << thread.registers(1) << '\n';
+                return measurement{work.name, work.kind, "instructions", result.executed, -1};
+            }
+
+            if (best.seconds < 0 || seconds < best.seconds)
+            {
+                best.operations = result.executed;
+                best.seconds = seconds;
+            }
+        }
+
+        return best;
+    }
+
+    /**
+     * @brief time `read_file` on an image of `size` bytes, copied and mapped
+     */
+    auto measure_read(uint64_t size, std::vector<measurement> &results) -> void
+    {
+        using namespace supernova::headers;
+
+        const auto filename = "bench_read_" + std::to_string(size) + ".spn";
+        {
+            const main_header main{master_magic, snvm_version, size, 0, 1};
+            const memory_map region{memmap_magic, 0x1000, size, 0, static_cast<memory_flags>(mem_exists | mem_read)};
+            std::vector<char> padding(0x1000 - sizeof(main) - sizeof(region));
+            std::vector<char> data(size, 1);
+
+            auto file = std::ofstream(filename, std::ios::binary);
+            file.write(reinterpret_cast<char const *>(&main), sizeof(main));
+            file.write(reinterpret_cast<char const *>(&region), sizeof(region));
+            file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        // small images get read many times, so every line takes a comparable time
+        const auto reads = std::max<uint64_t>(1, (64ULL << 20U) / size);
+
+        for (auto const &[mode, name] : {std::pair{LoadCopy, "copy"}, std::pair{LoadMapped, "mapped"}})
+        {
+            auto best = -1.0;
+            for (auto i = 0; i < repeats; ++i)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                for (uint64_t j = 0; j < reads; ++j)
+                {
+                    const auto image = read_file(filename.c_str(), mode);
+                    if (image.status != ReadOk)
+                    {
+                        std::cerr << filename << ": status code = " << static_cast<int>(image.status) << '\n';
+                        break;
+                    }
+                }
+                const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                best = best < 0 || seconds < best ? seconds : best;
+            }
+
+            results.push_back({"read_file-" + std::string(name) + "-" + std::to_string(size >> 10U) + "k", "micro", "bytes", size * reads, best});
+        }
+
+        std::remove(filename.c_str());
+    }
+
+    void write_table(std::vector<measurement> const &results)
+    {
+        std::cout << std::left << std::setw(24) << "benchmark" << std::setw(8) << "kind" << std::right << std::setw(16) << "operations"
+                  << std::setw(14) << "unit" << std::setw(14) << "seconds" << std::setw(16) << "per second" << '\n';
+
+        for (auto const &result : results)
+        {
+            std::cout << std::left << std::setw(24) << result.name << std::setw(8) << result.kind << std::right << std::setw(16) << result.operations
+                      << std::setw(14) << result.unit << std::setw(14) << std::fixed << std::setprecision(6) << result.seconds
+                      << std::setw(16) << std::setprecision(0) << static_cast<double>(result.operations) / result.seconds << '\n';
+        }
+    }
+
+    void write_json(std::vector<measurement> const &results)
+    {
+        std::cout << "{\"version\":\"" SUPERNOVA_VERSION "\",\"results\":[";
+
+        auto separator = "";
+        for (auto const &result : results)
+        {
+            std::cout << separator << "{\"name\":\"" << result.name << "\",\"kind\":\"" << result.kind << "\",\"unit\":\"" << result.unit
+                      << "\",\"operations\":" << result.operations << ",\"seconds\":" << std::setprecision(9) << result.seconds << '}';
+            separator = ",";
+        }
+        std::cout << "]}\n";
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    auto json = false;
+    auto fusion = true;
+    for (auto i = 1; i < argc; ++i)
+    {
+        json = json || argv[i] == std::string_view("--json");
+        fusion = fusion && argv[i] != std::string_view("--no-fusion");
+    }
+
+    std::vector<measurement> results;
+    auto failed = false;
+
+    auto programs = micro_programs();
+    programs.push_back(tight_loop());
+    programs.push_back(fib());
+    programs.push_back(memcpy_loop());
+    programs.push_back(sort());
+    programs.push_back(hash());
+    programs.back().expected = expected_hash(programs.back().code);
+
+    for (auto const &work : programs)
+    {
+        results.push_back(measure(work, fusion));
+        failed = failed || results.back().seconds < 0;
+    }
+
+    for (uint64_t size : {4ULL << 10U, 256ULL << 10U, 16ULL << 20U})
+    {
+        measure_read(size, results);
+    }
+
+    if (json)
+    {
+        write_json(results);
+    }
+    else
+    {
+        write_table(results);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,449 @@
+#include "supernova.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace supernova;
+    using namespace supernova::headers;
+
+    constexpr uint64_t word = sizeof(uint64_t);
+    constexpr uint64_t page_size = 0x1000;
+
+    /** bits `lui` shifts its immediate by, the rest comes from an `ori` */
+    constexpr uint64_t low_bit_count = 13;
+
+    /** label that was created but never bound */
+    constexpr uint64_t unbound = ~0ULL;
+
+    /** immediate bits on S and L instructions */
+    constexpr uint64_t s_immediate_bits = 44;
+    constexpr uint64_t l_immediate_bits = 52;
+
+    /**
+     * @brief how an instruction refers to a label
+     */
+    enum fixup_kind : uint8_t
+    {
+        SRelative, /**< S immediate, relative to the next instruction */
+        LRelative, /**< L immediate, relative to the next instruction */
+        Absolute,  /**< `ori` and `lui` pair loading the address */
+    };
+
+    /**
+     * @brief instruction waiting for a label to be bound
+     */
+    struct fixup
+    {
+        uint64_t index; /**< instruction to fix, the `ori` on absolute fixups */
+        uint64_t label; /**< label it refers to */
+        fixup_kind kind;
+    };
+
+    /**
+     * @brief region added with `data` or `reserve`
+     */
+    struct region
+    {
+        uint64_t address;          /**< first byte in memory */
+        uint64_t size;             /**< size in bytes */
+        std::vector<uint8_t> bytes; /**< contents, empty on reserved regions */
+        memory_flags flags;
+    };
+
+    /** check if a signed value fits in an immediate of `bits` bits */
+    auto fits(int64_t value, uint64_t bits) -> bool
+    {
+        const auto limit = static_cast<int64_t>(1ULL << (bits - 1));
+        return value >= -limit && value < limit;
+    }
+
+    /** round up to the next multiple of a power of two */
+    auto align_up(uint64_t value, uint64_t alignment) -> uint64_t
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+} // namespace
+
+namespace supernova
+{
+    struct builder_state
+    {
+        uint64_t origin;                             /**< address of the first instruction */
+        std::vector<uint64_t> code{};                /**< instructions so far */
+        std::vector<uint64_t> labels{};              /**< label addresses, `unbound` until bound */
+        std::vector<fixup> fixups{};                 /**< uses of labels */
+        std::vector<region> regions{};               /**< data and reserved regions */
+        std::vector<std::pair<uint64_t, std::string>> symbols{}; /**< label and name of every symbol */
+        uint64_t entry{unbound};                     /**< label to start at, the origin if unbound */
+        uint64_t memory_size{0};                     /**< memory size, 0 to compute it */
+
+        /** add a use of a label to the next instruction */
+        void refer(uint64_t label, fixup_kind kind)
+        {
+            this->fixups.push_back(fixup{this->code.size(), label, kind});
+        }
+
+        /** memory size asked for, or the smallest one holding every region */
+        auto memory() const -> uint64_t
+        {
+            if (this->memory_size != 0)
+            {
+                return this->memory_size;
+            }
+
+            auto end = this->origin + this->code.size() * word;
+            for (auto const &entry : this->regions)
+            {
+                end = std::max(end, entry.address + entry.size);
+            }
+            return std::max(align_up(end, page_size), page_size);
+        }
+
+        /** symbol table, as it goes into a debug region */
+        auto symbol_table() const -> std::vector<uint8_t>
+        {
+            std::vector<uint64_t> table{symbols_magic, this->symbols.size()};
+            for (auto const &[label, name] : this->symbols)
+            {
+                table.insert(table.end(), {this->labels[label], 0, name.size()});
+
+                std::vector<uint64_t> padded(align_up(name.size(), word) / word);
+                std::memcpy(padded.data(), name.data(), name.size());
+                table.insert(table.end(), padded.begin(), padded.end());
+            }
+
+            std::vector<uint8_t> bytes(table.size() * word);
+            std::memcpy(bytes.data(), table.data(), bytes.size());
+            return bytes;
+        }
+    };
+
+    ProgramBuilder::ProgramBuilder(uint64_t origin)
+        : m_state{std::make_unique<builder_state>()}
+    {
+        this->m_state->origin = origin;
+    }
+
+    ProgramBuilder::ProgramBuilder(ProgramBuilder &&) noexcept = default;
+    auto ProgramBuilder::operator=(ProgramBuilder &&) noexcept -> ProgramBuilder & = default;
+    ProgramBuilder::~ProgramBuilder() = default;
+
+    auto ProgramBuilder::emit(RInstruction instr) -> ProgramBuilder &
+    {
+        this->m_state->code.push_back(static_cast<uint64_t>(instr));
+        return *this;
+    }
+
+    auto ProgramBuilder::emit(SInstruction instr) -> ProgramBuilder &
+    {
+        this->m_state->code.push_back(static_cast<uint64_t>(instr));
+        return *this;
+    }
+
+    auto ProgramBuilder::emit(LInstruction instr) -> ProgramBuilder &
+    {
+        this->m_state->code.push_back(static_cast<uint64_t>(instr));
+        return *this;
+    }
+
+    auto ProgramBuilder::here() const noexcept -> uint64_t
+    {
+        return this->m_state->origin + this->m_state->code.size() * word;
+    }
+
+    auto ProgramBuilder::make_label() -> label
+    {
+        this->m_state->labels.push_back(unbound);
+        return label{this->m_state->labels.size() - 1};
+    }
+
+    auto ProgramBuilder::bind(label target) -> ProgramBuilder &
+    {
+        this->m_state->labels.at(target.id) = this->here();
+        return *this;
+    }
+
+    auto ProgramBuilder::branch(inspx opcode, uint64_t reg1, uint64_t regd, label target) -> ProgramBuilder &
+    {
+        this->m_state->refer(target.id, SRelative);
+        return this->emit(SInstruction(opcode, reg1, regd, 0));
+    }
+
+    auto ProgramBuilder::jump(uint64_t link, label target) -> ProgramBuilder &
+    {
+        this->m_state->refer(target.id, LRelative);
+        return this->emit(LInstruction(jal_instrc, link, 0));
+    }
+
+    auto ProgramBuilder::select(uint64_t regd, uint64_t condition, uint64_t if_true, uint64_t if_false) -> ProgramBuilder &
+    {
+        if (regd == if_true)
+        {
+            return this->emit(RInstruction(cmovz_instrc, if_false, condition, regd));
+        }
+
+        if (regd != if_false)
+        {
+            this->emit(RInstruction(orr_instrc, if_false, 0, regd));
+        }
+        return this->emit(RInstruction(cmovnz_instrc, if_true, condition, regd));
+    }
+
+    auto ProgramBuilder::constant(uint64_t reg, uint64_t value) -> ProgramBuilder &
+    {
+        if (value < (1ULL << s_immediate_bits))
+        {
+            return this->emit(SInstruction(ori_instrc, 0, reg, value));
+        }
+
+        // `lui` ors into the register, which only holds the low bits at that point
+        this->emit(SInstruction(ori_instrc, 0, reg, value & ((1ULL << low_bit_count) - 1)));
+        return this->emit(LInstruction(lui_instrc, reg, value >> low_bit_count));
+    }
+
+    auto ProgramBuilder::address(uint64_t reg, label target) -> ProgramBuilder &
+    {
+        this->m_state->refer(target.id, Absolute);
+        this->emit(SInstruction(ori_instrc, 0, reg, 0));
+        return this->emit(LInstruction(lui_instrc, reg, 0));
+    }
+
+    auto ProgramBuilder::call(label target, uint64_t scratch, uint64_t stack, uint64_t base) -> ProgramBuilder &
+    {
+        this->address(scratch, target);
+        this->emit(RInstruction(call_instrc, stack, base, scratch));
+        return this->emit(RInstruction(andr_instrc, 0, 0, 0));
+    }
+
+    auto ProgramBuilder::halt() -> ProgramBuilder &
+    {
+        return this->emit(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+    }
+
+    auto ProgramBuilder::data(uint64_t address, std::vector<uint8_t> bytes, memory_flags flags) -> ProgramBuilder &
+    {
+        const auto size = bytes.size();
+        this->m_state->regions.push_back(region{address, size, std::move(bytes), static_cast<memory_flags>(flags | mem_exists)});
+        return *this;
+    }
+
+    auto ProgramBuilder::reserve(uint64_t address, uint64_t size) -> ProgramBuilder &
+    {
+        this->m_state->regions.push_back(region{address, size, {}, static_cast<memory_flags>(mem_exists | mem_clear | mem_read | mem_write)});
+        return *this;
+    }
+
+    auto ProgramBuilder::symbol(label start, char const *name) -> ProgramBuilder &
+    {
+        this->m_state->symbols.emplace_back(start.id, name);
+        return *this;
+    }
+
+    auto ProgramBuilder::entry(label start) -> ProgramBuilder &
+    {
+        this->m_state->entry = start.id;
+        return *this;
+    }
+
+    auto ProgramBuilder::memory_size(uint64_t size) -> ProgramBuilder &
+    {
+        this->m_state->memory_size = size;
+        return *this;
+    }
+
+    auto ProgramBuilder::resolve() -> build_status
+    {
+        auto &state = *this->m_state;
+
+        for (auto const &use : state.fixups)
+        {
+            const auto target = state.labels.at(use.label);
+            if (target == unbound)
+            {
+                return UnboundLabel;
+            }
+
+            auto &instr = state.code[use.index];
+            const auto offset = static_cast<int64_t>(target - (state.origin + (use.index + 1) * word));
+
+            switch (use.kind)
+            {
+            case SRelative:
+            {
+                if (!fits(offset, s_immediate_bits))
+                {
+                    return OutOfRange;
+                }
+                const auto old = SInstruction(instr);
+                instr = static_cast<uint64_t>(SInstruction(old.opcode(), old.r1(), old.rd(), offset));
+                break;
+            }
+            case LRelative:
+            {
+                if (!fits(offset, l_immediate_bits))
+                {
+                    return OutOfRange;
+                }
+                const auto old = LInstruction(instr);
+                instr = static_cast<uint64_t>(LInstruction(old.opcode(), old.r1(), offset));
+                break;
+            }
+            case Absolute:
+            {
+                const auto reg = SInstruction(instr).rd();
+                instr = static_cast<uint64_t>(SInstruction(ori_instrc, 0, reg, target & ((1ULL << low_bit_count) - 1)));
+                state.code[use.index + 1] = static_cast<uint64_t>(LInstruction(lui_instrc, reg, target >> low_bit_count));
+                break;
+            }
+            }
+        }
+
+        for (auto const &[label, name] : state.symbols)
+        {
+            if (state.labels.at(label) == unbound)
+            {
+                return UnboundLabel;
+            }
+        }
+
+        if (state.entry != unbound && state.labels.at(state.entry) == unbound)
+        {
+            return UnboundLabel;
+        }
+
+        // code is a region like any other here
+        std::vector<std::pair<uint64_t, uint64_t>> ranges{{state.origin, state.code.size() * word}};
+        for (auto const &entry : state.regions)
+        {
+            ranges.emplace_back(entry.address, entry.size);
+        }
+        std::sort(ranges.begin(), ranges.end());
+
+        const auto memory = state.memory();
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            const auto [address, size] = ranges[i];
+            if (address > memory || memory - address < size)
+            {
+                return InvalidRegion;
+            }
+            if (i + 1 < ranges.size() && address + size > ranges[i + 1].first)
+            {
+                return InvalidRegion;
+            }
+        }
+
+        return BuildOk;
+    }
+
+    auto ProgramBuilder::code() const noexcept -> std::vector<uint64_t> const &
+    {
+        return this->m_state->code;
+    }
+
+    auto ProgramBuilder::image(std::vector<uint8_t> &image) -> build_status
+    {
+        const auto status = this->resolve();
+        if (status != BuildOk)
+        {
+            return status;
+        }
+
+        auto const &state = *this->m_state;
+        const auto symbols = state.symbol_table();
+        const auto region_count = 1 + state.regions.size() + (state.symbols.empty() ? 0 : 1);
+        const auto entry = state.entry == unbound ? state.origin : state.labels[state.entry];
+
+        std::vector<memory_map> maps;
+        std::vector<std::pair<uint8_t const *, uint64_t>> contents;
+        auto offset = sizeof(main_header) + region_count * sizeof(memory_map);
+
+        // file offsets keep the same place inside a page as in memory, so regions can be mapped
+        const auto place = [&](uint64_t address, uint8_t const *bytes, uint64_t size, memory_flags flags) {
+            offset += (address - offset) & (page_size - 1);
+            maps.push_back(memory_map{memmap_magic, offset, size, address, flags});
+            contents.emplace_back(bytes, size);
+            offset += size;
+        };
+
+        // NOLINTNEXTLINE: instructions are written as bytes
+        place(state.origin, reinterpret_cast<uint8_t const *>(state.code.data()), state.code.size() * word,
+              static_cast<memory_flags>(mem_exists | mem_read | mem_execute));
+
+        for (auto const &entry : state.regions)
+        {
+            if (entry.flags & mem_clear)
+            {
+                maps.push_back(memory_map{memmap_magic, 0, entry.size, entry.address, entry.flags});
+                continue;
+            }
+            place(entry.address, entry.bytes.data(), entry.size, entry.flags);
+        }
+
+        if (!state.symbols.empty())
+        {
+            offset = align_up(offset, word);
+            maps.push_back(memory_map{memmap_magic, offset, symbols.size(), 0, mem_read});
+            contents.emplace_back(symbols.data(), symbols.size());
+            offset += symbols.size();
+        }
+
+        const main_header main{master_magic, snvm_version, state.memory(), entry, region_count};
+
+        image.assign(offset, 0);
+        std::memcpy(image.data(), &main, sizeof(main));
+        std::memcpy(image.data() + sizeof(main), maps.data(), maps.size() * sizeof(memory_map));
+
+        auto written = contents.begin();
+        for (auto const &map : maps)
+        {
+            if ((map.flags & mem_clear) == 0)
+            {
+                std::copy(written->first, written->first + written->second, image.begin() + static_cast<std::ptrdiff_t>(map.start));
+                ++written;
+            }
+        }
+
+        return BuildOk;
+    }
+
+    auto ProgramBuilder::write(char const *filename) -> build_status
+    {
+        std::vector<uint8_t> bytes;
+        const auto status = this->image(bytes);
+        if (status != BuildOk)
+        {
+            return status;
+        }
+
+        auto file = std::ofstream(filename, std::ios::binary);
+        // NOLINTNEXTLINE: plain bytes
+        file.write(reinterpret_cast<char const *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return file ? BuildOk : WriteFailed;
+    }
+
+    auto ProgramBuilder::load() -> headers::read_return
+    {
+        if (this->resolve() != BuildOk)
+        {
+            return read_return{InvalidHeader};
+        }
+
+        auto const &state = *this->m_state;
+        const auto size = state.memory();
+        auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[size]{});
+
+        std::memcpy(memory.get() + state.origin, state.code.data(), state.code.size() * word);
+        for (auto const &entry : state.regions)
+        {
+            std::copy(entry.bytes.begin(), entry.bytes.end(), memory.get() + entry.address);
+        }
+
+        const auto entry = state.entry == unbound ? state.origin : state.labels[state.entry];
+        return read_return{ReadOk, size, entry, std::move(memory)};
+    }
+} // namespace supernova
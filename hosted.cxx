@@ -0,0 +1,498 @@
+#include "supernova.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define SUPERNOVA_HOSTED_POSIX 1
+#endif
+
+namespace
+{
+    using hosted_request = supernova::hosted_request;
+    using hosted_completion = supernova::hosted_completion;
+
+    /** double words of the ring header */
+    enum ring_word : uint8_t
+    {
+        submission_head,
+        submission_tail,
+        completion_head,
+        completion_tail,
+    };
+
+    /**
+     * @brief get the buffer of a request
+     * @return start of the buffer, `nullptr` if it does not fit in memory
+     */
+    auto buffer_of(uint8_t *memory, uint64_t memory_size, hosted_request const &request) noexcept -> uint8_t *
+    {
+        if (request.address > memory_size || memory_size - request.address < request.length)
+        {
+            return nullptr;
+        }
+        return memory + request.address;
+    }
+
+    /**
+     * @brief resolve a guest range that has to be contiguous on thread memory
+     * @return address on thread memory, `untranslated` if a page is missing, out of place, read only or the range does not fit
+     */
+    auto physical_range(supernova::Thread &thread, uint64_t address, uint64_t size, uint8_t access) noexcept -> uint64_t
+    {
+        auto physical = address;
+        if (thread.paging())
+        {
+            const auto page = thread.page_size();
+            physical = thread.translate(address, access);
+            for (auto offset = page - address % page; physical != supernova::Thread::untranslated && offset < size; offset += page)
+            {
+                physical = thread.translate(address + offset, access) == physical + offset ? physical : supernova::Thread::untranslated;
+            }
+        }
+
+        if (physical == supernova::Thread::untranslated || physical > thread.memsize() || thread.memsize() - physical < size)
+        {
+            return supernova::Thread::untranslated;
+        }
+
+        // writing a range mapped without write access would fault outside any guard
+        for (auto const &range : thread.read_only())
+        {
+            if ((access & supernova::PageWrite) != 0 && physical < range.second && range.first < physical + size)
+            {
+                return supernova::Thread::untranslated;
+            }
+        }
+        return physical;
+    }
+
+    /**
+     * @brief copy between guest memory and a host buffer, page by page while paging is on
+     *
+     * every page is checked before anything is copied, bytes copied into the
+     * guest drop whatever the thread cached for them, the same way stores do
+     *
+     * @param bytes host buffer, `nullptr` only checks the guest range
+     * @return false if a page is missing or lacks permissions, nothing was copied then
+     */
+    auto copy_guest(supernova::Thread &thread, uint64_t address, uint8_t *bytes, uint64_t size, bool into_guest) noexcept -> bool
+    {
+        const auto access = into_guest ? supernova::PageWrite : supernova::PageRead;
+        const uint64_t page = thread.paging() ? thread.page_size() : ~0ULL;
+
+        for (auto pass = 0; pass < (bytes != nullptr ? 2 : 1); ++pass)
+        {
+            for (uint64_t done = 0; done < size;)
+            {
+                const auto chunk = std::min(size - done, page - (address + done) % page);
+                const auto physical = physical_range(thread, address + done, chunk, access);
+                if (physical == supernova::Thread::untranslated)
+                {
+                    return false;
+                }
+
+                if (pass != 0 && into_guest)
+                {
+                    std::memcpy(thread.memory().get() + physical, bytes + done, chunk);
+                    thread.invalidate_decoded(address + done, chunk);
+                    thread.invalidate_code(physical, chunk);
+                }
+                else if (pass != 0)
+                {
+                    std::memcpy(bytes + done, thread.memory().get() + physical, chunk);
+                }
+                done += chunk;
+            }
+        }
+        return true;
+    }
+
+#ifdef SUPERNOVA_HOSTED_POSIX
+    /** turn what a call returned into a completion result */
+    auto result_of(ssize_t moved) noexcept -> int64_t { return moved < 0 ? -static_cast<int64_t>(errno) : moved; }
+
+    auto hosted_read(uint8_t *memory, uint64_t memory_size, hosted_request const &request) noexcept -> int64_t
+    {
+        auto *buffer = buffer_of(memory, memory_size, request);
+        if (buffer == nullptr)
+        {
+            return -EFAULT;
+        }
+        const auto descriptor = static_cast<int>(request.fd);
+        return result_of(request.offset == ~0ULL ? ::read(descriptor, buffer, request.length)
+                                                 : ::pread(descriptor, buffer, request.length, static_cast<off_t>(request.offset)));
+    }
+
+    auto hosted_write(uint8_t *memory, uint64_t memory_size, hosted_request const &request) noexcept -> int64_t
+    {
+        auto const *buffer = buffer_of(memory, memory_size, request);
+        if (buffer == nullptr)
+        {
+            return -EFAULT;
+        }
+        const auto descriptor = static_cast<int>(request.fd);
+        return result_of(request.offset == ~0ULL ? ::write(descriptor, buffer, request.length)
+                                                 : ::pwrite(descriptor, buffer, request.length, static_cast<off_t>(request.offset)));
+    }
+
+    auto hosted_open(uint8_t *memory, uint64_t memory_size, hosted_request const &request) noexcept -> int64_t
+    {
+        auto const *path = buffer_of(memory, memory_size, request);
+        if (path == nullptr)
+        {
+            return -EFAULT;
+        }
+        if (std::memchr(path, 0, request.length) == nullptr)
+        {
+            return -ENAMETOOLONG;
+        }
+
+        int flags = O_CLOEXEC;
+        switch (request.offset & 3U)
+        {
+        case supernova::HostedReadOnly:
+            flags |= O_RDONLY;
+            break;
+        case supernova::HostedWriteOnly:
+            flags |= O_WRONLY;
+            break;
+        case supernova::HostedReadWrite:
+            flags |= O_RDWR;
+            break;
+        default:
+            return -EINVAL;
+        }
+        flags |= (request.offset & supernova::HostedCreate) != 0 ? O_CREAT : 0;
+        flags |= (request.offset & supernova::HostedTruncate) != 0 ? O_TRUNC : 0;
+        flags |= (request.offset & supernova::HostedAppend) != 0 ? O_APPEND : 0;
+
+        const auto descriptor = ::open(reinterpret_cast<char const *>(path), flags, 0644);
+        return descriptor < 0 ? -static_cast<int64_t>(errno) : descriptor;
+    }
+
+    auto hosted_close(uint8_t *, uint64_t, hosted_request const &request) noexcept -> int64_t
+    {
+        return ::close(static_cast<int>(request.fd)) < 0 ? -static_cast<int64_t>(errno) : 0;
+    }
+
+    const supernova::thread_hosted_functions default_functions{1, nullptr, hosted_read, hosted_write, hosted_open, hosted_close};
+#else
+    auto hosted_unsupported(uint8_t *, uint64_t, hosted_request const &) noexcept -> int64_t { return -ENOSYS; }
+
+    const supernova::thread_hosted_functions default_functions{1, nullptr, hosted_unsupported, hosted_unsupported, hosted_unsupported,
+                                                               hosted_unsupported};
+#endif
+} // namespace
+
+namespace supernova
+{
+    /**
+     * @brief request handed to the workers, its buffer is a host copy of the guest one
+     */
+    struct hosted_job
+    {
+        hosted_request request;            /**< request as the guest queued it */
+        std::unique_ptr<uint8_t[]> buffer; /**< copy of the guest buffer, `nullptr` for requests without one */
+        int64_t result;                    /**< result once the job ran, set early when the buffer is not there */
+    };
+
+    struct hosted_ring_state
+    {
+        thread_hosted_functions const *functions; /**< functions running the requests */
+        unsigned worker_count;                    /**< workers started on the first setup */
+
+        uint64_t ring{0};         /**< address of the ring on thread memory */
+        uint64_t entries{0};      /**< entries of each queue, 0 until set up */
+
+        std::mutex lock{};                          /**< protects everything below */
+        std::condition_variable work{};             /**< wakes workers up when requests arrive */
+        std::condition_variable completed{};        /**< signals finished jobs to `enter` */
+        std::deque<hosted_job> requests{};          /**< submitted jobs no worker took yet */
+        std::vector<hosted_job> finished{};         /**< jobs the workers ran, published by `enter` */
+        std::vector<hosted_completion> overflow{};  /**< completions that did not fit on the ring */
+        uint64_t in_flight{0};                      /**< jobs submitted and not finished */
+        bool stopping{false};                       /**< set when the ring goes away */
+        std::vector<std::thread> pool{};            /**< workers */
+
+        hosted_ring_state(thread_hosted_functions const &hosted, unsigned workers) : functions{&hosted}, worker_count{std::max(workers, 1U)} {}
+
+        /** ring header, memory may have moved since the last call */
+        [[nodiscard]] auto words(Thread &thread) const noexcept -> uint64_t *
+        {
+            return reinterpret_cast<uint64_t *>(thread.memory().get() + this->ring);
+        }
+
+        [[nodiscard]] auto submissions(Thread &thread) const noexcept -> hosted_request *
+        {
+            return reinterpret_cast<hosted_request *>(this->words(thread) + hosted_ring::header_size / sizeof(uint64_t));
+        }
+
+        [[nodiscard]] auto completions(Thread &thread) const noexcept -> hosted_completion *
+        {
+            return reinterpret_cast<hosted_completion *>(this->submissions(thread) + this->entries);
+        }
+
+        /** completions on the ring the guest did not reap yet */
+        [[nodiscard]] auto ready(Thread &thread) const noexcept -> uint64_t
+        {
+            auto *words = this->words(thread);
+            return words[completion_tail] - __atomic_load_n(words + completion_head, __ATOMIC_ACQUIRE);
+        }
+
+        /** place a completion on the ring, or keep it aside when full */
+        void post(Thread &thread, hosted_completion completion)
+        {
+            if (this->ready(thread) >= this->entries)
+            {
+                this->overflow.push_back(completion);
+                return;
+            }
+            auto *words = this->words(thread);
+            const auto tail = words[completion_tail];
+            this->completions(thread)[tail & (this->entries - 1)] = completion;
+            __atomic_store_n(words + completion_tail, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        /**
+         * @brief copy a request buffer out of the guest
+         * @return job for the workers, or with a result already when the buffer is not there
+         */
+        [[nodiscard]] auto prepare(Thread &thread, hosted_request const &request) const -> hosted_job
+        {
+            hosted_job job{request, nullptr, 0};
+            if (request.opcode != HostedRead && request.opcode != HostedWrite && request.opcode != HostedOpen)
+            {
+                return job;
+            }
+
+            if (request.length > thread.memsize())
+            {
+                job.result = -EFAULT;
+                return job;
+            }
+            job.buffer.reset(new (std::nothrow) uint8_t[request.length]);
+            if (job.buffer == nullptr)
+            {
+                job.result = -ENOMEM;
+                return job;
+            }
+
+            // reads only check the buffer is there, the workers fill the copy
+            auto *copy = request.opcode == HostedRead ? nullptr : job.buffer.get();
+            if (!copy_guest(thread, request.address, copy, request.length, request.opcode == HostedRead))
+            {
+                job.buffer.reset();
+                job.result = -EFAULT;
+            }
+            return job;
+        }
+
+        /** copy what the workers read back into the guest and post every finished job */
+        void publish(Thread &thread)
+        {
+            // only the reserve allocates, a failure leaves every job where it was
+            this->overflow.reserve(this->overflow.size() + this->finished.size());
+            for (auto &job : this->finished)
+            {
+                if (job.request.opcode == HostedRead && job.result > 0 &&
+                    !copy_guest(thread, job.request.address, job.buffer.get(), static_cast<uint64_t>(job.result), true))
+                {
+                    job.result = -EFAULT;
+                }
+                this->overflow.push_back(hosted_completion{job.request.user_data, job.result});
+            }
+            this->finished.clear();
+
+            auto moved = this->overflow.begin();
+            for (; moved != this->overflow.end() && this->ready(thread) < this->entries; ++moved)
+            {
+                this->post(thread, *moved);
+            }
+            this->overflow.erase(this->overflow.begin(), moved);
+        }
+
+        [[nodiscard]] auto run(hosted_job const &job) const noexcept -> int64_t
+        {
+            hosted_io call = nullptr;
+            switch (job.request.opcode)
+            {
+            case HostedNop:
+                return 0;
+            case HostedRead:
+                call = this->functions->read;
+                break;
+            case HostedWrite:
+                call = this->functions->write;
+                break;
+            case HostedOpen:
+                call = this->functions->open;
+                break;
+            case HostedClose:
+                call = this->functions->close;
+                break;
+            default:
+                return -EINVAL;
+            }
+
+            // the copy is all the workers see, the buffer starts at 0 on it
+            auto request = job.request;
+            request.address = 0;
+            return call != nullptr ? call(job.buffer.get(), request.length, request) : -ENOSYS;
+        }
+
+        void worker()
+        {
+            auto guard = std::unique_lock{this->lock};
+            for (;;)
+            {
+                this->work.wait(guard, [this] { return this->stopping || !this->requests.empty(); });
+                if (this->requests.empty())
+                {
+                    return;
+                }
+
+                auto job = std::move(this->requests.front());
+                this->requests.pop_front();
+                guard.unlock();
+                job.result = this->run(job);
+                guard.lock();
+
+                this->finished.push_back(std::move(job));
+                --this->in_flight;
+                this->completed.notify_all();
+            }
+        }
+    };
+
+    auto default_hosted_functions() noexcept -> thread_hosted_functions const & { return default_functions; }
+
+    hosted_ring::hosted_ring(thread_hosted_functions const &functions, unsigned workers)
+        : m_state{std::make_unique<hosted_ring_state>(functions, workers)}
+    {
+    }
+
+    hosted_ring::~hosted_ring()
+    {
+        {
+            std::lock_guard guard{this->m_state->lock};
+            this->m_state->stopping = true;
+        }
+        this->m_state->work.notify_all();
+        for (auto &worker : this->m_state->pool)
+        {
+            worker.join();
+        }
+    }
+
+    auto hosted_ring::setup(Thread &thread, uint64_t address, uint64_t entries) noexcept -> bool
+    {
+        auto &state = *this->m_state;
+        std::lock_guard guard{state.lock};
+
+        if (state.in_flight != 0 || !state.finished.empty() || entries == 0 || entries > max_entries || (entries & (entries - 1)) != 0 ||
+            address % sizeof(uint64_t) != 0)
+        {
+            return false;
+        }
+
+        // the host works on the ring through thread memory, it can not be split over pages
+        const auto ring = physical_range(thread, address, ring_size(entries), PageRead | PageWrite);
+        if (ring == Thread::untranslated)
+        {
+            return false;
+        }
+
+        // guests that never set up a ring never pay for the workers
+        try
+        {
+            while (state.pool.size() < state.worker_count)
+            {
+                state.pool.emplace_back([&state] { state.worker(); });
+            }
+        }
+        catch (std::exception const &)
+        {
+            return false;
+        }
+
+        state.ring = ring;
+        state.entries = entries;
+        state.overflow.clear();
+        std::fill_n(state.words(thread), header_size / sizeof(uint64_t), 0);
+        return true;
+    }
+
+    auto hosted_ring::enter(Thread &thread, uint64_t wait_for) noexcept -> uint64_t
+    {
+        auto &state = *this->m_state;
+        auto guard = std::unique_lock{state.lock};
+        if (state.entries == 0)
+        {
+            return 0;
+        }
+
+        // the tail is the only word the guest publishes requests with
+        auto *words = state.words(thread);
+        auto head = words[submission_head];
+        const auto tail = __atomic_load_n(words + submission_tail, __ATOMIC_ACQUIRE);
+        uint64_t submitted = 0;
+        auto queued = true;
+        try
+        {
+            for (; head != tail && submitted < state.entries; ++head, ++submitted)
+            {
+                auto job = state.prepare(thread, state.submissions(thread)[head & (state.entries - 1)]);
+                if (job.result != 0)
+                {
+                    state.finished.push_back(std::move(job));
+                    continue;
+                }
+                state.requests.push_back(std::move(job));
+                ++state.in_flight;
+            }
+
+            // workers push what they ran without allocating
+            state.finished.reserve(state.finished.size() + state.in_flight);
+        }
+        catch (std::exception const &)
+        {
+            // the request that did not fit stays on the ring for the next enter
+            queued = false;
+        }
+        __atomic_store_n(words + submission_head, head, __ATOMIC_RELEASE);
+
+        if (!state.requests.empty())
+        {
+            state.work.notify_all();
+        }
+        if (!queued)
+        {
+            return failed;
+        }
+
+        // guest memory is only touched here, on the thread that owns it
+        wait_for = std::min(wait_for, state.entries);
+        try
+        {
+            state.completed.wait(guard, [&state, &thread, wait_for] {
+                state.publish(thread);
+                return state.ready(thread) >= wait_for || (state.in_flight == 0 && state.overflow.empty());
+            });
+        }
+        catch (std::exception const &)
+        {
+            return failed;
+        }
+        return submitted;
+    }
+
+    auto hosted_ring::functions() const noexcept -> thread_hosted_functions const & { return *this->m_state->functions; }
+} // namespace supernova
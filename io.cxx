@@ -0,0 +1,200 @@
+#include "supernova.h"
+#include <chrono>
+
+namespace
+{
+    /**
+     * @brief keep the bytes an access moves
+     * @param value full value
+     * @param width access width in bytes
+     * @return value truncated to the width
+     */
+    constexpr auto truncate(uint64_t value, uint8_t width) noexcept -> uint64_t
+    {
+        return width >= sizeof(uint64_t) ? value : value & ((1ULL << (width * 8U)) - 1);
+    }
+} // namespace
+
+namespace supernova
+{
+    io_bus::io_bus(uint64_t port_count)
+        : m_ports{std::make_unique<io_port[]>(port_count != 0 ? port_count : 1)}, m_port_count{port_count != 0 ? port_count : 1}
+    {
+    }
+
+    auto io_bus::attach(uint64_t base, uint64_t count, void *device, io_read read, io_write write) -> bool
+    {
+        if (device == nullptr || read == nullptr || write == nullptr || count == 0 || base >= this->m_port_count ||
+            this->m_port_count - base < count)
+        {
+            return false;
+        }
+
+        for (uint64_t port = base; port < base + count; ++port)
+        {
+            if (this->m_ports[port].device != nullptr)
+            {
+                return false;
+            }
+        }
+
+        for (uint64_t port = base; port < base + count; ++port)
+        {
+            this->m_ports[port] = io_port{device, read, write, base};
+        }
+        return true;
+    }
+
+    void io_bus::detach(uint64_t port) noexcept
+    {
+        if (port >= this->m_port_count || this->m_ports[port].device == nullptr)
+        {
+            return;
+        }
+
+        const auto entry = this->m_ports[port];
+        for (auto index = entry.base; index < this->m_port_count && this->m_ports[index].device == entry.device &&
+                                      this->m_ports[index].base == entry.base;
+             ++index)
+        {
+            this->m_ports[index] = io_port{};
+        }
+    }
+
+    void Thread::use_io(io_bus *bus) noexcept
+    {
+        this->m_io = bus;
+        if (bus != nullptr && this->m_model != nullptr)
+        {
+            this->m_model->io_address_space = bus->last_port();
+        }
+    }
+
+    auto console_device::read(uint64_t port, uint8_t width) noexcept -> uint64_t
+    {
+        if (port == 1)
+        {
+            return std::feof(this->m_input) != 0 ? 1 : 0;
+        }
+
+        const auto byte = std::fgetc(this->m_input);
+        return byte == EOF ? truncate(~0ULL, width) : static_cast<uint64_t>(byte);
+    }
+
+    void console_device::write(uint64_t port, uint64_t value, uint8_t /*width*/) noexcept
+    {
+        if (port == 1)
+        {
+            std::fflush(this->m_output);
+            return;
+        }
+        std::fputc(static_cast<int>(value & 0xFFU), this->m_output);
+    }
+
+    block_device::block_device(char const *filename) : m_file{std::fopen(filename, "r+b"), &std::fclose}
+    {
+        if (this->m_file != nullptr && std::fseek(this->m_file.get(), 0, SEEK_END) == 0)
+        {
+            const auto size = std::ftell(this->m_file.get());
+            this->m_sectors = size > 0 ? static_cast<uint64_t>(size) / sector_size : 0;
+        }
+    }
+
+    auto block_device::read(uint64_t port, uint8_t width) noexcept -> uint64_t
+    {
+        switch (port)
+        {
+        case 0:
+            return this->m_sector;
+        case 1:
+            return this->m_offset;
+        case 2:
+        {
+            // reads past the buffer give all ones, like an empty port
+            if (this->m_offset >= sector_size || sector_size - this->m_offset < width)
+            {
+                return truncate(~0ULL, width);
+            }
+            uint64_t value = 0;
+            for (uint8_t i = 0; i < width; ++i)
+            {
+                value |= static_cast<uint64_t>(this->m_buffer[this->m_offset + i]) << (i * 8U);
+            }
+            this->m_offset += width;
+            return value;
+        }
+        case 3:
+            return this->m_failed ? 1 : 0;
+        default:
+            return this->m_sectors;
+        }
+    }
+
+    void block_device::write(uint64_t port, uint64_t value, uint8_t width) noexcept
+    {
+        switch (port)
+        {
+        case 0:
+            this->m_sector = value;
+            break;
+        case 1:
+            this->m_offset = value;
+            break;
+        case 2:
+            if (this->m_offset < sector_size && sector_size - this->m_offset >= width)
+            {
+                for (uint8_t i = 0; i < width; ++i)
+                {
+                    this->m_buffer[this->m_offset + i] = static_cast<uint8_t>(value >> (i * 8U));
+                }
+                this->m_offset += width;
+            }
+            break;
+        case 3:
+        {
+            this->m_failed = this->m_file == nullptr || this->m_sector >= this->m_sectors ||
+                             (value != command_read && value != command_write) ||
+                             std::fseek(this->m_file.get(), static_cast<long>(this->m_sector * sector_size), SEEK_SET) != 0;
+            if (this->m_failed)
+            {
+                break;
+            }
+
+            if (value == command_read)
+            {
+                this->m_failed = std::fread(this->m_buffer.data(), 1, sector_size, this->m_file.get()) != sector_size;
+            }
+            else
+            {
+                this->m_failed = std::fwrite(this->m_buffer.data(), 1, sector_size, this->m_file.get()) != sector_size ||
+                                 std::fflush(this->m_file.get()) != 0;
+            }
+            this->m_offset = 0;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    timer_device::timer_device() noexcept
+        : m_start{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()}
+    {
+    }
+
+    auto timer_device::read(uint64_t port, uint8_t width) noexcept -> uint64_t
+    {
+        if (port == 1)
+        {
+            const auto now = std::chrono::system_clock::now().time_since_epoch();
+            return truncate(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(now).count()), width);
+        }
+
+        const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        return truncate(static_cast<uint64_t>(now - this->m_start), width);
+    }
+
+    void timer_device::write(uint64_t /*port*/, uint64_t /*value*/, uint8_t /*width*/) noexcept
+    {
+    }
+} // namespace supernova
@@ -0,0 +1,1127 @@
+#include "supernova.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/mman.h>
+#define SUPERNOVA_JIT_X86_64 1
+#endif
+
+namespace
+{
+    using Thread = supernova::Thread;
+    using Opcodes = supernova::inspx;
+    using decoded_instruction = supernova::decoded_instruction;
+    using thread_return = supernova::thread_return;
+
+    /**
+     * @brief state shared between the runner and translated blocks
+     *
+     * translated code keeps a pointer to this structure on r15 and loads the
+     * other fields into fixed host registers on entry
+     */
+    struct jit_context
+    {
+        uint64_t *registers; /**< thread registers, pinned on rbx */
+        uint8_t *memory;     /**< thread memory, pinned on r12 */
+        uint64_t memsize;    /**< thread memory size, pinned on r13 */
+        uint8_t *pages;      /**< translated code page map, pinned on r14 */
+        uint64_t exit;       /**< set by blocks that need the interpreter to run the next instruction */
+    };
+
+    /** exit reason for blocks that stopped on an instruction they can not run */
+    constexpr uint64_t exit_interpret = 1;
+
+    /** maximum amount of instructions inside a single block */
+    constexpr auto max_block_length = 64;
+
+    /** instructions interpreted between checks for paging being turned off */
+    constexpr uint64_t paged_budget = 0x10000;
+
+    /** size of the executable memory used to hold translated blocks */
+    constexpr uint64_t code_cache_size = 16LLU << 20U;
+
+    using block_function = uint64_t (*)(jit_context *);
+
+    /**
+     * @brief a basic block, translated once it got hot
+     */
+    struct block
+    {
+        block_function function{nullptr}; /**< native code, `nullptr` while interpreted or if the first instruction needs the interpreter */
+        uint8_t *body{nullptr};           /**< native code past the prologue, linked blocks jump in there */
+        uint8_t *limit{nullptr};          /**< end of the native code */
+        uint64_t start{0};                /**< address of the first instruction */
+        uint64_t end{0};                  /**< address after the last instruction */
+        uint64_t hits{0};                 /**< entries while interpreted */
+        uint64_t length{0};               /**< instructions the interpreter runs on each entry */
+        std::vector<uint64_t> exits{};    /**< addresses the native code jumps to without computing them */
+    };
+
+    /**
+     * @brief a jump from translated code to a fixed address
+     */
+    struct link
+    {
+        uint8_t *site;     /**< 32 bit displacement of the jump */
+        uint8_t *unlinked; /**< where the jump goes while the address has no translated block */
+    };
+
+    /**
+     * @brief an exit of a block being emitted, offsets are from the start of its code
+     */
+    struct block_exit
+    {
+        size_t site;     /**< 32 bit displacement of the jump */
+        size_t unlinked; /**< stub leaving the block through the epilogue */
+        uint64_t target; /**< address the exit goes to */
+    };
+
+#ifdef SUPERNOVA_JIT_X86_64
+    /** host registers used by the emitted code */
+    enum host_register : uint8_t
+    {
+        rax = 0,
+        rcx = 1,
+        rdx = 2,
+    };
+
+    /**
+     * @brief x86-64 machine code builder for a single block
+     */
+    class emitter
+    {
+    public:
+        void bytes(std::initializer_list<uint8_t> values) { m_code.insert(m_code.end(), values); }
+
+        void imm32(uint32_t value)
+        {
+            for (auto i = 0U; i < sizeof(value); ++i)
+            {
+                m_code.push_back(static_cast<uint8_t>(value >> (i * 8U)));
+            }
+        }
+
+        void imm64(uint64_t value)
+        {
+            for (auto i = 0U; i < sizeof(value); ++i)
+            {
+                m_code.push_back(static_cast<uint8_t>(value >> (i * 8U)));
+            }
+        }
+
+        /** `mov host, [rbx + guest * 8]` */
+        void load_reg(host_register host, uint8_t guest)
+        {
+            bytes({0x48, 0x8B, static_cast<uint8_t>(0x43U | (host << 3U)), static_cast<uint8_t>(guest * sizeof(uint64_t))});
+        }
+
+        /** `mov [rbx + guest * 8], host`, writes to r0 are dropped */
+        void store_reg(uint8_t guest, host_register host)
+        {
+            if (guest == 0)
+            {
+                return;
+            }
+            bytes({0x48, 0x89, static_cast<uint8_t>(0x43U | (host << 3U)), static_cast<uint8_t>(guest * sizeof(uint64_t))});
+        }
+
+        /** `mov host, imm64` */
+        void load_const(host_register host, uint64_t value)
+        {
+            bytes({0x48, static_cast<uint8_t>(0xB8U + host)});
+            imm64(value);
+        }
+
+        /** jump to the block epilogue, `condition` is a jcc opcode byte or 0 for an unconditional jump */
+        void jump_epilogue(uint8_t condition = 0)
+        {
+            if (condition == 0)
+            {
+                bytes({0xE9});
+            }
+            else
+            {
+                bytes({0x0F, condition});
+            }
+            m_epilogue_jumps.push_back(m_code.size());
+            imm32(0);
+        }
+
+        /** conditional jump to a stub that sends `address` to the interpreter */
+        void jump_interpret(uint8_t condition, uint64_t address)
+        {
+            bytes({0x0F, condition});
+            m_stub_jumps.emplace_back(m_code.size(), address);
+            imm32(0);
+        }
+
+        /** set the next address and leave through the epilogue, until the address gets linked */
+        void exit_to(uint64_t address)
+        {
+            load_const(rax, address);
+            jump_epilogue();
+            m_exits.push_back({m_epilogue_jumps.back(), 0, address});
+        }
+
+        /** conditional jump to `address`, through a stub until the address gets linked */
+        void branch_to(uint8_t condition, uint64_t address)
+        {
+            bytes({0x0F, condition});
+            m_branch_jumps.emplace_back(m_code.size(), address);
+            imm32(0);
+        }
+
+        /** leave the block asking the interpreter to run `address` */
+        void exit_interpreter(uint64_t address)
+        {
+            load_const(rax, address);
+            // mov qword [r15 + offsetof(exit)], exit_interpret
+            bytes({0x49, 0xC7, 0x47, static_cast<uint8_t>(offsetof(jit_context, exit))});
+            imm32(exit_interpret);
+            jump_epilogue();
+        }
+
+        void prologue()
+        {
+            // push rbx, rbp, r12, r13, r14, r15
+            bytes({0x53, 0x55, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57});
+            // mov r15, rdi
+            bytes({0x49, 0x89, 0xFF});
+            // mov rbx, [r15]; mov r12, [r15 + 8]; mov r13, [r15 + 16]; mov r14, [r15 + 24]
+            bytes({0x49, 0x8B, 0x5F, static_cast<uint8_t>(offsetof(jit_context, registers))});
+            bytes({0x4D, 0x8B, 0x67, static_cast<uint8_t>(offsetof(jit_context, memory))});
+            bytes({0x4D, 0x8B, 0x6F, static_cast<uint8_t>(offsetof(jit_context, memsize))});
+            bytes({0x4D, 0x8B, 0x77, static_cast<uint8_t>(offsetof(jit_context, pages))});
+            m_body = m_code.size();
+        }
+
+        /** offset of the code after the prologue */
+        [[nodiscard]] auto body() const noexcept -> size_t { return m_body; }
+
+        /** jumps to fixed addresses, complete once `finish` ran */
+        [[nodiscard]] auto exits() const noexcept -> std::vector<block_exit> const & { return m_exits; }
+
+        /**
+         * @brief emit the epilogue and the interpreter stubs, resolving every pending jump
+         * @return finished machine code
+         */
+        auto finish() -> std::vector<uint8_t>
+        {
+            const auto epilogue = m_code.size();
+            // pop r15, r14, r13, r12, rbp, rbx; ret
+            bytes({0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5D, 0x5B, 0xC3});
+
+            for (auto &exit : m_exits)
+            {
+                exit.unlinked = epilogue;
+            }
+
+            for (auto const &[position, address] : m_stub_jumps)
+            {
+                patch(position, m_code.size());
+                exit_interpreter(address);
+            }
+
+            for (auto const &[position, address] : m_branch_jumps)
+            {
+                m_exits.push_back({position, m_code.size(), address});
+                patch(position, m_code.size());
+                load_const(rax, address);
+                jump_epilogue();
+            }
+
+            for (auto position : m_epilogue_jumps)
+            {
+                patch(position, epilogue);
+            }
+
+            return std::move(m_code);
+        }
+
+    private:
+        void patch(size_t position, size_t target)
+        {
+            const auto relative = static_cast<uint32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(position + sizeof(uint32_t)));
+            std::memcpy(m_code.data() + position, &relative, sizeof(relative));
+        }
+
+        std::vector<uint8_t> m_code{};
+        std::vector<size_t> m_epilogue_jumps{};
+        std::vector<std::pair<size_t, uint64_t>> m_stub_jumps{};
+        std::vector<std::pair<size_t, uint64_t>> m_branch_jumps{};
+        std::vector<block_exit> m_exits{};
+        size_t m_body{0};
+    };
+
+    /** jcc opcode bytes (second byte of the near form) */
+    enum condition : uint8_t
+    {
+        jcc_above_equal = 0x83,
+        jcc_equal = 0x84,
+        jcc_not_equal = 0x85,
+        jcc_below_equal = 0x86,
+        jcc_above = 0x87,
+        jcc_less_equal = 0x8E,
+        jcc_greater = 0x8F,
+    };
+
+    /** setcc opcode bytes for the same conditions */
+    constexpr auto setcc(condition cond) -> uint8_t { return static_cast<uint8_t>(cond + 0x10U); }
+
+    /**
+     * @brief `rax <- rax op rcx` for the simple arithmetic opcodes
+     * @return false if the opcode is not a simple arithmetic one
+     */
+    auto emit_arithmetic(emitter &code, Opcodes opcode) -> bool
+    {
+        switch (opcode)
+        {
+        case Opcodes::andr_instrc:
+        case Opcodes::andi_instrc:
+            code.bytes({0x48, 0x21, 0xC8});
+            return true;
+        case Opcodes::xorr_instrc:
+        case Opcodes::xori_instrc:
+            code.bytes({0x48, 0x31, 0xC8});
+            return true;
+        case Opcodes::orr_instrc:
+        case Opcodes::ori_instrc:
+            code.bytes({0x48, 0x09, 0xC8});
+            return true;
+        case Opcodes::addr_instrc:
+        case Opcodes::addi_instrc:
+            code.bytes({0x48, 0x01, 0xC8});
+            return true;
+        case Opcodes::subr_instrc:
+        case Opcodes::subi_instrc:
+            code.bytes({0x48, 0x29, 0xC8});
+            return true;
+        case Opcodes::umulr_instrc:
+        case Opcodes::umuli_instrc:
+        case Opcodes::smulr_instrc:
+        case Opcodes::smuli_instrc:
+            // the low 64 bits are the same for signed and unsigned multiplication
+            code.bytes({0x48, 0x0F, 0xAF, 0xC1});
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief `rax <- shift(rax, rcx)`, clearing rax on amounts the helpers clear
+     * @param left true for left shifts
+     */
+    void emit_shift(emitter &code, bool left)
+    {
+        // cmp rcx, sizeof(uint64_t); jae clear
+        code.bytes({0x48, 0x83, 0xF9, sizeof(uint64_t), 0x73, 0x05});
+        // shl/shr rax, cl; jmp done
+        code.bytes({0x48, 0xD3, static_cast<uint8_t>(left ? 0xE0 : 0xE8), 0xEB, 0x02});
+        // clear: xor eax, eax
+        code.bytes({0x31, 0xC0});
+    }
+
+    /**
+     * @brief compute `rax <- base + imm` and check the access fits in memory
+     *
+     * @param size access width in bytes
+     * @param address address of the instruction, used if the access faults
+     */
+    void emit_address(emitter &code, uint8_t base, int64_t imm, uint8_t size, uint64_t address)
+    {
+        code.load_reg(rax, base);
+        code.load_const(rcx, static_cast<uint64_t>(imm));
+        code.bytes({0x48, 0x01, 0xC8});
+        // cmp rax, r13; jae interpret
+        code.bytes({0x4C, 0x39, 0xE8});
+        code.jump_interpret(jcc_above_equal, address);
+        // lea rdx, [rax + size]; cmp rdx, r13; ja interpret
+        code.bytes({0x48, 0x8D, 0x50, size, 0x4C, 0x39, 0xEA});
+        code.jump_interpret(jcc_above, address);
+    }
+
+    /**
+     * @brief check that a store on `rax` does not touch translated code
+     */
+    void emit_page_check(emitter &code, uint8_t size, uint64_t address)
+    {
+        // mov rdx, rax; shr rdx, code_page_bits; cmp byte [r14 + rdx], 0; jne interpret
+        code.bytes({0x48, 0x89, 0xC2, 0x48, 0xC1, 0xEA, Thread::code_page_bits, 0x41, 0x80, 0x3C, 0x16, 0x00});
+        code.jump_interpret(jcc_not_equal, address);
+
+        if (size == 1)
+        {
+            return;
+        }
+
+        // lea rdx, [rax + size - 1]; shr rdx, code_page_bits; cmp byte [r14 + rdx], 0; jne interpret
+        code.bytes({0x48, 0x8D, 0x50, static_cast<uint8_t>(size - 1), 0x48, 0xC1, 0xEA, Thread::code_page_bits, 0x41, 0x80, 0x3C, 0x16, 0x00});
+        code.jump_interpret(jcc_not_equal, address);
+    }
+
+    /**
+     * @brief translate a single instruction
+     *
+     * @param code emitter for the current block
+     * @param instr decoded instruction
+     * @param address address of the instruction
+     * @param[out] ends_block set if the instruction changed the program counter
+     *
+     * @return false if the instruction is not supported, nothing is emitted then
+     */
+    auto translate(emitter &code, decoded_instruction const &instr, uint64_t address, bool &ends_block) -> bool
+    {
+        /// the amount of bits not accounted by an linstruction immediate
+        constexpr auto low_bit_count = 13U;
+        const auto next = address + sizeof(uint64_t);
+
+        ends_block = false;
+
+        switch (instr.opcode)
+        {
+        case Opcodes::andr_instrc:
+        case Opcodes::xorr_instrc:
+        case Opcodes::orr_instrc:
+        case Opcodes::addr_instrc:
+        case Opcodes::subr_instrc:
+        case Opcodes::umulr_instrc:
+        case Opcodes::smulr_instrc:
+            code.load_reg(rax, instr.r1);
+            code.load_reg(rcx, instr.r2);
+            emit_arithmetic(code, instr.opcode);
+            code.store_reg(instr.rd, rax);
+            return true;
+        case Opcodes::andi_instrc:
+        case Opcodes::xori_instrc:
+        case Opcodes::ori_instrc:
+        case Opcodes::addi_instrc:
+        case Opcodes::subi_instrc:
+        case Opcodes::umuli_instrc:
+            code.load_reg(rax, instr.r1);
+            code.load_const(rcx, instr.uimm);
+            emit_arithmetic(code, instr.opcode);
+            code.store_reg(instr.rd, rax);
+            return true;
+        case Opcodes::smuli_instrc:
+            code.load_reg(rax, instr.r1);
+            code.load_const(rcx, static_cast<uint64_t>(instr.imm));
+            emit_arithmetic(code, instr.opcode);
+            code.store_reg(instr.rd, rax);
+            return true;
+        case Opcodes::not_instrc:
+            code.load_reg(rax, instr.r1);
+            code.bytes({0x48, 0xF7, 0xD0});
+            code.store_reg(instr.rd, rax);
+            return true;
+        case Opcodes::llsr_instrc:
+        case Opcodes::lrsr_instrc:
+            code.load_reg(rax, instr.r1);
+            code.load_reg(rcx, instr.r2);
+            emit_shift(code, instr.opcode == Opcodes::llsr_instrc);
+            code.store_reg(instr.rd, rax);
+            return true;
+        case Opcodes::llsi_instrc:
+        case Opcodes::lrsi_instrc:
+            code.load_reg(rax, instr.r1);
+            code.load_const(rcx, instr.uimm);
+            emit_shift(code, instr.opcode == Opcodes::llsi_instrc);
+            code.store_reg(instr.rd, rax);
+            return true;
+        /**/
+        case Opcodes::setgur_instrc:
+        case Opcodes::setgsr_instrc:
+        case Opcodes::setleur_instrc:
+        case Opcodes::setlesr_instrc:
+        case Opcodes::setgui_instrc:
+        case Opcodes::setgsi_instrc:
+        case Opcodes::setleui_instrc:
+        case Opcodes::setlesi_instrc:
+        {
+            constexpr condition conditions[] = {jcc_above, jcc_greater, jcc_below_equal, jcc_less_equal};
+            const auto index = (instr.opcode - Opcodes::setgur_instrc) / 2;
+            const auto is_signed = (index % 2) != 0;
+
+            code.load_reg(rax, instr.r1);
+            if ((instr.opcode & 1U) == 0)
+            {
+                code.load_reg(rcx, instr.r2);
+            }
+            else
+            {
+                code.load_const(rcx, is_signed ? static_cast<uint64_t>(instr.imm) : instr.uimm);
+            }
+            // cmp rax, rcx; setcc al; movzx eax, al
+            code.bytes({0x48, 0x39, 0xC8, 0x0F, setcc(conditions[index]), 0xC0, 0x0F, 0xB6, 0xC0});
+            code.store_reg(instr.rd, rax);
+            return true;
+        }
+        case Opcodes::lui_instrc:
+            code.load_reg(rax, instr.r1);
+            code.load_const(rcx, static_cast<uint64_t>(instr.imm) << low_bit_count);
+            code.bytes({0x48, 0x09, 0xC8});
+            code.store_reg(instr.r1, rax);
+            return true;
+        case Opcodes::auipc_instrc:
+            code.load_const(rax, next + (static_cast<uint64_t>(instr.imm) << low_bit_count));
+            code.store_reg(instr.r1, rax);
+            return true;
+        /**/
+        case Opcodes::ld_byte_instrc:
+        case Opcodes::ld_half_instrc:
+        case Opcodes::ld_word_instrc:
+        case Opcodes::ld_dwrd_instrc:
+        {
+            const auto width = instr.opcode - Opcodes::ld_byte_instrc;
+            emit_address(code, instr.r1, instr.imm, static_cast<uint8_t>(1U << width), address);
+            switch (width)
+            {
+            case 0: // movzx eax, byte [r12 + rax]
+                code.bytes({0x41, 0x0F, 0xB6, 0x04, 0x04});
+                break;
+            case 1: // movzx eax, word [r12 + rax]
+                code.bytes({0x41, 0x0F, 0xB7, 0x04, 0x04});
+                break;
+            case 2: // mov eax, dword [r12 + rax]
+                code.bytes({0x41, 0x8B, 0x04, 0x04});
+                break;
+            default: // mov rax, qword [r12 + rax]
+                code.bytes({0x49, 0x8B, 0x04, 0x04});
+                break;
+            }
+            code.store_reg(instr.rd, rax);
+            return true;
+        }
+        case Opcodes::st_byte_instrc:
+        case Opcodes::st_half_instrc:
+        case Opcodes::st_word_instrc:
+        case Opcodes::st_dwrd_instrc:
+        {
+            const auto width = instr.opcode - Opcodes::st_byte_instrc;
+            const auto size = static_cast<uint8_t>(1U << width);
+            emit_address(code, instr.rd, instr.imm, size, address);
+            emit_page_check(code, size, address);
+            code.load_reg(rcx, instr.r1);
+            switch (width)
+            {
+            case 0: // mov byte [r12 + rax], cl
+                code.bytes({0x41, 0x88, 0x0C, 0x04});
+                break;
+            case 1: // mov word [r12 + rax], cx
+                code.bytes({0x66, 0x41, 0x89, 0x0C, 0x04});
+                break;
+            case 2: // mov dword [r12 + rax], ecx
+                code.bytes({0x41, 0x89, 0x0C, 0x04});
+                break;
+            default: // mov qword [r12 + rax], rcx
+                code.bytes({0x49, 0x89, 0x0C, 0x04});
+                break;
+            }
+            return true;
+        }
+        /**/
+        case Opcodes::jal_instrc:
+            code.load_const(rax, next + sizeof(uint64_t));
+            code.store_reg(instr.r1, rax);
+            code.exit_to(next + static_cast<uint64_t>(instr.imm));
+            ends_block = true;
+            return true;
+        case Opcodes::jalr_instrc:
+            // the interpreter links first, `jalr rX, rX` jumps relative to the link (r0 included)
+            if (instr.rd == instr.r1)
+            {
+                code.load_const(rax, next + static_cast<uint64_t>(instr.imm) + next + sizeof(uint64_t));
+            }
+            else
+            {
+                code.load_reg(rax, instr.r1);
+                code.load_const(rcx, next + static_cast<uint64_t>(instr.imm));
+                code.bytes({0x48, 0x01, 0xC8});
+            }
+            code.load_const(rcx, next + sizeof(uint64_t));
+            code.store_reg(instr.rd, rcx);
+            code.jump_epilogue();
+            ends_block = true;
+            return true;
+        case Opcodes::je_instrc:
+        case Opcodes::jne_instrc:
+        case Opcodes::jgu_instrc:
+        case Opcodes::jgs_instrc:
+        case Opcodes::jleu_instrc:
+        case Opcodes::jles_instrc:
+        {
+            constexpr condition conditions[] = {jcc_equal, jcc_not_equal, jcc_above, jcc_greater, jcc_below_equal, jcc_less_equal};
+            code.load_reg(rax, instr.rd);
+            code.load_reg(rcx, instr.r1);
+            // cmp rax, rcx
+            code.bytes({0x48, 0x39, 0xC8});
+            code.branch_to(conditions[instr.opcode - Opcodes::je_instrc], next + static_cast<uint64_t>(instr.imm));
+            code.exit_to(next);
+            ends_block = true;
+            return true;
+        }
+        default:
+            // divisions, stack instructions, processor calls, i/o and extensions
+            return false;
+        }
+    }
+
+    /**
+     * @brief executable memory holding translated blocks
+     *
+     * the cache is never writable and executable at once, it is writable
+     * while blocks are copied in and turned executable before they run
+     */
+    class code_cache
+    {
+    public:
+        code_cache()
+        {
+            void *memory = mmap(nullptr, code_cache_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory != MAP_FAILED)
+            {
+                m_memory = static_cast<uint8_t *>(memory);
+            }
+        }
+
+        code_cache(code_cache const &) = delete;
+        code_cache(code_cache &&) = delete;
+        auto operator=(code_cache const &) -> code_cache & = delete;
+        auto operator=(code_cache &&) -> code_cache & = delete;
+
+        ~code_cache()
+        {
+            if (m_memory != nullptr)
+            {
+                munmap(m_memory, code_cache_size);
+            }
+        }
+
+        [[nodiscard]] auto valid() const noexcept -> bool { return m_memory != nullptr; }
+
+        /**
+         * @brief copy machine code into the cache, making it writable again if needed
+         * @return pointer to the copied code, `nullptr` if the cache is full
+         */
+        auto insert(std::vector<uint8_t> const &code) noexcept -> uint8_t *
+        {
+            if (m_memory == nullptr || code_cache_size - m_used < code.size() || !writable())
+            {
+                return nullptr;
+            }
+
+            auto *position = m_memory + m_used;
+            std::memcpy(position, code.data(), code.size());
+            // keep blocks 16 byte aligned
+            m_used = (m_used + code.size() + 15U) & ~15LLU;
+            return position;
+        }
+
+        /**
+         * @brief make the cache executable, and read only, before running anything in it
+         * @return false if the host refused, nothing in the cache can run then
+         */
+        auto seal() noexcept -> bool
+        {
+            if (!m_executable && m_memory != nullptr)
+            {
+                m_executable = mprotect(m_memory, code_cache_size, PROT_READ | PROT_EXEC) == 0;
+            }
+            return m_executable;
+        }
+
+        /**
+         * @brief point a jump inside the cache somewhere else, making the cache writable again if needed
+         * @param site 32 bit displacement of the jump
+         * @param target new destination
+         * @return false if the host refused to make the cache writable, the jump is left as it was
+         */
+        auto link(uint8_t *site, uint8_t const *target) noexcept -> bool
+        {
+            if (!writable())
+            {
+                return false;
+            }
+
+            const auto relative = static_cast<uint32_t>(target - (site + sizeof(uint32_t)));
+            std::memcpy(site, &relative, sizeof(relative));
+            return true;
+        }
+
+        void clear() noexcept { m_used = 0; }
+
+    private:
+        auto writable() noexcept -> bool
+        {
+            if (m_executable)
+            {
+                if (mprotect(m_memory, code_cache_size, PROT_READ | PROT_WRITE) != 0)
+                {
+                    return false;
+                }
+                m_executable = false;
+            }
+            return true;
+        }
+
+        uint8_t *m_memory{nullptr};
+        uint64_t m_used{0};
+        bool m_executable{false};
+    };
+#endif
+
+    /**
+     * @brief translates and runs blocks for a single thread
+     *
+     * blocks run on the interpreter until they got entered often enough to
+     * be worth translating. jumps to fixed addresses get linked straight to
+     * the translated block they lead to, so hot loops stay in native code
+     */
+    class translator
+    {
+    public:
+        translator(Thread &thread, uint64_t threshold)
+            : m_thread{thread},
+              m_pages((thread.memsize() >> Thread::code_page_bits) + 2, 0),
+              m_threshold{std::max<uint64_t>(threshold, 1)}
+        {
+            m_context.registers = thread.allregs().data();
+            m_context.pages = m_pages.data();
+            m_thread.watch_code(m_pages.data());
+            // whatever the interpreter cached so far sits on pages nothing watches
+            m_thread.flush_decoded();
+            watch_stores();
+        }
+
+        translator(translator const &) = delete;
+        translator(translator &&) = delete;
+        auto operator=(translator const &) -> translator & = delete;
+        auto operator=(translator &&) -> translator & = delete;
+
+        ~translator() { m_thread.watch_code(nullptr); }
+
+        /**
+         * @brief run the thread until its signal changes
+         */
+        void run()
+        {
+            while (m_thread.signal() == supernova::DoNotDestroy)
+            {
+                if (m_thread.code_written())
+                {
+                    drop_written();
+                }
+                if (m_thread.intvec() != m_vector)
+                {
+                    watch_stores();
+                }
+
+                // translated code accesses memory directly, paged threads stay on the interpreter
+                if (m_thread.paging())
+                {
+                    supernova::run_for(m_thread, paged_budget);
+                    continue;
+                }
+
+                // native handlers are free to move memory, e.g. into guard pages
+                m_context.memory = m_thread.memory().get();
+                m_context.memsize = m_thread.memsize();
+
+                const auto address = m_thread.progc();
+                auto *current = &lookup(address);
+                if (current->function == nullptr && ++current->hits == m_threshold)
+                {
+                    current = &promote(address);
+                }
+
+                if (current->function == nullptr || !seal())
+                {
+                    // up to the end of the block, so the one after it gets counted
+                    supernova::run_for(m_thread, current->length);
+                    continue;
+                }
+
+                m_context.exit = 0;
+                m_thread.progc() = current->function(&m_context);
+
+                if (m_context.exit == exit_interpret)
+                {
+                    supernova::run_for(m_thread, 1);
+                }
+            }
+        }
+
+    private:
+        /**
+         * @brief find the block starting at an address, measuring it if it is new
+         */
+        auto lookup(uint64_t address) -> block &
+        {
+            auto found = m_blocks.find(address);
+            if (found != m_blocks.end())
+            {
+                return found->second;
+            }
+
+            block entry{};
+            entry.start = address;
+            entry.end = address;
+            entry.length = measure(address);
+            return m_blocks.emplace(address, std::move(entry)).first->second;
+        }
+
+        /**
+         * @brief translate a block that got hot, linking the jumps waiting for it
+         */
+        auto promote(uint64_t address) -> block &
+        {
+            // a full cache flushes every block, the one being translated included
+            auto translated = compile(address);
+            auto &entry = lookup(address);
+            if (translated.function == nullptr)
+            {
+                return entry;
+            }
+
+            translated.hits = entry.hits;
+            translated.length = entry.length;
+            entry = std::move(translated);
+
+            auto found = m_links.find(address);
+            if (found != m_links.end())
+            {
+                for (auto const &jump : found->second)
+                {
+                    relink(jump.site, entry.body);
+                }
+            }
+            return entry;
+        }
+
+        /**
+         * @brief count the instructions the interpreter runs on each entry to an untranslated block
+         *
+         * blocks end like translated ones, after a jump or after the first
+         * instruction without a translation. blocks starting on those end
+         * right before the next instruction with one, which starts a block
+         * able to get hot on its own
+         */
+        auto measure(uint64_t start) -> uint64_t
+        {
+#ifdef SUPERNOVA_JIT_X86_64
+            emitter scratch{};
+            uint64_t count = 0;
+            auto leading = false;
+
+            for (auto address = start; count < max_block_length; ++count, address += sizeof(uint64_t))
+            {
+                if (address >= m_context.memsize || m_context.memsize - address < sizeof(uint64_t))
+                {
+                    break;
+                }
+
+                uint64_t raw = 0;
+                std::memcpy(&raw, m_context.memory + address, sizeof(raw));
+
+                auto ends_block = false;
+                const auto translated = translate(scratch, supernova::decode(raw, address), address, ends_block);
+                leading = count == 0 ? translated : leading;
+
+                if (translated != leading)
+                {
+                    return translated ? count : count + 1;
+                }
+                if (ends_block)
+                {
+                    return count + 1;
+                }
+            }
+
+            // an entry past memory still runs the instruction that faults
+            return count == 0 ? 1 : count;
+#else
+            static_cast<void>(start);
+            return 1;
+#endif
+        }
+
+        auto compile(uint64_t start) -> block
+        {
+            block result{};
+            result.start = start;
+            result.end = start;
+#ifdef SUPERNOVA_JIT_X86_64
+            emitter code{};
+            auto address = start;
+            auto count = 0;
+            auto ends_block = false;
+
+            code.prologue();
+
+            for (; count < max_block_length && !ends_block; ++count, address += sizeof(uint64_t))
+            {
+                if (address >= m_context.memsize || m_context.memsize - address < sizeof(uint64_t))
+                {
+                    break;
+                }
+
+                uint64_t raw = 0;
+                std::memcpy(&raw, m_context.memory + address, sizeof(raw));
+
+                if (!translate(code, supernova::decode(raw, address), address, ends_block))
+                {
+                    break;
+                }
+            }
+
+            // not even the first instruction could be translated
+            if (count == 0)
+            {
+                return result;
+            }
+
+            if (!ends_block)
+            {
+                // the last instruction either needs the interpreter or fell off the block
+                if (count < max_block_length)
+                {
+                    code.exit_interpreter(address);
+                }
+                else
+                {
+                    code.exit_to(address);
+                }
+            }
+
+            const auto machine_code = code.finish();
+            auto *native = m_cache.insert(machine_code);
+            if (native == nullptr)
+            {
+                // cache is full, start over
+                flush();
+                native = m_cache.insert(machine_code);
+            }
+
+            if (native == nullptr)
+            {
+                return result;
+            }
+
+            result.function = reinterpret_cast<block_function>(native);
+            result.body = native + code.body();
+            result.limit = native + machine_code.size();
+            result.end = address;
+
+            for (auto page = start >> Thread::code_page_bits; page <= (address - 1) >> Thread::code_page_bits; ++page)
+            {
+                m_pages[page] = Thread::code_page_translated;
+            }
+
+            // exits to blocks already translated jump straight into them
+            for (auto const &exit : code.exits())
+            {
+                auto *site = native + exit.site;
+                m_links[exit.target].push_back({site, native + exit.unlinked});
+                result.exits.push_back(exit.target);
+
+                auto found = m_blocks.find(exit.target);
+                if (found != m_blocks.end() && found->second.function != nullptr)
+                {
+                    relink(site, found->second.body);
+                }
+            }
+#endif
+            return result;
+        }
+
+        /**
+         * @brief drop every block on pages that got written to
+         */
+        void drop_written()
+        {
+            auto unlinked = true;
+
+            for (auto it = m_blocks.begin(); it != m_blocks.end();)
+            {
+                auto const &current = it->second;
+                auto written = false;
+
+                for (auto page = current.start >> Thread::code_page_bits; current.end > current.start && page <= (current.end - 1) >> Thread::code_page_bits; ++page)
+                {
+                    written = written || m_pages[page] == Thread::code_page_written;
+                }
+
+                if (written)
+                {
+                    unlinked = unlink(current) && unlinked;
+                }
+
+                it = written ? m_blocks.erase(it) : std::next(it);
+            }
+
+            // interpreted stores already dropped what the interpreter cached, native ones on the same pages did not
+            for (uint64_t page = 0; page < m_pages.size(); ++page)
+            {
+                if (m_pages[page] == Thread::code_page_written)
+                {
+                    m_thread.invalidate_decoded(page << Thread::code_page_bits, 1ULL << Thread::code_page_bits);
+                    m_pages[page] = 0;
+                }
+            }
+
+            // jumps still going into dropped code leave nothing to keep
+            if (!unlinked)
+            {
+                flush();
+            }
+
+            m_thread.code_written() = false;
+            watch_stores();
+        }
+
+        /**
+         * @brief send jumps into a dropped block back through their stubs, and forget the jumps it made
+         * @return false if a jump could not be sent back
+         */
+        auto unlink(block const &dropped) -> bool
+        {
+            auto restored = true;
+
+            auto found = m_links.find(dropped.start);
+            if (found != m_links.end())
+            {
+                for (auto const &jump : found->second)
+                {
+                    restored = relink(jump.site, jump.unlinked) && restored;
+                }
+            }
+
+            for (auto target : dropped.exits)
+            {
+                auto &jumps = m_links[target];
+                jumps.erase(std::remove_if(jumps.begin(), jumps.end(),
+                                           [&dropped](link const &jump) { return jump.site >= dropped.body && jump.site < dropped.limit; }),
+                            jumps.end());
+            }
+
+            return restored;
+        }
+
+        /**
+         * @brief send stores to the interrupt vector and read only mappings through the interpreter
+         *
+         * their pages are marked like translated code, so native stores to them
+         * take the interpreter, which drops the handlers the thread cached or
+         * turns the fault into `MemoryLimit`
+         */
+        void watch_stores()
+        {
+            constexpr auto span = Thread::vector_cache_size * sizeof(uint64_t);
+            constexpr auto page_mask = (1ULL << Thread::code_page_bits) - 1;
+
+            m_vector = m_thread.intvec();
+            const auto first = m_vector >> Thread::code_page_bits;
+            const auto last = first + (((m_vector & page_mask) + span - 1) >> Thread::code_page_bits);
+            watch_pages(first, last);
+
+            for (auto const &range : m_thread.read_only())
+            {
+                watch_pages(range.first >> Thread::code_page_bits, (range.second - 1) >> Thread::code_page_bits);
+            }
+        }
+
+        void watch_pages(uint64_t first, uint64_t last)
+        {
+            for (auto page = first; page <= last && page < m_pages.size(); ++page)
+            {
+                m_pages[page] = m_pages[page] == 0 ? Thread::code_page_translated : m_pages[page];
+            }
+        }
+
+        auto seal() noexcept -> bool
+        {
+#ifdef SUPERNOVA_JIT_X86_64
+            return m_cache.seal();
+#else
+            return false;
+#endif
+        }
+
+        auto relink(uint8_t *site, uint8_t const *target) noexcept -> bool
+        {
+#ifdef SUPERNOVA_JIT_X86_64
+            return m_cache.link(site, target);
+#else
+            static_cast<void>(site);
+            static_cast<void>(target);
+            return false;
+#endif
+        }
+
+        void flush()
+        {
+            m_blocks.clear();
+            m_links.clear();
+            std::fill(m_pages.begin(), m_pages.end(), 0);
+            // pages are no longer watched for what the interpreter cached either
+            m_thread.flush_decoded();
+            watch_stores();
+#ifdef SUPERNOVA_JIT_X86_64
+            m_cache.clear();
+#endif
+        }
+
+        Thread &m_thread;
+        std::vector<uint8_t> m_pages;
+        uint64_t m_threshold;
+        uint64_t m_vector{0};
+        jit_context m_context{};
+        std::unordered_map<uint64_t, block> m_blocks{};
+        std::unordered_map<uint64_t, std::vector<link>> m_links{}; /**< jumps to each fixed address, linked or not */
+#ifdef SUPERNOVA_JIT_X86_64
+        code_cache m_cache{};
+#endif
+    };
+} // namespace
+
+namespace supernova::jit
+{
+    auto available() noexcept -> bool
+    {
+#ifdef SUPERNOVA_JIT_X86_64
+        static const auto usable = code_cache{}.valid();
+        return usable;
+#else
+        return false;
+#endif
+    }
+
+    auto run(int argc, char **argv, Thread &thread, uint64_t threshold) -> thread_return
+    {
+        if (!available())
+        {
+            return supernova::run(argc, argv, thread);
+        }
+
+        thread.registers(0) = 0;
+        thread.registers(Thread::pcall_1stret) = argc;
+        thread.registers(Thread::pcall_2ndret) = reinterpret_cast<uint64_t>(argv);
+
+        translator{thread, threshold}.run();
+
+        const int ret_val = thread.registers(1);
+
+        if (thread.signal() == ProgramEnd)
+        {
+            return thread_return{true, ret_val};
+        }
+
+        return {false, thread.signal()};
+    }
+} // namespace supernova::jit
@@ -0,0 +1,116 @@
+#include "supernova.h"
+
+namespace supernova
+{
+    auto Thread::enable_paging(uint64_t root) noexcept -> bool
+    {
+        if (this->m_page_bits == 0)
+        {
+            return false;
+        }
+
+        if (this->m_tlb == nullptr)
+        {
+            this->m_tlb.reset(new (std::nothrow) tlb_entry[tlb_size]{});
+            if (this->m_tlb == nullptr)
+            {
+                return false;
+            }
+        }
+
+        this->m_page_table = root;
+        this->m_paging = true;
+        this->flush_tlb();
+        return true;
+    }
+
+    void Thread::disable_paging() noexcept
+    {
+        if (!this->m_paging)
+        {
+            return;
+        }
+
+        this->m_paging = false;
+        this->flush_tlb();
+    }
+
+    void Thread::flush_tlb() noexcept
+    {
+        // instructions are cached by the address they were fetched from, which may now map somewhere else
+        this->flush_decoded();
+
+        if (this->m_tlb == nullptr)
+        {
+            return;
+        }
+
+        for (auto i = 0; i < tlb_size; ++i)
+        {
+            this->m_tlb[i].page = ~0LLU;
+        }
+    }
+
+    void Thread::flush_tlb(uint64_t address) noexcept
+    {
+        if (this->m_tlb == nullptr || this->m_page_bits == 0)
+        {
+            return;
+        }
+
+        const auto page = address >> this->m_page_bits;
+        auto &entry = this->m_tlb[page & (tlb_size - 1)];
+        if (entry.page == page)
+        {
+            entry.page = ~0LLU;
+        }
+
+        this->invalidate_decoded(page << this->m_page_bits, 1ULL << this->m_page_bits);
+    }
+
+    auto Thread::walk_pages(uint64_t address, uint8_t access) noexcept -> uint64_t
+    {
+        constexpr uint64_t present = PageRead | PageWrite | PageExecute;
+        const auto index_bits = this->m_page_bits - 3;
+        const auto offset_mask = (1ULL << this->m_page_bits) - 1;
+        const auto levels = this->page_levels();
+
+        // addresses past what the tables reach are never mapped
+        const auto reach = this->m_page_bits + index_bits * levels;
+        if (reach < 64 && (address >> reach) != 0)
+        {
+            return untranslated;
+        }
+
+        auto table = this->m_page_table & ~offset_mask;
+        uint64_t entry = 0;
+        for (auto level = levels; level-- > 0;)
+        {
+            const auto index = (address >> (this->m_page_bits + index_bits * level)) & ((1ULL << index_bits) - 1);
+            const auto slot = table + index * sizeof(uint64_t);
+            if (slot >= this->m_memory_size || this->m_memory_size - slot < sizeof(uint64_t))
+            {
+                return untranslated;
+            }
+
+            // NOLINTNEXTLINE: tables are page aligned, bounds were checked above
+            entry = *reinterpret_cast<uint64_t const *>(this->m_memory.get() + slot);
+            if ((entry & present) == 0)
+            {
+                return untranslated;
+            }
+            table = entry & ~offset_mask;
+        }
+
+        if ((entry & access) != access || table >= this->m_memory_size)
+        {
+            return untranslated;
+        }
+
+        auto &cached = this->m_tlb[(address >> this->m_page_bits) & (tlb_size - 1)];
+        cached.page = address >> this->m_page_bits;
+        cached.frame = table;
+        cached.access = static_cast<uint8_t>(entry & present);
+        return table | (address & offset_mask);
+    }
+} // namespace supernova
@@ -0,0 +1,289 @@
+#include "supernova.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Thread = supernova::Thread;
+    using namespace supernova::headers;
+
+    /**
+     * @brief named range of memory
+     */
+    struct symbol
+    {
+        uint64_t address; /**< first byte */
+        uint64_t size;    /**< size in bytes, 0 reaches until the next symbol */
+        std::string name; /**< name written on stacks */
+    };
+
+    /**
+     * @brief read a double word from thread memory without going through processor calls
+     *
+     * while paging is on the address goes through the page tables like a
+     * load would, a page at a time
+     *
+     * @param[out] value double word read
+     *
+     * @return false if the double word is not inside memory or a page is not readable
+     */
+    auto peek(Thread &thread, uint64_t address, uint64_t &value) noexcept -> bool
+    {
+        uint8_t bytes[sizeof(uint64_t)]{};
+        for (uint64_t done = 0; done < sizeof(bytes);)
+        {
+            auto physical = address + done;
+            auto chunk = sizeof(bytes) - done;
+            if (thread.paging())
+            {
+                chunk = std::min(chunk, thread.page_size() - physical % thread.page_size());
+                physical = thread.translate(physical, supernova::PageRead);
+            }
+
+            if (physical == Thread::untranslated || physical >= thread.memsize() || thread.memsize() - physical < chunk)
+            {
+                return false;
+            }
+            std::memcpy(bytes + done, thread.memory().get() + physical, chunk);
+            done += chunk;
+        }
+
+        std::memcpy(&value, bytes, sizeof(value));
+        return true;
+    }
+
+    /**
+     * @brief read symbols from a debug region
+     *
+     * @return false if the region does not hold symbols
+     */
+    auto read_symbols(std::ifstream &file, memory_map const &region, std::vector<symbol> &symbols) -> bool
+    {
+        uint64_t header[2]{};
+        if (region.size < sizeof(header))
+        {
+            return false;
+        }
+
+        file.seekg(static_cast<std::streamoff>(region.start));
+        // NOLINTNEXTLINE: plain double words
+        if (!file.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != symbols_magic)
+        {
+            return false;
+        }
+
+        auto left = region.size - sizeof(header);
+        for (uint64_t i = 0; i < header[1]; ++i)
+        {
+            symbol_record record{};
+            if (left < sizeof(record))
+            {
+                return false;
+            }
+
+            // NOLINTNEXTLINE: plain double words
+            file.read(reinterpret_cast<char *>(&record), sizeof(record));
+            left -= sizeof(record);
+
+            const auto padded = (record.name_length + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+            if (!file || padded < record.name_length || left < padded)
+            {
+                return false;
+            }
+
+            std::string name(record.name_length, '\0');
+            file.read(name.data(), static_cast<std::streamsize>(record.name_length));
+            file.seekg(static_cast<std::streamoff>(padded - record.name_length), std::ios::cur);
+            left -= padded;
+
+            symbols.push_back(symbol{record.address, record.size, std::move(name)});
+        }
+
+        return static_cast<bool>(file);
+    }
+} // namespace
+
+namespace supernova
+{
+    struct profiler_state
+    {
+        uint64_t interval;     /**< instructions between samples */
+        uint8_t base_register; /**< register holding the base pointer */
+        uint64_t samples{0};   /**< samples taken */
+
+        /** addresses of every sampled stack, callers first, and how many times it was seen */
+        std::map<std::vector<uint64_t>, uint64_t> stacks{};
+
+        std::vector<symbol> symbols{}; /**< symbols, sorted by address */
+
+        /** find the first symbol after an address */
+        auto after(uint64_t address) const -> std::vector<symbol>::const_iterator
+        {
+            return std::upper_bound(this->symbols.begin(), this->symbols.end(), address,
+                                    [](uint64_t value, symbol const &entry) { return value < entry.address; });
+        }
+
+        /**
+         * @brief name the symbol holding an address, or the address in hex
+         *
+         * @param address address to name
+         * @param caller set for return addresses, which point past the call
+         */
+        auto name(uint64_t address, bool caller) const -> std::string
+        {
+            const auto inside = caller ? address - 1 : address;
+            auto found = this->after(inside);
+
+            if (found != this->symbols.begin())
+            {
+                --found;
+                if (found->size == 0 || inside - found->address < found->size)
+                {
+                    return found->name;
+                }
+            }
+
+            constexpr auto digits = "0123456789abcdef";
+            std::string hex{"0x"};
+            auto shift = 60;
+            while (shift > 0 && ((address >> shift) & 0xFU) == 0)
+            {
+                shift -= 4;
+            }
+            for (; shift >= 0; shift -= 4)
+            {
+                hex += digits[(address >> shift) & 0xFU];
+            }
+            return hex;
+        }
+    };
+
+    profiler::profiler(uint64_t interval, uint8_t base_register)
+        : m_state{std::make_unique<profiler_state>()}
+    {
+        this->m_state->interval = interval == 0 ? 1 : interval;
+        this->m_state->base_register = base_register % Thread::register_count;
+    }
+
+    profiler::profiler(profiler &&) noexcept = default;
+    auto profiler::operator=(profiler &&) noexcept -> profiler & = default;
+    profiler::~profiler() = default;
+
+    auto profiler::run(Thread &thread, dispatch_engine engine) -> run_result
+    {
+        uint64_t executed = 0;
+        auto result = run_for(thread, this->m_state->interval, engine);
+
+        while (result.status == BudgetExhausted)
+        {
+            executed += result.executed;
+            this->sample(thread);
+            result = run_for(thread, this->m_state->interval, engine);
+        }
+
+        result.executed += executed;
+        return result;
+    }
+
+    void profiler::sample(Thread &thread)
+    {
+        auto &state = *this->m_state;
+
+        // walked leaf first, stored callers first
+        std::vector<uint64_t> stack{thread.progc()};
+        auto frame = thread.registers(state.base_register);
+
+        while (stack.size() < max_depth && frame >= 2 * sizeof(uint64_t))
+        {
+            uint64_t previous = 0;
+            uint64_t returns = 0;
+            if (!peek(thread, frame - 2 * sizeof(uint64_t), previous) || !peek(thread, frame - sizeof(uint64_t), returns))
+            {
+                break;
+            }
+
+            stack.push_back(returns);
+
+            // frames only go down, anything else is a broken chain
+            if (previous >= frame)
+            {
+                break;
+            }
+            frame = previous;
+        }
+
+        std::reverse(stack.begin(), stack.end());
+        ++state.stacks[stack];
+        ++state.samples;
+    }
+
+    void profiler::add_symbol(uint64_t address, uint64_t size, char const *name)
+    {
+        auto &state = *this->m_state;
+        state.symbols.insert(state.after(address), symbol{address, size, name});
+    }
+
+    auto profiler::load_symbols(char const *filename, headers::read_return const &image) -> uint64_t
+    {
+        auto file = std::ifstream(filename, std::ios::binary | std::ios::in);
+        if (!file)
+        {
+            return 0;
+        }
+
+        std::vector<symbol> symbols;
+        for (uint64_t i = 0; i < image.region_count; ++i)
+        {
+            auto const &region = image.regions[i];
+
+            // a broken table keeps the symbols read before it broke
+            if ((region.flags & memory_flags::mem_exists) == 0 && !read_symbols(file, region, symbols))
+            {
+                file.clear();
+            }
+        }
+
+        for (auto &entry : symbols)
+        {
+            auto &state = *this->m_state;
+            state.symbols.insert(state.after(entry.address), std::move(entry));
+        }
+        return symbols.size();
+    }
+
+    void profiler::write_folded(std::ostream &output) const
+    {
+        auto const &state = *this->m_state;
+
+        // stacks with different addresses can end up with the same names
+        std::map<std::string, uint64_t> folded;
+        for (auto const &[stack, count] : state.stacks)
+        {
+            std::string line;
+            for (size_t i = 0; i < stack.size(); ++i)
+            {
+                if (i != 0)
+                {
+                    line += ';';
+                }
+                line += state.name(stack[i], i + 1 != stack.size());
+            }
+            folded[line] += count;
+        }
+
+        for (auto const &[line, count] : folded)
+        {
+            output << line << ' ' << count << '\n';
+        }
+    }
+
+    auto profiler::samples() const noexcept -> uint64_t
+    {
+        return this->m_state->samples;
+    }
+} // namespace supernova
@@ -4,7 +4,141 @@
 #include <iomanip>
 #include <iostream>
 
-supernova::headers::read_return supernova::headers::read_file(char const *filename)
+// hosts with mmap are able to load images lazily
+#if defined(__unix__) || defined(__APPLE__)
+#define SUPERNOVA_MAPPED_LOAD 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef SUPERNOVA_MAPPED_LOAD
+namespace
+{
+    using namespace supernova::headers;
+    using mapped_memory = std::unique_ptr<uint8_t[], supernova::memory_deleter>;
+
+    /**
+     * @brief read a byte range of a file, retrying short reads
+     *
+     * @return true if every byte was read
+     */
+    auto read_range(int descriptor, uint8_t *destination, uint64_t size, uint64_t position) -> bool
+    {
+        while (size != 0)
+        {
+            const auto got = pread(descriptor, destination, size, static_cast<off_t>(position));
+            if (got <= 0)
+            {
+                return false;
+            }
+            destination += got;
+            position += static_cast<uint64_t>(got);
+            size -= static_cast<uint64_t>(got);
+        }
+        return true;
+    }
+
+    /**
+     * @brief bring a region into mapped memory
+     *
+     * whole pages come straight from the file (or fresh zero pages for
+     * `mem_clear`) when the alignments allow it, partial pages at both ends
+     * are read or cleared in place
+     *
+     * @return true on success
+     */
+    auto map_region(int descriptor, uint8_t *memory, memory_map const &region, uint64_t page) -> bool
+    {
+        const auto end = region.offset + region.size;
+        const auto first = (region.offset + page - 1) & ~(page - 1);
+        const auto last = end & ~(page - 1);
+        const auto is_clear = (region.flags & memory_flags::mem_clear) != 0;
+        const auto aligned = is_clear || (region.start & (page - 1)) == (region.offset & (page - 1));
+
+        if (!aligned || first >= last)
+        {
+            if (is_clear)
+            {
+                std::memset(memory + region.offset, 0, region.size);
+                return true;
+            }
+            return read_range(descriptor, memory + region.offset, region.size, region.start);
+        }
+
+        void *pages = nullptr;
+        if (is_clear)
+        {
+            pages = mmap(memory + first, last - first, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+        }
+        else
+        {
+            pages = mmap(memory + first, last - first, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, descriptor,
+                         static_cast<off_t>(region.start + (first - region.offset)));
+        }
+
+        if (pages == MAP_FAILED)
+        {
+            return false;
+        }
+
+        if (is_clear)
+        {
+            std::memset(memory + region.offset, 0, first - region.offset);
+            std::memset(memory + last, 0, end - last);
+            return true;
+        }
+
+        return read_range(descriptor, memory + region.offset, first - region.offset, region.start) &&
+               read_range(descriptor, memory + last, end - last, region.start + (last - region.offset));
+    }
+
+    /**
+     * @brief map an image, everything outside regions is left as zero pages
+     *
+     * @return memory, or `nullptr` if the host refused to map it
+     */
+    auto map_image(char const *filename, main_header const &main, memory_map const *regions) -> mapped_memory
+    {
+        const auto page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        const auto length = (main.memory_size + page - 1) & ~(page - 1);
+
+        if (length == 0)
+        {
+            return nullptr;
+        }
+
+        const auto descriptor = open(filename, O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0)
+        {
+            return nullptr;
+        }
+
+        auto *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(descriptor);
+            return nullptr;
+        }
+
+        auto memory = mapped_memory(static_cast<uint8_t *>(mapping), supernova::memory_deleter{mapping, length});
+
+        auto mapped = true;
+        for (size_t i = 0; i < main.memory_regions && mapped; ++i)
+        {
+            if ((regions[i].flags & memory_flags::mem_exists) != 0)
+            {
+                mapped = map_region(descriptor, memory.get(), regions[i], page);
+            }
+        }
+
+        close(descriptor);
+        return mapped ? std::move(memory) : nullptr;
+    }
+} // namespace
+#endif
+
+supernova::headers::read_return supernova::headers::read_file(char const *filename, load_mode mode)
 {
     auto file = std::ifstream(filename, std::ios::binary | std::ios::in | std::ios::ate);
     main_header main{};
@@ -71,12 +205,30 @@ supernova::headers::read_return supernova::headers::read_file(char const *filena
             return read_return{read_status::InvalidMemoryRegion};
         }
 
-        if (region.start + region.size > size)
+        // cleared regions are not in the file, their start is ignored
+        if ((region.flags & memory_flags::mem_clear) == 0 && region.start + region.size > size)
         {
             return read_return{read_status::InvalidMemoryRegion};
         }
     }
 
+#ifdef SUPERNOVA_MAPPED_LOAD
+    if (mode == LoadMapped)
+    {
+        // a failed mapping still gets a chance to be copied
+        auto memory = map_image(filename, main, memory_maps.get());
+        if (memory != nullptr)
+        {
+            auto result = read_return{ReadOk, main.memory_size, main.entry_point, std::move(memory)};
+            result.regions = std::move(memory_maps);
+            result.region_count = main.memory_regions;
+            return result;
+        }
+    }
+#else
+    static_cast<void>(mode);
+#endif
+
     auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[main.memory_size]);
 
     for (size_t i = 0; i < main.memory_regions; ++i)
@@ -91,7 +243,7 @@ supernova::headers::read_return supernova::headers::read_file(char const *filena
 
         if (region.flags & memory_flags::mem_clear)
         {
-            std::memset(memory.get() + region.start, 0, region.size);
+            std::memset(memory.get() + region.offset, 0, region.size);
             continue;
         }
 
@@ -101,10 +253,15 @@ supernova::headers::read_return supernova::headers::read_file(char const *filena
         file.read(reinterpret_cast<char *>(memory.get() + region.offset), region.size);
     }
 
-    return read_return{
+    auto result = read_return{
         ReadOk,
         main.memory_size,
         main.entry_point,
         std::move(memory),
     };
+
+    result.regions = std::move(memory_maps);
+    result.region_count = main.memory_regions;
+
+    return result;
 }
\ No newline at end of file
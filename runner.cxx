@@ -1,10 +1,16 @@
 #include "supernova.h"
+#include <fstream>
 #include <iostream>
 #include <bitset>
 #ifndef SUPERNOVA_VERSION
 #define SUPERNOVA_VERSION ""
 #endif
 
+// where the runner attaches its devices on the i/o bus
+constexpr uint64_t console_port = 0x00;
+constexpr uint64_t timer_port = 0x08;
+constexpr uint64_t disk_port = 0x10;
+
 [[gnu::cold]]
 void print_help() {
     std::cout <<
@@ -13,7 +19,15 @@ void print_help() {
         "options:\n"
         "  -h --help           | display this help\n"
         "  -v --version        | print current version\n"
-        "  -p --properties     | get current virtual machine properties\n";
+        "  -p --properties     | get current virtual machine properties\n"
+        "  -j --jit            | translate hot code to native instructions\n"
+        "  -g --guard-pages    | catch out of range accesses with guard pages\n"
+        "  -m --mapped         | map the executable instead of reading it, pages load when touched\n"
+        "  -s --stats          | print what the interpreter executed once the program ends\n"
+        "     --stats-json     | same as --stats, as JSON\n"
+        "     --profile file   | sample guest call stacks into file, as folded stacks\n"
+        "     --no-fusion      | run every instruction on its own, without superinstructions\n"
+        "     --disk file      | attach file as a block device\n";
 }
 
 [[gnu::cold]]
@@ -22,23 +36,29 @@ void print_properties() {
         "Properties:\n"
         "===================\n"
         "thread model:\n" 
-        "\tflags: 0b" << std::bitset<16>(supernova::config_value) << "\n"
+        "\tflags: 0b" << std::bitset<16>(supernova::config_flags()) << "\n"
         "\tpossible interrupt count: " << supernova::int_count << "\n"
         "======================================\n"
         "instruction group implementations:\n"
         "\tgroup 0: fully implemented\n"
         "\tgroup 1: fully implemented\n"
         "\tgroup 2: fully implemented\n"
-        "\tgroup 3: no i/o\n"
-        "\tgroup 4: not implemented\n"
-        "\tgroup 5: not implemented\n"
-        "\tgroup 6: not implemented\n"
+        "\tgroup 3: fully implemented, " << supernova::io_bus::default_port_count << " i/o ports\n"
+        "\t\tconsole on 0x" << std::hex << console_port << ", timer on 0x" << timer_port << ", disk on 0x" << disk_port << std::dec << "\n"
+        "\tgroup 4: fully implemented\n"
+        "\tgroup 5: fully implemented\n"
+        "\tgroup 6: fully implemented\n"
+        "\tgroup 7: fully implemented, " << supernova::host_vector_width() << " byte vectors\n"
         "==============================\n"
         "pcall -1:\n"
         "\t0:0 -> r31 = 2, r30 = 2^51 - 1\n"
         "\t0:1 implemented\n"
-        "\t1:0 -> r31 = 0 paging not yet implemented\n"
-        "\t2:0 -> r31 = 0 (will change shortly)\n";
+        "\t1:0 -> r14 = " << supernova::default_page_levels << " page levels, r13 = " << supernova::default_page_size << " byte pages\n"
+        "\t1:1 implemented, 1:2 and 1:3 flush the tlb\n"
+        "\t2:0 -> r14 = 1\n"
+        "\t2:1 -> r14 = flags, r13 = vector width\n"
+        "\t3:0 -> r14 = 1, r13 = " << supernova::default_hosted_functions().version << "\n"
+        "\t3:1 places the hosted ring, 3:2 submits to it, " << supernova::hosted_ring::default_workers << " host workers\n";
 }
 
 int main(int argc, char ** argv) {
@@ -55,14 +75,113 @@ int main(int argc, char ** argv) {
         return 0;
     }
 
-    auto file_info = supernova::headers::read_file(argv[1]);
+    auto use_jit = false;
+    auto use_guard = false;
+    auto mode = supernova::headers::LoadCopy;
+    auto use_stats = false;
+    auto stats_format = supernova::StatsTable;
+    char const *profile_name = nullptr;
+    char const *disk_name = nullptr;
+    auto use_fusion = true;
+    auto index = 1;
+    for (; index < argc; ++index) {
+        const auto option = std::string_view(argv[index]);
+        if (option == "-j" || option == "--jit") {
+            use_jit = true;
+        } else if (option == "-g" || option == "--guard-pages") {
+            use_guard = true;
+        } else if (option == "-m" || option == "--mapped") {
+            mode = supernova::headers::LoadMapped;
+        } else if (option == "-s" || option == "--stats") {
+            use_stats = true;
+        } else if (option == "--stats-json") {
+            use_stats = true;
+            stats_format = supernova::StatsJson;
+        } else if (option == "--no-fusion") {
+            use_fusion = false;
+        } else if (option == "--profile" && index + 1 < argc) {
+            profile_name = argv[++index];
+        } else if (option == "--disk" && index + 1 < argc) {
+            disk_name = argv[++index];
+        } else {
+            break;
+        }
+    }
+
+    if (index == argc) {
+        print_help();
+        return 1;
+    }
+    auto *filename = argv[index];
+
+    auto file_info = supernova::headers::read_file(filename, mode);
 
     if (file_info.status != supernova::headers::read_status::ReadOk) {
         std::cerr << "could run file, status code = " << static_cast<int>(file_info.status) << '\n';
         return file_info.status;
     }
 
-    auto thread = supernova::Thread(std::move(file_info.memory_pointer), file_info.memory_size, nullptr, file_info.entry_point);
+    auto model = supernova::thread_model_t{};
+    model.flags = supernova::config_flags();
+    model.interrupt_count = supernova::int_count;
+    model.page_level = supernova::default_page_levels;
+    model.page_size = supernova::default_page_size;
+
+    auto bus = supernova::io_bus{};
+    auto console = supernova::console_device{stdin, stdout};
+    auto timer = supernova::timer_device{};
+    bus.attach(console_port, console);
+    bus.attach(timer_port, timer);
+
+    auto disk = std::unique_ptr<supernova::block_device>{};
+    if (disk_name != nullptr) {
+        disk = std::make_unique<supernova::block_device>(disk_name);
+        if (disk->is_open()) {
+            bus.attach(disk_port, *disk);
+        } else {
+            std::cerr << "could not open disk " << disk_name << '\n';
+        }
+    }
+
+    auto thread = supernova::Thread(std::move(file_info.memory_pointer), file_info.memory_size, &model, file_info.entry_point);
+    thread.use_io(&bus);
+
+    // declared after the thread, requests in flight finish before its memory goes away
+    auto hosted = supernova::hosted_ring{};
+    thread.use_hosted(&hosted);
 
-    supernova::run(0, nullptr, thread);
+    thread.use_fusion(use_fusion);
+
+    if (use_guard && !thread.use_guard_pages()) {
+        std::cerr << "guard pages are not available, using checked memory\n";
+    }
+
+    if (use_stats && !supernova::stats_enabled) {
+        std::cerr << "counters are not built in, configure with -DSUPERNOVA_STATS=ON\n";
+        use_stats = false;
+    }
+
+    if (profile_name != nullptr) {
+        auto profile = supernova::profiler{};
+        profile.load_symbols(filename, file_info);
+        profile.run(thread);
+
+        auto output = std::ofstream(profile_name);
+        profile.write_folded(output);
+        if (!output) {
+            std::cerr << "could not write profile to " << profile_name << '\n';
+        }
+    } else if (use_jit) {
+        supernova::jit::run(0, nullptr, thread);
+    } else {
+        supernova::run(0, nullptr, thread);
+    }
+
+#ifdef SUPERNOVA_STATS
+    if (use_stats) {
+        supernova::write_stats(std::cerr, thread.stats(), stats_format);
+    }
+#else
+    static_cast<void>(stats_format);
+#endif
 }
\ No newline at end of file
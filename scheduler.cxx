@@ -0,0 +1,226 @@
+#include "supernova.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Thread = supernova::Thread;
+    using completion = supernova::scheduler::completion;
+
+    /**
+     * @brief a thread waiting to run
+     */
+    struct task
+    {
+        uint64_t id;                    /**< id given on submission */
+        std::unique_ptr<Thread> thread; /**< thread to run */
+    };
+
+    /**
+     * @brief deque owned by a worker, others only steal from it
+     */
+    struct work_deque
+    {
+        std::mutex lock{};         /**< taken for every access, runs are long enough for it to not matter */
+        std::deque<task> tasks{}; /**< runnable threads, the owner takes from the front */
+    };
+} // namespace
+
+namespace supernova
+{
+    struct scheduler_state
+    {
+        uint64_t quantum;       /**< instructions run before preempting */
+        dispatch_engine engine; /**< engine used by every worker */
+
+        std::vector<work_deque> deques; /**< one per worker */
+        std::vector<std::thread> pool{}; /**< workers */
+
+        std::mutex idle_lock{};               /**< protects sleeping on `idle` */
+        std::condition_variable idle{};       /**< wakes workers up when threads arrive */
+        std::atomic<uint64_t> runnable{0};    /**< threads sitting on any deque */
+        std::atomic<bool> stopping{false};    /**< set when the scheduler goes away */
+        std::atomic<uint64_t> next_id{0};     /**< id of the next submission */
+        std::atomic<uint64_t> submitted{0};   /**< threads not yet taken out of `done` */
+
+        std::mutex done_lock{};               /**< protects `done` */
+        std::condition_variable finished{};   /**< signals new completions */
+        std::deque<completion> done{};        /**< completion queue */
+
+        scheduler_state(unsigned workers, uint64_t slice, dispatch_engine dispatch)
+            : quantum{slice}, engine{dispatch}, deques(workers)
+        {
+        }
+
+        /** take from the front of the own deque, or steal from the back of another one */
+        auto take(unsigned self, task &out) -> bool
+        {
+            {
+                auto &own = this->deques[self];
+                std::lock_guard guard{own.lock};
+                if (!own.tasks.empty())
+                {
+                    out = std::move(own.tasks.front());
+                    own.tasks.pop_front();
+                    return true;
+                }
+            }
+
+            const auto count = static_cast<unsigned>(this->deques.size());
+            for (unsigned offset = 1; offset < count; ++offset)
+            {
+                auto &victim = this->deques[(self + offset) % count];
+                std::lock_guard guard{victim.lock};
+                if (!victim.tasks.empty())
+                {
+                    out = std::move(victim.tasks.back());
+                    victim.tasks.pop_back();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /** queue a thread on the back of a deque, waking up someone to run or steal it */
+        void push(unsigned worker, task work)
+        {
+            {
+                auto &deque = this->deques[worker];
+                std::lock_guard guard{deque.lock};
+                deque.tasks.push_back(std::move(work));
+            }
+
+            this->runnable.fetch_add(1);
+            std::lock_guard guard{this->idle_lock};
+            this->idle.notify_one();
+        }
+
+        /** report a stopped thread on the completion queue */
+        void complete(task work, run_result const &ran)
+        {
+            const auto result = thread_return{ran.status == ProgramEnded, ran.exit_code};
+            {
+                std::lock_guard guard{this->done_lock};
+                this->done.push_back(completion{work.id, result, std::move(work.thread)});
+            }
+            this->finished.notify_one();
+        }
+
+        /** worker loop, runs until the scheduler stops */
+        void work(unsigned self)
+        {
+            task current{0, nullptr};
+
+            while (!this->stopping.load(std::memory_order_relaxed))
+            {
+                if (!this->take(self, current))
+                {
+                    std::unique_lock guard{this->idle_lock};
+                    this->idle.wait(guard, [this]() { return this->stopping.load() || this->runnable.load() != 0; });
+                    continue;
+                }
+
+                this->runnable.fetch_sub(1);
+
+                const auto ran = run_for(*current.thread, this->quantum, this->engine);
+                if (ran.status != BudgetExhausted)
+                {
+                    this->complete(std::move(current), ran);
+                    continue;
+                }
+
+                // preempted, goes behind everything else on this worker
+                this->push(self, std::move(current));
+            }
+        }
+    };
+
+    scheduler::scheduler(unsigned workers, uint64_t quantum, dispatch_engine engine)
+    {
+        if (workers == 0)
+        {
+            workers = std::max(1U, std::thread::hardware_concurrency());
+        }
+
+        this->m_state = std::make_unique<scheduler_state>(workers, quantum == 0 ? 1 : quantum, engine);
+        for (unsigned i = 0; i < workers; ++i)
+        {
+            this->m_state->pool.emplace_back([state = this->m_state.get(), i]() { state->work(i); });
+        }
+    }
+
+    scheduler::~scheduler()
+    {
+        {
+            std::lock_guard guard{this->m_state->idle_lock};
+            this->m_state->stopping = true;
+        }
+        this->m_state->idle.notify_all();
+
+        for (auto &worker : this->m_state->pool)
+        {
+            worker.join();
+        }
+    }
+
+    auto scheduler::submit(std::unique_ptr<Thread> thread) -> uint64_t
+    {
+        auto &state = *this->m_state;
+        const auto id = state.next_id.fetch_add(1);
+        state.submitted.fetch_add(1);
+
+        // spread submissions, stealing evens out whatever is left
+        state.push(static_cast<unsigned>(id % state.deques.size()), task{id, std::move(thread)});
+        return id;
+    }
+
+    auto scheduler::wait() -> completion
+    {
+        auto &state = *this->m_state;
+        std::unique_lock guard{state.done_lock};
+
+        state.finished.wait(guard, [&state]() { return !state.done.empty() || state.submitted.load() == 0; });
+
+        if (state.done.empty())
+        {
+            return completion{0, {false, 0}, nullptr};
+        }
+
+        auto done = std::move(state.done.front());
+        state.done.pop_front();
+        state.submitted.fetch_sub(1);
+        return done;
+    }
+
+    auto scheduler::try_wait(completion &done) -> bool
+    {
+        auto &state = *this->m_state;
+        std::lock_guard guard{state.done_lock};
+
+        if (state.done.empty())
+        {
+            return false;
+        }
+
+        done = std::move(state.done.front());
+        state.done.pop_front();
+        state.submitted.fetch_sub(1);
+        return true;
+    }
+
+    auto scheduler::pending() const noexcept -> uint64_t
+    {
+        return this->m_state->submitted.load();
+    }
+
+    auto scheduler::workers() const noexcept -> unsigned
+    {
+        return static_cast<unsigned>(this->m_state->pool.size());
+    }
+} // namespace supernova
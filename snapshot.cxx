@@ -0,0 +1,243 @@
+#include "supernova.h"
+#include <algorithm>
+#include <cstring>
+
+// memory files let every fork map the same pages copy-on-write
+#if defined(__linux__)
+#define SUPERNOVA_SHARED_SNAPSHOTS 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef SUPERNOVA_SHARED_SNAPSHOTS
+    [[nodiscard]] auto page_size() noexcept -> uint64_t
+    {
+        return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    /**
+     * @brief write memory into a sealed memory file
+     *
+     * memory goes at the end of the file, up to `guarded_size`, so mapping
+     * the file leaves it aligned right before the next page, same as guarded memory
+     *
+     * @param memory memory to save
+     * @param size memory size in bytes
+     * @param[out] length file length
+     *
+     * @return file descriptor, or -1 if the host refused
+     */
+    auto save_memory(uint8_t const *memory, uint64_t size, uint64_t &length) noexcept -> int
+    {
+        const auto page = page_size();
+        length = (supernova::guarded_size(size) + page - 1) & ~(page - 1);
+
+        const auto descriptor = memfd_create("supernova-snapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (descriptor < 0)
+        {
+            return -1;
+        }
+
+        if (ftruncate(descriptor, static_cast<off_t>(length)) != 0)
+        {
+            close(descriptor);
+            return -1;
+        }
+
+        auto *mapping = mmap(nullptr, length, PROT_WRITE, MAP_SHARED, descriptor, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(descriptor);
+            return -1;
+        }
+
+        std::memcpy(static_cast<uint8_t *>(mapping) + (length - supernova::guarded_size(size)), memory, size);
+        munmap(mapping, length);
+
+        // forks map it privately, nobody gets to change the original
+        fcntl(descriptor, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+        return descriptor;
+    }
+
+    /**
+     * @brief map a memory file privately, followed by an inaccessible page
+     *
+     * @param descriptor memory file
+     * @param size memory size in bytes
+     * @param length file length
+     *
+     * @return memory, or `nullptr` if the host refused
+     */
+    auto map_memory(int descriptor, uint64_t size, uint64_t length) noexcept -> std::unique_ptr<uint8_t[], supernova::memory_deleter>
+    {
+        const auto total = length + page_size();
+
+        auto *mapping = mmap(nullptr, total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        if (mmap(mapping, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, descriptor, 0) == MAP_FAILED)
+        {
+            munmap(mapping, total);
+            return nullptr;
+        }
+
+        auto *memory = static_cast<uint8_t *>(mapping) + (length - supernova::guarded_size(size));
+        return {memory, supernova::memory_deleter{mapping, total, true}};
+    }
+#endif
+} // namespace
+
+namespace supernova
+{
+    thread_snapshot::thread_snapshot(thread_snapshot &&other) noexcept
+        : m_registers{other.m_registers}, m_program_counter{other.m_program_counter}, m_int_vector{other.m_int_vector},
+          m_memory_size{other.m_memory_size}, m_model{other.m_model}, m_pcall{other.m_pcall}, m_signal{other.m_signal},
+          m_backend{other.m_backend}, m_paging{other.m_paging}, m_page_table{other.m_page_table},
+          m_io{other.m_io}, m_floats{other.m_floats}, m_vectors{other.m_vectors}, m_vector_width{other.m_vector_width}, m_descriptor{other.m_descriptor}, m_length{other.m_length}, m_copy{std::move(other.m_copy)}
+    {
+        other.m_descriptor = -1;
+    }
+
+    auto thread_snapshot::operator=(thread_snapshot &&other) noexcept -> thread_snapshot &
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+#ifdef SUPERNOVA_SHARED_SNAPSHOTS
+        if (this->m_descriptor >= 0)
+        {
+            close(this->m_descriptor);
+        }
+#endif
+        this->m_registers = other.m_registers;
+        this->m_program_counter = other.m_program_counter;
+        this->m_int_vector = other.m_int_vector;
+        this->m_memory_size = other.m_memory_size;
+        this->m_model = other.m_model;
+        this->m_pcall = other.m_pcall;
+        this->m_signal = other.m_signal;
+        this->m_backend = other.m_backend;
+        this->m_paging = other.m_paging;
+        this->m_page_table = other.m_page_table;
+        this->m_io = other.m_io;
+        this->m_floats = other.m_floats;
+        this->m_vectors = other.m_vectors;
+        this->m_vector_width = other.m_vector_width;
+        this->m_descriptor = other.m_descriptor;
+        this->m_length = other.m_length;
+        this->m_copy = std::move(other.m_copy);
+        other.m_descriptor = -1;
+        return *this;
+    }
+
+    thread_snapshot::~thread_snapshot()
+    {
+#ifdef SUPERNOVA_SHARED_SNAPSHOTS
+        if (this->m_descriptor >= 0)
+        {
+            close(this->m_descriptor);
+        }
+#endif
+    }
+
+    auto Thread::snapshot() const -> thread_snapshot
+    {
+        thread_snapshot result;
+        result.m_registers = this->m_registers;
+        result.m_program_counter = this->m_program_counter;
+        result.m_int_vector = this->m_int_vector;
+        result.m_memory_size = this->m_memory_size;
+        result.m_model = this->m_model;
+        result.m_pcall = this->m_pcall;
+        result.m_signal = this->m_signal;
+        result.m_backend = this->m_backend;
+        result.m_paging = this->m_paging;
+        result.m_page_table = this->m_page_table;
+        result.m_io = this->m_io;
+        result.m_floats = this->m_floats;
+        std::copy(this->m_vectors.get(), this->m_vectors.get() + vector_count, result.m_vectors.begin());
+        result.m_vector_width = this->m_vector_width;
+
+#ifdef SUPERNOVA_SHARED_SNAPSHOTS
+        if (this->m_memory_size != 0)
+        {
+            result.m_descriptor = save_memory(this->m_memory.get(), this->m_memory_size, result.m_length);
+            if (result.m_descriptor >= 0)
+            {
+                return result;
+            }
+        }
+#endif
+
+        result.m_copy = std::unique_ptr<uint8_t[]>(new uint8_t[this->m_memory_size]);
+        std::memcpy(result.m_copy.get(), this->m_memory.get(), this->m_memory_size);
+        return result;
+    }
+
+    auto Thread::fork_from(thread_snapshot const &snapshot) -> Thread
+    {
+        std::unique_ptr<uint8_t[], memory_deleter> memory{nullptr};
+
+#ifdef SUPERNOVA_SHARED_SNAPSHOTS
+        if (snapshot.m_descriptor >= 0)
+        {
+            memory = map_memory(snapshot.m_descriptor, snapshot.m_memory_size, snapshot.m_length);
+
+            // out of mappings, fall back to reading the file
+            if (memory == nullptr)
+            {
+                memory = std::unique_ptr<uint8_t[]>(new uint8_t[snapshot.m_memory_size]);
+                const auto position = static_cast<off_t>(snapshot.m_length - guarded_size(snapshot.m_memory_size));
+                for (uint64_t done = 0; done < snapshot.m_memory_size;)
+                {
+                    const auto got = pread(snapshot.m_descriptor, memory.get() + done, snapshot.m_memory_size - done, position + static_cast<off_t>(done));
+                    if (got <= 0)
+                    {
+                        break;
+                    }
+                    done += static_cast<uint64_t>(got);
+                }
+            }
+        }
+#endif
+
+        if (memory == nullptr)
+        {
+            memory = std::unique_ptr<uint8_t[]>(new uint8_t[snapshot.m_memory_size]);
+            if (snapshot.m_copy != nullptr)
+            {
+                std::memcpy(memory.get(), snapshot.m_copy.get(), snapshot.m_memory_size);
+            }
+        }
+
+        auto thread = Thread{std::move(memory), snapshot.m_memory_size, snapshot.m_model, snapshot.m_program_counter};
+        thread.m_registers = snapshot.m_registers;
+        thread.m_int_vector = snapshot.m_int_vector;
+        thread.m_pcall = snapshot.m_pcall;
+        thread.m_signal = snapshot.m_signal;
+        thread.m_io = snapshot.m_io;
+        thread.m_floats = snapshot.m_floats;
+        std::copy(snapshot.m_vectors.begin(), snapshot.m_vectors.end(), thread.m_vectors.get());
+        static_cast<void>(thread.use_vector_width(snapshot.m_vector_width));
+
+        if (snapshot.m_backend == GuardedMemory)
+        {
+            static_cast<void>(thread.use_guard_pages());
+        }
+
+        if (snapshot.m_paging)
+        {
+            static_cast<void>(thread.enable_paging(snapshot.m_page_table));
+        }
+
+        return thread;
+    }
+} // namespace supernova
@@ -0,0 +1,237 @@
+#include "supernova.h"
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Opcodes = supernova::inspx;
+    using execution_stats = supernova::execution_stats;
+
+/** every opcode with a name, the `_instrc` suffix gets dropped when printing */
+#define SUPERNOVA_NAMED_OPCODES(X)                                                                    \
+    X(andr_instrc) X(andi_instrc) X(xorr_instrc) X(xori_instrc) X(orr_instrc) X(ori_instrc)           \
+    X(not_instrc) X(cnt_instrc) X(llsr_instrc) X(llsi_instrc) X(lrsr_instrc) X(lrsi_instrc)           \
+    X(addr_instrc) X(addi_instrc) X(subr_instrc) X(subi_instrc) X(umulr_instrc) X(umuli_instrc)       \
+    X(smulr_instrc) X(smuli_instrc) X(udivr_instrc) X(udivi_instrc) X(sdivr_instrc) X(sdivi_instrc)   \
+    X(call_instrc) X(push_instrc) X(retn_instrc) X(pull_instrc)                                       \
+    X(ld_byte_instrc) X(ld_half_instrc) X(ld_word_instrc) X(ld_dwrd_instrc)                           \
+    X(st_byte_instrc) X(st_half_instrc) X(st_word_instrc) X(st_dwrd_instrc)                           \
+    X(jal_instrc) X(jalr_instrc) X(je_instrc) X(jne_instrc)                                           \
+    X(jgu_instrc) X(jgs_instrc) X(jleu_instrc) X(jles_instrc)                                         \
+    X(setgur_instrc) X(setgui_instrc) X(setgsr_instrc) X(setgsi_instrc)                               \
+    X(setleur_instrc) X(setleui_instrc) X(setlesr_instrc) X(setlesi_instrc)                           \
+    X(lui_instrc) X(auipc_instrc) X(pcall_instrc)                                                     \
+    X(bout_instrc) X(out_instrc) X(bin_instrc) X(in_instrc)                                           \
+    X(flt_ldu_instrc) X(flt_lds_instrc) X(flt_stu_instrc) X(flt_sts_instrc)                           \
+    X(flt_add_instrc) X(flt_sub_instrc) X(flt_mul_instrc) X(flt_div_instrc)                           \
+    X(flt_ceq_instrc) X(flt_cne_instrc) X(flt_cgt_instrc) X(flt_cle_instrc)                           \
+    X(flt_rou_instrc) X(flt_flr_instrc) X(flt_cei_instrc) X(flt_trn_instrc)                           \
+    X(cmovz_instrc) X(cmovnz_instrc) X(cmovgs_instrc) X(cmovles_instrc)                               \
+    X(cmovzi_instrc) X(cmovnzi_instrc)                                                                \
+    X(ld_acq_instrc) X(st_rel_instrc) X(cas_instrc) X(xchg_instrc) X(xadd_instrc)                     \
+    X(fence_acq_instrc) X(fence_rel_instrc) X(fence_acr_instrc) X(fence_seq_instrc)                   \
+    X(vld_instrc) X(vst_instrc) X(vadd_instrc) X(vsub_instrc) X(vmul_instrc) X(vand_instrc)           \
+    X(vor_instrc) X(vxor_instrc) X(vceq_instrc) X(vcgtu_instrc) X(vcgts_instrc)                       \
+    X(vbrd_instrc) X(vext_instrc)
+
+    /**
+     * @brief get a printable name for an opcode
+     *
+     * @param opcode opcode to name
+     *
+     * @return name of the opcode, or its value in hex when it has none
+     */
+    auto opcode_name(unsigned opcode) -> std::string
+    {
+        switch (opcode)
+        {
+#define SUPERNOVA_NAME(opc)                                                      \
+    case Opcodes::opc:                                                           \
+        return std::string(#opc, sizeof(#opc) - sizeof("_instrc"));
+            SUPERNOVA_NAMED_OPCODES(SUPERNOVA_NAME)
+#undef SUPERNOVA_NAME
+        default:
+            break;
+        }
+
+        constexpr auto digits = "0123456789abcdef";
+        return std::string{"0x"} + digits[(opcode >> 4U) & 0xFU] + digits[opcode & 0xFU];
+    }
+
+    /** names of the conditional jumps, same order as `execution_stats::taken` */
+    constexpr std::array<char const *, execution_stats::branch_count> branch_names{
+        "je", "jne", "jgu", "jgs", "jleu", "jles",
+    };
+
+    /** names of the access widths, same order as `execution_stats::loads` */
+    constexpr std::array<char const *, execution_stats::width_count> width_names{
+        "byte", "half", "word", "dwrd",
+    };
+
+    /** names of the processor calls `ProcessorCall` has, same order as `execution_stats::pcalls` */
+    constexpr std::array<char const *, supernova::ProcessorCall::NormalExecution + 1> pcall_names{
+        "Functions", "DivisionByZero", "Halt", "GeneralFault", "DoubleFault",
+        "TripleFault", "InvalidInstruction", "PageFault", "MemoryLimit", "UnalignedAccess",
+    };
+
+    static_assert(execution_stats::pcall_count == 1 + supernova::Thread::vector_cache_size, "every cached handler gets a counter");
+
+    /** name of a processor call counter, the ones past `ProcessorCall` go by number */
+    auto pcall_name(std::size_t index) -> std::string
+    {
+        return index < pcall_names.size() ? pcall_names[index] : "pcall " + std::to_string(index - 1);
+    }
+
+    /** names of superinstructions, same order as `execution_stats::fused` */
+    constexpr std::array<char const *, execution_stats::fusion_count> fusion_names{
+        "lui+ori", "lui+addi", "ori+lui", "setgur+je", "setgur+jne", "setleur+je", "setleur+jne",
+        "setleui+je", "setleui+jne", "push+push", "push+call", "pull+pull", "pull+push", "ld_dwrd+addi",
+    };
+
+    /**
+     * @brief opcodes that ran at least once, most executed first
+     */
+    auto ran_opcodes(execution_stats const &stats) -> std::vector<unsigned>
+    {
+        std::vector<unsigned> ran;
+        for (unsigned opcode = 0; opcode < stats.opcodes.size(); ++opcode)
+        {
+            if (stats.opcodes[opcode] != 0)
+            {
+                ran.push_back(opcode);
+            }
+        }
+
+        std::stable_sort(ran.begin(), ran.end(), [&stats](auto left, auto right) { return stats.opcodes[left] > stats.opcodes[right]; });
+        return ran;
+    }
+
+    void write_table(std::ostream &output, execution_stats const &stats)
+    {
+        uint64_t total = 0;
+        for (auto count : stats.opcodes)
+        {
+            total += count;
+        }
+
+        output << std::left << std::setw(12) << "opcode" << std::right << std::setw(16) << "executed" << std::setw(10) << "share" << '\n';
+        for (auto opcode : ran_opcodes(stats))
+        {
+            const auto share = 100.0 * static_cast<double>(stats.opcodes[opcode]) / static_cast<double>(total);
+            output << std::left << std::setw(12) << opcode_name(opcode) << std::right << std::setw(16) << stats.opcodes[opcode]
+                   << std::setw(9) << std::fixed << std::setprecision(2) << share << "%\n";
+        }
+        output << std::left << std::setw(12) << "total" << std::right << std::setw(16) << total << "\n\n";
+
+        output << std::left << std::setw(12) << "branch" << std::right << std::setw(16) << "taken" << std::setw(16) << "not taken" << '\n';
+        for (auto i = 0; i < execution_stats::branch_count; ++i)
+        {
+            if (stats.taken[i] != 0 || stats.not_taken[i] != 0)
+            {
+                output << std::left << std::setw(12) << branch_names[i] << std::right << std::setw(16) << stats.taken[i]
+                       << std::setw(16) << stats.not_taken[i] << '\n';
+            }
+        }
+
+        output << '\n' << std::left << std::setw(12) << "width" << std::right << std::setw(16) << "loads" << std::setw(16) << "stores" << '\n';
+        for (auto i = 0; i < execution_stats::width_count; ++i)
+        {
+            if (stats.loads[i] != 0 || stats.stores[i] != 0)
+            {
+                output << std::left << std::setw(12) << width_names[i] << std::right << std::setw(16) << stats.loads[i]
+                       << std::setw(16) << stats.stores[i] << '\n';
+            }
+        }
+
+        output << '\n' << std::left << std::setw(20) << "processor call" << std::right << std::setw(8) << "count" << '\n';
+        for (auto i = 0; i < execution_stats::pcall_count; ++i)
+        {
+            if (stats.pcalls[i] != 0)
+            {
+                output << std::left << std::setw(20) << pcall_name(i) << std::right << std::setw(8) << stats.pcalls[i] << '\n';
+            }
+        }
+
+        output << '\n' << std::left << std::setw(20) << "superinstruction" << std::right << std::setw(8) << "count" << '\n';
+        for (auto i = 0; i < execution_stats::fusion_count; ++i)
+        {
+            if (stats.fused[i] != 0)
+            {
+                output << std::left << std::setw(20) << fusion_names[i] << std::right << std::setw(8) << stats.fused[i] << '\n';
+            }
+        }
+    }
+
+    void write_json(std::ostream &output, execution_stats const &stats)
+    {
+        auto separator = "";
+
+        output << "{\"opcodes\":{";
+        for (auto opcode : ran_opcodes(stats))
+        {
+            output << separator << '"' << opcode_name(opcode) << "\":" << stats.opcodes[opcode];
+            separator = ",";
+        }
+
+        output << "},\"branches\":{";
+        separator = "";
+        for (auto i = 0; i < execution_stats::branch_count; ++i)
+        {
+            if (stats.taken[i] != 0 || stats.not_taken[i] != 0)
+            {
+                output << separator << '"' << branch_names[i] << "\":{\"taken\":" << stats.taken[i] << ",\"not_taken\":" << stats.not_taken[i] << '}';
+                separator = ",";
+            }
+        }
+
+        output << "},\"memory\":{";
+        separator = "";
+        for (auto i = 0; i < execution_stats::width_count; ++i)
+        {
+            if (stats.loads[i] != 0 || stats.stores[i] != 0)
+            {
+                output << separator << '"' << width_names[i] << "\":{\"loads\":" << stats.loads[i] << ",\"stores\":" << stats.stores[i] << '}';
+                separator = ",";
+            }
+        }
+
+        output << "},\"pcalls\":{";
+        separator = "";
+        for (auto i = 0; i < execution_stats::pcall_count; ++i)
+        {
+            if (stats.pcalls[i] != 0)
+            {
+                output << separator << '"' << pcall_name(i) << "\":" << stats.pcalls[i];
+                separator = ",";
+            }
+        }
+
+        output << "},\"fused\":{";
+        separator = "";
+        for (auto i = 0; i < execution_stats::fusion_count; ++i)
+        {
+            if (stats.fused[i] != 0)
+            {
+                output << separator << '"' << fusion_names[i] << "\":" << stats.fused[i];
+                separator = ",";
+            }
+        }
+        output << "}}\n";
+    }
+} // namespace
+
+namespace supernova
+{
+    void write_stats(std::ostream &output, execution_stats const &stats, stats_format format)
+    {
+        if (format == StatsJson)
+        {
+            write_json(output, stats);
+            return;
+        }
+        write_table(output, stats);
+    }
+} // namespace supernova
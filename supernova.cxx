@@ -1,5 +1,56 @@
 #include "supernova.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <functional>
+#include <initializer_list>
+#include <limits>
+#include <new>
+#include <utility>
+
+// hosts with virtual memory are able to catch accesses to guard pages
+#if defined(__unix__) || defined(__APPLE__)
+#define SUPERNOVA_GUARD_PAGES 1
+#include <csetjmp>
+#include <csignal>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// gcc and clang accept labels as values
+#if defined(__GNUC__)
+#define SUPERNOVA_COMPUTED_GOTO 1
+#endif
+
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::musttail)
+#define SUPERNOVA_MUSTTAIL [[clang::musttail]]
+#endif
+#endif
+
+// cmake picks the engine, falling back to whatever the compiler is able to do
+#if defined(SUPERNOVA_DISPATCH_SWITCH)
+#define SUPERNOVA_DEFAULT_DISPATCH SwitchDispatch
+#elif defined(SUPERNOVA_DISPATCH_TAILCALL)
+#define SUPERNOVA_DEFAULT_DISPATCH TailCallDispatch
+#elif defined(SUPERNOVA_DISPATCH_BLOCK)
+#define SUPERNOVA_DEFAULT_DISPATCH BlockDispatch
+#elif defined(SUPERNOVA_COMPUTED_GOTO)
+#define SUPERNOVA_DEFAULT_DISPATCH GotoDispatch
+#elif defined(SUPERNOVA_MUSTTAIL)
+#define SUPERNOVA_DEFAULT_DISPATCH TailCallDispatch
+#else
+#define SUPERNOVA_DEFAULT_DISPATCH SwitchDispatch
+#endif
+
+// counters cost nothing unless cmake turns them on
+#ifdef SUPERNOVA_STATS
+#define SUPERNOVA_COUNT(thread, counter) ++(thread).stats().counter
+#else
+#define SUPERNOVA_COUNT(thread, counter) static_cast<void>(0)
+#endif
 
 namespace
 {
@@ -9,15 +60,75 @@ namespace
     using RInstr = supernova::RInstruction;
     using SInstr = supernova::SInstruction;
     using LInstr = supernova::LInstruction;
+    using decoded_instruction = supernova::decoded_instruction;
     using Opcodes = supernova::inspx;
     using thread_return = supernova::thread_return;
+    using memory_backend = supernova::memory_backend;
 
     constexpr void dispatch_pcall(Thread &thread, ProcessorCall pcall) noexcept;
 
-    template <typename integer>
+    /**
+     * @brief raise a page fault for an address
+     * @param thread thread doing the access
+     * @param address virtual address that could not be translated
+     */
+    [[gnu::noinline, gnu::cold]] void page_fault(Thread &thread, uint64_t address) noexcept
+    {
+        thread.registers(Thread::pcall_pfaddr) = address;
+        dispatch_pcall(thread, ProcessorCall::PageFault);
+    }
+
+    /**
+     * @brief translate an access through the thread page tables
+     *
+     * accesses crossing into another page are refused, naturally aligned
+     * ones never do
+     *
+     * @param thread thread doing the access, with paging on
+     * @param address virtual address
+     * @param size amount of bytes accessed
+     * @param access `page_access` bits the access needs
+     *
+     * @return address on thread memory, or `Thread::untranslated` after raising a processor call
+     */
+    [[gnu::always_inline]] inline auto translate(Thread &thread, uint64_t address, uint64_t size, uint8_t access) noexcept -> uint64_t
+    {
+        if ((address & (thread.page_size() - 1)) + size > thread.page_size())
+        {
+            dispatch_pcall(thread, ProcessorCall::UnalignedAccess);
+            return Thread::untranslated;
+        }
+
+        const auto physical = thread.translate(address, access);
+        if (physical == Thread::untranslated)
+        {
+            page_fault(thread, address);
+        }
+        return physical;
+    }
+
+    template <typename integer, memory_backend backend = supernova::CheckedMemory>
     [[nodiscard]] constexpr auto fetch(Thread &thread, uint64_t address) noexcept -> integer
     {
-        if (address >= thread.memsize())
+        if (thread.paging())
+        {
+            address = translate(thread, address, sizeof(integer), supernova::PageRead);
+            if (address == Thread::untranslated)
+            {
+                return 0;
+            }
+        }
+
+        if constexpr (backend == supernova::GuardedMemory)
+        {
+            // anything past the end, or crossing it, lands on the guard pages
+            const auto inside = address < thread.memsize() && thread.memsize() - address >= sizeof(integer);
+            const auto offset = inside ? address : supernova::guarded_size(thread.memsize());
+            // NOLINTNEXTLINE: same as below
+            return *reinterpret_cast<integer *>(thread.memory().get() + offset);
+        }
+
+        if (address >= thread.memsize() || thread.memsize() - address < sizeof(integer))
         {
             dispatch_pcall(thread, ProcessorCall::MemoryLimit);
             return 0;
@@ -26,16 +137,167 @@ namespace
         return *reinterpret_cast<integer *>(thread.memory().get() + address);
     }
 
-    template <typename integer>
+    template <typename integer, memory_backend backend = supernova::CheckedMemory>
     constexpr auto place(Thread &thread, uint64_t address, integer value) noexcept -> void
     {
-        if (address >= thread.memsize())
+        auto physical = address;
+        if (thread.paging())
+        {
+            physical = translate(thread, address, sizeof(integer), supernova::PageWrite);
+            if (physical == Thread::untranslated)
+            {
+                return;
+            }
+        }
+
+        if constexpr (backend == supernova::GuardedMemory)
+        {
+            const auto inside = physical < thread.memsize() && thread.memsize() - physical >= sizeof(integer);
+            physical = inside ? physical : supernova::guarded_size(thread.memsize());
+        }
+        else if (physical >= thread.memsize() || thread.memsize() - physical < sizeof(integer))
         {
             dispatch_pcall(thread, ProcessorCall::MemoryLimit);
             return;
         }
         // NOLINTNEXTLINE: looks good to me tho
-        *reinterpret_cast<integer *>(thread.memory().get() + address) = value;
+        *reinterpret_cast<integer *>(thread.memory().get() + physical) = value;
+
+        // code that writes over itself needs to see the new instructions, instructions
+        // are cached by the address they were fetched from, translated code by where it lives
+        thread.invalidate_decoded(address, sizeof(integer));
+        thread.invalidate_code(physical, sizeof(integer));
+    }
+
+    /**
+     * @brief get the double word used by an atomic instruction
+     *
+     * bounds are checked on every backend, the host also needs the word to be
+     * naturally aligned to access it atomically
+     *
+     * @param thread thread doing the access
+     * @param address address of the double word
+     * @param access `page_access` bits the access needs while paging is on
+     *
+     * @return pointer to the double word, or `nullptr` after raising a processor call
+     */
+    auto atomic_word(Thread &thread, uint64_t address, uint8_t access) noexcept -> uint64_t *
+    {
+        if (thread.paging())
+        {
+            address = translate(thread, address, sizeof(uint64_t), access);
+            if (address == Thread::untranslated)
+            {
+                return nullptr;
+            }
+        }
+
+        if (address >= thread.memsize() || thread.memsize() - address < sizeof(uint64_t))
+        {
+            dispatch_pcall(thread, ProcessorCall::MemoryLimit);
+            return nullptr;
+        }
+
+        // memory starts on a double word, see `guarded_size`
+        if (address % sizeof(uint64_t) != 0)
+        {
+            dispatch_pcall(thread, ProcessorCall::UnalignedAccess);
+            return nullptr;
+        }
+
+        // NOLINTNEXTLINE: alignment was just checked
+        return reinterpret_cast<uint64_t *>(thread.memory().get() + address);
+    }
+
+    /**
+     * @brief drop whatever was cached for a double word an atomic instruction wrote to
+     * @param thread thread doing the access
+     * @param address address the guest used
+     * @param word double word, from `atomic_word`
+     */
+    void atomic_written(Thread &thread, uint64_t address, uint64_t const *word) noexcept
+    {
+        thread.invalidate_decoded(address, sizeof(uint64_t));
+        thread.invalidate_code(static_cast<uint64_t>(reinterpret_cast<uint8_t const *>(word) - thread.memory().get()), sizeof(uint64_t));
+    }
+
+    /**
+     * @brief get the bytes a vector load or store works on
+     *
+     * bounds are checked on every backend, a whole vector may reach further
+     * past the end of memory than the guard pages do
+     *
+     * @param thread thread doing the access
+     * @param address address of the first lane
+     * @param access `page_access` bits the access needs while paging is on
+     *
+     * @return pointer to `thread.vector_width()` bytes, or `nullptr` after raising a processor call
+     */
+    auto vector_memory(Thread &thread, uint64_t address, uint8_t access) noexcept -> uint8_t *
+    {
+        const auto width = thread.vector_width();
+        if (thread.paging())
+        {
+            address = translate(thread, address, width, access);
+            if (address == Thread::untranslated)
+            {
+                return nullptr;
+            }
+        }
+
+        if (address >= thread.memsize() || thread.memsize() - address < width)
+        {
+            dispatch_pcall(thread, ProcessorCall::MemoryLimit);
+            return nullptr;
+        }
+        return thread.memory().get() + address;
+    }
+
+    /**
+     * @brief get the bus an i/o instruction goes through
+     *
+     * @param thread thread running the instruction
+     * @param opcode opcode of the instruction, reported if the thread has no bus
+     *
+     * @return bus, or `nullptr` after raising an invalid instruction
+     */
+    auto io_bus_of(Thread &thread, Opcodes opcode) noexcept -> supernova::io_bus const *
+    {
+        auto const *bus = thread.io();
+        if (bus == nullptr)
+        {
+            thread.registers(supernova::Thread::pcall_invopc) = opcode;
+            dispatch_pcall(thread, ProcessorCall::InvalidInstruction);
+        }
+        return bus;
+    }
+
+    /**
+     * @brief convert a float register into an integer, the way `fstu` and `fsts` do
+     *
+     * truncates towards zero, out of range values saturate and NaN turns into 0
+     *
+     * @tparam integer integer type to convert to
+     * @param value float register value
+     *
+     * @return converted value
+     */
+    template <typename integer>
+    [[nodiscard, gnu::const]] auto float_to(double value) noexcept -> integer
+    {
+        if (std::isnan(value))
+        {
+            return 0;
+        }
+        if (value <= static_cast<double>(std::numeric_limits<integer>::min()))
+        {
+            return std::numeric_limits<integer>::min();
+        }
+        if (value >= static_cast<double>(std::numeric_limits<integer>::max()))
+        {
+            return std::numeric_limits<integer>::max();
+        }
+        return static_cast<integer>(value);
     }
 
     void hwpush64(Thread &thread, uint64_t value) noexcept
@@ -44,6 +306,36 @@ namespace
         thread.registers(1) -= sizeof(uint64_t);
     }
 
+    /**
+     * @brief push the program counter, r1 and r2 before entering a guest handler
+     *
+     * stacks well inside memory take a single bounds check, the rest push
+     * one double word at a time to fault on the right one
+     *
+     * @param thread thread entering the handler
+     */
+    void push_state(Thread &thread) noexcept
+    {
+        constexpr auto frame = 3 * sizeof(uint64_t);
+        const auto stack = thread.registers(1);
+        if (thread.paging() || stack < frame - sizeof(uint64_t) || stack >= thread.memsize() ||
+            thread.memsize() - stack < sizeof(uint64_t))
+        {
+            hwpush64(thread, thread.progc());
+            hwpush64(thread, thread.registers(1));
+            hwpush64(thread, thread.registers(2));
+            return;
+        }
+
+        // the same words the pushes write, r1 goes in already moved past the program counter
+        const auto bottom = stack - (frame - sizeof(uint64_t));
+        const uint64_t words[] = {thread.registers(2), stack - sizeof(uint64_t), thread.progc()};
+        std::memcpy(thread.memory().get() + bottom, words, frame);
+        thread.registers(1) = stack - frame;
+        thread.invalidate_decoded(bottom, frame);
+        thread.invalidate_code(bottom, frame);
+    }
+
     // static uint64_t hwpop64(register Thread *thread)
     // {
     //     uint64_t val = fetch(64, thread, thread->registers[1]);
@@ -63,8 +355,55 @@ namespace
             thread.intvec() = thread.registers(Thread::pcall_1stret);
             break;
         case 0x0000000100000000:
-            thread.registers(Thread::pcall_1stret) = 0;
+            thread.registers(Thread::pcall_1stret) = thread.page_levels();
+            thread.registers(Thread::pcall_2ndret) = thread.page_size();
+            break;
+        case 0x0000000100000001:
+            if (thread.registers(Thread::pcall_2ndret) == 0)
+            {
+                thread.disable_paging();
+            }
+            else if (!thread.enable_paging(thread.registers(Thread::pcall_1stret)))
+            {
+                dispatch_pcall(thread, ProcessorCall::GeneralFault);
+            }
+            break;
+        case 0x0000000100000002:
+            thread.flush_tlb();
+            break;
+        case 0x0000000100000003:
+            thread.flush_tlb(thread.registers(Thread::pcall_1stret));
+            break;
+        case 0x0000000200000000:
+            thread.registers(Thread::pcall_1stret) = 1;
             break;
+        case 0x0000000200000001:
+            thread.registers(Thread::pcall_1stret) = supernova::config_flags(thread.vector_width());
+            thread.registers(Thread::pcall_2ndret) = thread.vector_width();
+            break;
+        case 0x0000000300000000:
+            thread.registers(Thread::pcall_1stret) = thread.hosted() != nullptr ? 1 : 0;
+            thread.registers(Thread::pcall_2ndret) = thread.hosted() != nullptr ? thread.hosted()->functions().version : 0;
+            break;
+        case 0x0000000300000001:
+            if (thread.hosted() == nullptr ||
+                !thread.hosted()->setup(thread, thread.registers(Thread::pcall_1stret), thread.registers(Thread::pcall_2ndret)))
+            {
+                dispatch_pcall(thread, ProcessorCall::GeneralFault);
+            }
+            break;
+        case 0x0000000300000002:
+        {
+            const auto submitted =
+                thread.hosted() != nullptr ? thread.hosted()->enter(thread, thread.registers(Thread::pcall_1stret)) : supernova::hosted_ring::failed;
+            if (submitted == supernova::hosted_ring::failed)
+            {
+                dispatch_pcall(thread, ProcessorCall::GeneralFault);
+                break;
+            }
+            thread.registers(Thread::pcall_1stret) = submitted;
+            break;
+        }
 
         default:
             break;
@@ -73,12 +412,36 @@ namespace
 
     constexpr void dispatch_pcall(Thread &thread, ProcessorCall pcall) noexcept
     {
+        if (pcall >= ProcessorCall::Functions)
+        {
+            SUPERNOVA_COUNT(thread, pcalls[pcall + 1]);
+        }
+
         if (pcall == ProcessorCall::Functions)
         {
             pcall_minus_one(thread);
             return;
         }
 
+        if (pcall == ProcessorCall::Halt)
+        {
+            thread.signal() = DestroyFor::ProgramEnd;
+            return;
+        }
+
+        // a thread on its way out takes no more processor calls, this also
+        // stops faults while pushing the processor state from recursing forever
+        if (thread.signal() != DestroyFor::DoNotDestroy)
+        {
+            return;
+        }
+
+        if (auto const *native = thread.bound_pcall(pcall))
+        {
+            native->handler(thread, native->context);
+            return;
+        }
+
         if (thread.pcall() == ProcessorCall::DoubleFault)
         {
             thread.pcall() = ProcessorCall::TripleFault;
@@ -93,138 +456,386 @@ namespace
             thread.pcall() = pcall;
         }
 
-        hwpush64(thread, thread.progc());
+        push_state(thread);
 
-        hwpush64(thread, thread.registers(1));
-        hwpush64(thread, thread.registers(2));
-        
-        thread.progc() = fetch<uint64_t>(thread, thread.intvec() + pcall * sizeof(uint64_t));
+        if (pcall >= 0)
+        {
+            const auto cached = thread.cached_handler(pcall);
+            if (cached != Thread::untranslated)
+            {
+                thread.progc() = cached;
+                return;
+            }
+        }
+
+        const auto handler = fetch<uint64_t>(thread, thread.intvec() + pcall * sizeof(uint64_t));
+        thread.progc() = handler;
+
+        // fetches that faulted escalated the processor call, their result is no handler
+        if (pcall >= 0 && thread.pcall() == pcall && thread.signal() == DestroyFor::DoNotDestroy)
+        {
+            thread.cache_handler(pcall, handler);
+        }
     }
 
-    void exec_instruction(Thread &thread)
+/**
+ * pairs of instructions the decoded cache fuses into a single superinstruction,
+ * picked from the sequences compilers emit the most: constants, compare and
+ * branch, stack traffic around calls and pointer walks
+ *
+ * `write_stats` names them in this same order
+ */
+#define SUPERNOVA_FUSIONS(X)                                                                          \
+    X(lui_ori, lui_instrc, ori_instrc) X(lui_addi, lui_instrc, addi_instrc)                           \
+    X(ori_lui, ori_instrc, lui_instrc)                                                                \
+    X(setgur_je, setgur_instrc, je_instrc) X(setgur_jne, setgur_instrc, jne_instrc)                   \
+    X(setleur_je, setleur_instrc, je_instrc) X(setleur_jne, setleur_instrc, jne_instrc)               \
+    X(setleui_je, setleui_instrc, je_instrc) X(setleui_jne, setleui_instrc, jne_instrc)               \
+    X(push_push, push_instrc, push_instrc) X(push_call, push_instrc, call_instrc)                     \
+    X(pull_pull, pull_instrc, pull_instrc) X(pull_push, pull_instrc, push_instrc)                     \
+    X(ld_dwrd_addi, ld_dwrd_instrc, addi_instrc)
+
+    /**
+     * @brief superinstructions, indexes into `execution_stats::fused`
+     */
+    enum fusion : uint8_t
     {
-        uint64_t instruction{0UL};
-        if (thread.signal() != DestroyFor::DoNotDestroy)
+#define SUPERNOVA_FUSION_ID(name, first, second) fused_##name,
+        SUPERNOVA_FUSIONS(SUPERNOVA_FUSION_ID)
+#undef SUPERNOVA_FUSION_ID
+        fusion_count
+    };
+
+    static_assert(fusion_count == supernova::execution_stats::fusion_count, "fusions and their counters went out of sync");
+
+    /** opcode cached for the first superinstruction, past every opcode the instruction set may use */
+    constexpr uint8_t fused_base = 0xC0;
+
+    /**
+     * @brief get the opcode a superinstruction is cached as
+     * @param pair superinstruction
+     * @return opcode stored on the decoded cache
+     */
+    constexpr auto fused_opcode(fusion pair) noexcept -> Opcodes
+    {
+        return static_cast<Opcodes>(fused_base + pair);
+    }
+
+    /**
+     * @brief find the superinstruction running two instructions
+     *
+     * @param first opcode of the first instruction
+     * @param second opcode of the instruction right after it
+     *
+     * @return superinstruction, `fusion_count` if the pair is not fused
+     */
+    constexpr auto fusion_of(Opcodes first, Opcodes second) noexcept -> fusion
+    {
+#define SUPERNOVA_FUSION_MATCH(name, one, two)                 \
+    if (first == Opcodes::one && second == Opcodes::two)        \
+    {                                                           \
+        return fused_##name;                                    \
+    }
+        SUPERNOVA_FUSIONS(SUPERNOVA_FUSION_MATCH)
+#undef SUPERNOVA_FUSION_MATCH
+        return fusion_count;
+    }
+
+    /**
+     * @brief turn a freshly decoded entry into a superinstruction if the next instruction pairs with it
+     *
+     * the next instruction gets decoded into its own entry, superinstructions
+     * only run both halves while that entry is still cached, writes to the
+     * second half drop the first one too (see `Thread::invalidate_decoded`)
+     *
+     * @param thread thread the entry belongs to
+     * @param entry entry to fuse
+     * @param physical address of the entry on thread memory
+     */
+    void fuse(Thread &thread, decoded_instruction &entry, uint64_t physical) noexcept
+    {
+        const auto address = entry.address + sizeof(uint64_t);
+        physical += sizeof(uint64_t);
+
+        // the next page may map anywhere, pairs stay inside a single page
+        if (thread.paging() && ((address ^ entry.address) & ~(thread.page_size() - 1)) != 0)
         {
             return;
         }
 
-        instruction = fetch<uint64_t>(thread, thread.progc());
-        thread.progc() += sizeof(uint64_t);
+        if (physical >= thread.memsize() || thread.memsize() - physical < sizeof(uint64_t))
+        {
+            return;
+        }
+
+        // NOLINTNEXTLINE: bounds were checked above
+        const auto raw = *reinterpret_cast<uint64_t const *>(thread.memory().get() + physical);
+        const auto pair = fusion_of(entry.opcode, RInstr(raw).opcode());
+        if (pair == fusion_count)
+        {
+            return;
+        }
+
+        auto &next = thread.decoded(address);
+        if (next.address != address)
+        {
+            next = supernova::decode(raw, address);
+            thread.track_decoded(address);
+        }
+        thread.watch_decoded(physical, sizeof(uint64_t));
+        entry.opcode = fused_opcode(pair);
+    }
+
+    /**
+     * @brief decode the instruction on the program counter into the cache
+     *
+     * @param thread thread to fetch from
+     *
+     * @return pointer to the decoded instruction, or `nullptr` if it could not be fetched
+     */
+    [[gnu::noinline]] auto refill_decoded(Thread &thread) noexcept -> decoded_instruction const *
+    {
+        const auto address = thread.progc();
+        auto physical = address;
 
-        const auto rinstr = RInstr(instruction);
-        const auto sinstr = SInstr(instruction);
-        const auto linstr = LInstr(instruction);
+        if (thread.paging())
+        {
+            physical = translate(thread, address, sizeof(uint64_t), supernova::PageExecute);
+            if (physical == Thread::untranslated)
+            {
+                return nullptr;
+            }
+        }
+
+        if (physical >= thread.memsize() || thread.memsize() - physical < sizeof(uint64_t))
+        {
+            dispatch_pcall(thread, ProcessorCall::MemoryLimit);
+            return nullptr;
+        }
+
+        auto &entry = thread.decoded(address);
+        // NOLINTNEXTLINE: bounds were checked above
+        entry = supernova::decode(*reinterpret_cast<uint64_t const *>(thread.memory().get() + physical), address);
+        thread.track_decoded(address);
+        thread.watch_decoded(physical, sizeof(uint64_t));
+        if (thread.fusion())
+        {
+            fuse(thread, entry, physical);
+        }
+        return &entry;
+    }
+
+    /**
+     * @brief get the instruction on the program counter, decoding it only if needed
+     *
+     * @param thread thread to fetch from
+     *
+     * @return pointer to the decoded instruction, or `nullptr` if it could not be fetched
+     */
+    [[gnu::always_inline]] inline auto fetch_decoded(Thread &thread) noexcept -> decoded_instruction const *
+    {
+        const auto address = thread.progc();
+        auto const &entry = thread.decoded(address);
+
+        // entries were bounds checked when they got decoded
+        if (entry.address == address)
+        {
+            return &entry;
+        }
+
+        return refill_decoded(thread);
+    }
+
+    /**
+     * @brief check if an instruction is able to change the thread signal
+     *
+     * instructions that can not trigger a processor call do not need to have
+     * the signal checked after them
+     *
+     * @param opcode instruction opcode
+     *
+     * @return true if the instruction can trigger a processor call
+     */
+    [[nodiscard, gnu::const]] constexpr auto may_signal(Opcodes opcode) noexcept -> bool
+    {
+        switch (opcode)
+        {
+        case Opcodes::andr_instrc: case Opcodes::andi_instrc: case Opcodes::xorr_instrc: case Opcodes::xori_instrc:
+        case Opcodes::orr_instrc: case Opcodes::ori_instrc: case Opcodes::not_instrc: case Opcodes::cnt_instrc:
+        case Opcodes::llsr_instrc: case Opcodes::llsi_instrc: case Opcodes::lrsr_instrc: case Opcodes::lrsi_instrc:
+        case Opcodes::addr_instrc: case Opcodes::addi_instrc: case Opcodes::subr_instrc: case Opcodes::subi_instrc:
+        case Opcodes::umulr_instrc: case Opcodes::umuli_instrc: case Opcodes::smulr_instrc: case Opcodes::smuli_instrc:
+        case Opcodes::jal_instrc: case Opcodes::jalr_instrc: case Opcodes::je_instrc: case Opcodes::jne_instrc:
+        case Opcodes::jgu_instrc: case Opcodes::jgs_instrc: case Opcodes::jleu_instrc: case Opcodes::jles_instrc:
+        case Opcodes::setgur_instrc: case Opcodes::setgui_instrc: case Opcodes::setgsr_instrc: case Opcodes::setgsi_instrc:
+        case Opcodes::setleur_instrc: case Opcodes::setleui_instrc: case Opcodes::setlesr_instrc: case Opcodes::setlesi_instrc:
+        case Opcodes::lui_instrc: case Opcodes::auipc_instrc:
+        case Opcodes::flt_ldu_instrc: case Opcodes::flt_lds_instrc: case Opcodes::flt_stu_instrc: case Opcodes::flt_sts_instrc:
+        case Opcodes::flt_add_instrc: case Opcodes::flt_sub_instrc: case Opcodes::flt_mul_instrc: case Opcodes::flt_div_instrc:
+        case Opcodes::flt_ceq_instrc: case Opcodes::flt_cne_instrc: case Opcodes::flt_cgt_instrc: case Opcodes::flt_cle_instrc:
+        case Opcodes::flt_rou_instrc: case Opcodes::flt_flr_instrc: case Opcodes::flt_cei_instrc: case Opcodes::flt_trn_instrc:
+        case Opcodes::cmovz_instrc: case Opcodes::cmovnz_instrc: case Opcodes::cmovgs_instrc: case Opcodes::cmovles_instrc:
+        case Opcodes::cmovzi_instrc: case Opcodes::cmovnzi_instrc:
+        case Opcodes::fence_acq_instrc: case Opcodes::fence_rel_instrc: case Opcodes::fence_acr_instrc: case Opcodes::fence_seq_instrc:
+        case Opcodes::vadd_instrc: case Opcodes::vsub_instrc: case Opcodes::vmul_instrc: case Opcodes::vand_instrc:
+        case Opcodes::vor_instrc: case Opcodes::vxor_instrc: case Opcodes::vceq_instrc: case Opcodes::vcgtu_instrc:
+        case Opcodes::vcgts_instrc: case Opcodes::vbrd_instrc: case Opcodes::vext_instrc:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+/** every opcode with an execution path, anything else is an invalid instruction */
+#define SUPERNOVA_OPCODES(X)                                                                          \
+    X(andr_instrc) X(andi_instrc) X(xorr_instrc) X(xori_instrc) X(orr_instrc) X(ori_instrc)           \
+    X(not_instrc) X(cnt_instrc) X(llsr_instrc) X(llsi_instrc) X(lrsr_instrc) X(lrsi_instrc)           \
+    X(addr_instrc) X(addi_instrc) X(subr_instrc) X(subi_instrc) X(umulr_instrc) X(umuli_instrc)       \
+    X(smulr_instrc) X(smuli_instrc) X(udivr_instrc) X(udivi_instrc) X(sdivr_instrc) X(sdivi_instrc)   \
+    X(call_instrc) X(push_instrc) X(retn_instrc) X(pull_instrc)                                       \
+    X(ld_byte_instrc) X(ld_half_instrc) X(ld_word_instrc) X(ld_dwrd_instrc)                           \
+    X(st_byte_instrc) X(st_half_instrc) X(st_word_instrc) X(st_dwrd_instrc)                           \
+    X(jal_instrc) X(jalr_instrc) X(je_instrc) X(jne_instrc)                                           \
+    X(jgu_instrc) X(jgs_instrc) X(jleu_instrc) X(jles_instrc)                                         \
+    X(setgur_instrc) X(setgui_instrc) X(setgsr_instrc) X(setgsi_instrc)                               \
+    X(setleur_instrc) X(setleui_instrc) X(setlesr_instrc) X(setlesi_instrc)                           \
+    X(lui_instrc) X(auipc_instrc) X(pcall_instrc)                                                     \
+    X(bout_instrc) X(out_instrc) X(bin_instrc) X(in_instrc)                                           \
+    X(flt_ldu_instrc) X(flt_lds_instrc) X(flt_stu_instrc) X(flt_sts_instrc)                           \
+    X(flt_add_instrc) X(flt_sub_instrc) X(flt_mul_instrc) X(flt_div_instrc)                           \
+    X(flt_ceq_instrc) X(flt_cne_instrc) X(flt_cgt_instrc) X(flt_cle_instrc)                           \
+    X(flt_rou_instrc) X(flt_flr_instrc) X(flt_cei_instrc) X(flt_trn_instrc)                           \
+    X(cmovz_instrc) X(cmovnz_instrc) X(cmovgs_instrc) X(cmovles_instrc)                               \
+    X(cmovzi_instrc) X(cmovnzi_instrc)                                                                \
+    X(ld_acq_instrc) X(st_rel_instrc) X(cas_instrc) X(xchg_instrc) X(xadd_instrc)                     \
+    X(fence_acq_instrc) X(fence_rel_instrc) X(fence_acr_instrc) X(fence_seq_instrc)                   \
+    X(vld_instrc) X(vst_instrc) X(vadd_instrc) X(vsub_instrc) X(vmul_instrc) X(vand_instrc)           \
+    X(vor_instrc) X(vxor_instrc) X(vceq_instrc) X(vcgtu_instrc) X(vcgts_instrc)                       \
+    X(vbrd_instrc) X(vext_instrc)
 
+    /**
+     * @brief execute a single instruction, with the program counter already past it
+     *
+     * every dispatch engine shares this function, the opcode being a template
+     * parameter lets the compiler keep only the case that matters
+     *
+     * @tparam opcode opcode of the instruction
+     * @tparam backend memory backend of the thread
+     * @param thread thread to execute on
+     * @param instr decoded instruction
+     */
+    template <Opcodes opcode, memory_backend backend>
+    [[gnu::always_inline]] inline void execute(Thread &thread, decoded_instruction const &instr) noexcept
+    {
         /// the amount of bits not accounted by an linstruction immediate
         constexpr auto low_bit_count = 13U;
 
-        switch (rinstr.opcode())
+        SUPERNOVA_COUNT(thread, opcodes[opcode]);
+
+        switch (opcode)
         {
         case Opcodes::andr_instrc:
-            thread.apply_instr(rinstr, std::bit_and<>{}); 
+            thread.apply_rinstr(instr, std::bit_and<>{}); 
             break;
         case Opcodes::andi_instrc:
-            thread.apply_instr(sinstr, std::bit_and<>{});
+            thread.apply_sinstr(instr, std::bit_and<>{});
             break;
         case Opcodes::xorr_instrc:
-            thread.apply_instr(rinstr, std::bit_xor<>{});
+            thread.apply_rinstr(instr, std::bit_xor<>{});
             break;
         case Opcodes::xori_instrc:
-            thread.apply_instr(sinstr, std::bit_xor<>{});
+            thread.apply_sinstr(instr, std::bit_xor<>{});
             break;
         case Opcodes::orr_instrc:
-            thread.apply_instr(rinstr, std::bit_or<>{});
+            thread.apply_rinstr(instr, std::bit_or<>{});
             break;
         case Opcodes::ori_instrc:
-            thread.apply_instr(sinstr, std::bit_or<>{});
+            thread.apply_sinstr(instr, std::bit_or<>{});
             break;
         case Opcodes::not_instrc:
-            thread.registers(rinstr.rd()) = ~thread.registers(rinstr.r1());
+            thread.registers(instr.rd) = ~thread.registers(instr.r1);
             break;
         case Opcodes::cnt_instrc:
-            thread.apply_instr(sinstr, supernova::helpers::popcount);
+            thread.apply_sinstr(instr, supernova::helpers::popcount);
             break;
         case Opcodes::llsr_instrc:
-            thread.apply_instr(rinstr, supernova::helpers::left_shift);
+            thread.apply_rinstr(instr, supernova::helpers::left_shift);
             break;
         case Opcodes::llsi_instrc:
-            thread.apply_instr(sinstr, supernova::helpers::left_shift);
+            thread.apply_sinstr(instr, supernova::helpers::left_shift);
             break;
         case Opcodes::lrsr_instrc:
-            thread.apply_instr(sinstr, supernova::helpers::right_shift);
+            thread.apply_rinstr(instr, supernova::helpers::right_shift);
             break;
         case Opcodes::lrsi_instrc:
-            thread.apply_instr(sinstr, supernova::helpers::right_shift);
+            thread.apply_sinstr(instr, supernova::helpers::right_shift);
             break;
         /**/
-
-        /**/
         case Opcodes::addr_instrc:
-            thread.apply_instr(rinstr, std::plus<>{});
+            thread.apply_rinstr(instr, std::plus<>{});
             break;
         case Opcodes::addi_instrc:
-            thread.apply_instr(sinstr, std::plus<>{});
+            thread.apply_sinstr(instr, std::plus<>{});
             break;
         case Opcodes::subr_instrc:
-            thread.apply_instr(rinstr, std::minus<>{});
+            thread.apply_rinstr(instr, std::minus<>{});
             break;
         case Opcodes::subi_instrc:
-            thread.apply_instr(sinstr, std::minus<>{});
+            thread.apply_sinstr(instr, std::minus<>{});
             break;
         /**/
         case Opcodes::umulr_instrc:
-            thread.apply_instr(rinstr, std::multiplies<uint64_t>{});
+            thread.apply_rinstr(instr, std::multiplies<uint64_t>{});
             break;
         case Opcodes::umuli_instrc:
-            thread.apply_instr(sinstr, std::multiplies<uint64_t>{});
+            thread.apply_sinstr(instr, std::multiplies<uint64_t>{});
             break;
         case Opcodes::smulr_instrc:
-            thread.apply_instr(rinstr, std::multiplies<int64_t>{});
+            thread.apply_rinstr(instr, std::multiplies<int64_t>{});
             break;
         case Opcodes::smuli_instrc:
-            thread.apply_instr(sinstr, std::multiplies<int64_t>{}, true);
+            thread.apply_sinstr(instr, std::multiplies<int64_t>{}, true);
             break;
         case Opcodes::udivr_instrc:
-            if (thread.registers(rinstr.r2()) == 0)
+            if (thread.registers(instr.r2) == 0)
             {
                 dispatch_pcall(thread, ProcessorCall::DivisionByZero);
                 return;
             }
-            thread.apply_instr(rinstr, std::divides<uint64_t>{});
+            thread.apply_rinstr(instr, std::divides<uint64_t>{});
             break;
         case Opcodes::udivi_instrc:
-            if (thread.registers(sinstr.imm()) == 0)
+            if (instr.uimm == 0)
             {
                 dispatch_pcall(thread, ProcessorCall::DivisionByZero);
                 return;
             }
-            thread.apply_instr(sinstr, std::divides<uint64_t>{});
+            thread.apply_sinstr(instr, std::divides<uint64_t>{});
             break;
         case Opcodes::sdivr_instrc:
-            if (thread.registers(rinstr.r2()) == 0)
+            if (thread.registers(instr.r2) == 0)
             {
                 dispatch_pcall(thread, ProcessorCall::DivisionByZero);
                 return;
             }
-            thread.apply_instr(rinstr, std::divides<int64_t>{});
+            thread.apply_rinstr(instr, std::divides<int64_t>{});
             break;
         case Opcodes::sdivi_instrc:
-            if (thread.registers(sinstr.imm()) == 0)
+            if (instr.imm == 0)
             {
                 dispatch_pcall(thread, ProcessorCall::DivisionByZero);
                 return;
             }
-            thread.apply_instr(sinstr, std::divides<int64_t>{}, true);
+            thread.apply_sinstr(instr, std::divides<int64_t>{}, true);
             break;
         /**/
         case Opcodes::call_instrc:
         {
-            auto &stack_ptr = thread.registers(rinstr.r1());
-            auto &base_ptr = thread.registers(rinstr.r2());
-            auto const &addr = thread.registers(rinstr.rd());
-            place<uint64_t>(thread, stack_ptr + 0 * sizeof(uint64_t), base_ptr);
-            place<uint64_t>(thread, stack_ptr + 1 * sizeof(uint64_t), thread.progc() + sizeof(uint64_t));
+            auto &stack_ptr = thread.registers(instr.r1);
+            auto &base_ptr = thread.registers(instr.r2);
+            auto const &addr = thread.registers(instr.rd);
+            place<uint64_t, backend>(thread, stack_ptr + 0 * sizeof(uint64_t), base_ptr);
+            place<uint64_t, backend>(thread, stack_ptr + 1 * sizeof(uint64_t), thread.progc() + sizeof(uint64_t));
             stack_ptr += 2 * sizeof(uint64_t);
             base_ptr = stack_ptr;
             thread.progc() = addr;
@@ -232,175 +843,1550 @@ namespace
         }
         case Opcodes::push_instrc:
         {
-            auto &retval = thread.registers(sinstr.rd());
-            auto &stack_ptr = thread.registers(sinstr.r1());
-            auto &imm = thread.registers(sinstr.uimm());
-            place<uint64_t>(thread, stack_ptr, retval + imm);
+            auto &retval = thread.registers(instr.rd);
+            auto &stack_ptr = thread.registers(instr.r1);
+            auto const imm = instr.imm;
+            place<uint64_t, backend>(thread, stack_ptr, retval + imm);
             stack_ptr += sizeof(uint64_t);
             break;
         }
         case Opcodes::retn_instrc:
         {
-            auto &stack_ptr = thread.registers(rinstr.r1());
-            auto &base_ptr = thread.registers(rinstr.r2());
+            auto &stack_ptr = thread.registers(instr.r1);
+            auto &base_ptr = thread.registers(instr.r2);
             auto &pcounter = thread.progc();
             stack_ptr -= 2 * sizeof(uint64_t);
-            base_ptr = fetch<uint64_t>(thread, stack_ptr + 0 * sizeof(uint64_t));
-            pcounter = fetch<uint64_t>(thread, stack_ptr + 1 * sizeof(uint64_t));
+            base_ptr = fetch<uint64_t, backend>(thread, stack_ptr + 0 * sizeof(uint64_t));
+            pcounter = fetch<uint64_t, backend>(thread, stack_ptr + 1 * sizeof(uint64_t));
             break;
         }
         case Opcodes::pull_instrc:
         {
-            auto &retval = thread.registers(sinstr.rd());
-            auto &stack_ptr = thread.registers(sinstr.r1());
+            auto &retval = thread.registers(instr.rd);
+            auto &stack_ptr = thread.registers(instr.r1);
             stack_ptr -= sizeof(uint64_t);
-            retval = fetch<uint64_t>(thread, stack_ptr);
+            retval = fetch<uint64_t, backend>(thread, stack_ptr);
             break;
         }
         /**/
         case Opcodes::ld_byte_instrc:
-            thread.registers(sinstr.rd()) = fetch<uint8_t>(thread, thread.registers(sinstr.r1()) + sinstr.imm());
+            SUPERNOVA_COUNT(thread, loads[0]);
+            thread.registers(instr.rd) = fetch<uint8_t, backend>(thread, thread.registers(instr.r1) + instr.imm);
             break;
         case Opcodes::ld_half_instrc:
-            thread.registers(sinstr.rd()) = fetch<uint16_t>(thread, thread.registers(sinstr.r1()) + sinstr.imm());
+            SUPERNOVA_COUNT(thread, loads[1]);
+            thread.registers(instr.rd) = fetch<uint16_t, backend>(thread, thread.registers(instr.r1) + instr.imm);
             break;
         case Opcodes::ld_word_instrc:
-            thread.registers(sinstr.rd()) = fetch<uint32_t>(thread, thread.registers(sinstr.r1()) + sinstr.imm());
+            SUPERNOVA_COUNT(thread, loads[2]);
+            thread.registers(instr.rd) = fetch<uint32_t, backend>(thread, thread.registers(instr.r1) + instr.imm);
             break;
         case Opcodes::ld_dwrd_instrc:
-            thread.registers(sinstr.rd()) = fetch<uint64_t>(thread, thread.registers(sinstr.r1()) + sinstr.imm());
+            SUPERNOVA_COUNT(thread, loads[3]);
+            thread.registers(instr.rd) = fetch<uint64_t, backend>(thread, thread.registers(instr.r1) + instr.imm);
             break;
         /**/
         case Opcodes::st_byte_instrc:
-            place<uint8_t>(thread, thread.registers(sinstr.rd()) + sinstr.imm(), thread.registers(sinstr.r1()));
+            SUPERNOVA_COUNT(thread, stores[0]);
+            place<uint8_t, backend>(thread, thread.registers(instr.rd) + instr.imm, thread.registers(instr.r1));
             break;
         case Opcodes::st_half_instrc:
-            place<uint16_t>(thread, thread.registers(sinstr.rd()) + sinstr.imm(), thread.registers(sinstr.r1()));
+            SUPERNOVA_COUNT(thread, stores[1]);
+            place<uint16_t, backend>(thread, thread.registers(instr.rd) + instr.imm, thread.registers(instr.r1));
             break;
         case Opcodes::st_word_instrc:
-            place<uint32_t>(thread, thread.registers(sinstr.rd()) + sinstr.imm(), thread.registers(sinstr.r1()));
+            SUPERNOVA_COUNT(thread, stores[2]);
+            place<uint32_t, backend>(thread, thread.registers(instr.rd) + instr.imm, thread.registers(instr.r1));
             break;
         case Opcodes::st_dwrd_instrc:
-            place<uint64_t>(thread, thread.registers(sinstr.rd()) + sinstr.imm(), thread.registers(sinstr.r1()));
+            SUPERNOVA_COUNT(thread, stores[3]);
+            place<uint64_t, backend>(thread, thread.registers(instr.rd) + instr.imm, thread.registers(instr.r1));
             break;
         /**/
         case Opcodes::jal_instrc:
-            thread.registers(linstr.r1()) = thread.progc() + sizeof(uint64_t);
-            thread.progc() += linstr.imm();
+            thread.registers(instr.r1) = thread.progc() + sizeof(uint64_t);
+            thread.progc() += instr.imm;
             break;
         case Opcodes::jalr_instrc:
-            thread.registers(sinstr.rd()) = thread.progc() + sizeof(uint64_t);
-            thread.progc() += thread.registers(sinstr.r1()) + sinstr.imm();
+            thread.registers(instr.rd) = thread.progc() + sizeof(uint64_t);
+            thread.progc() += thread.registers(instr.r1) + instr.imm;
             break;
         case Opcodes::je_instrc:
-            if (thread.registers(sinstr.rd()) == thread.registers(sinstr.r1()))
+            if (thread.registers(instr.rd) == thread.registers(instr.r1))
             {
-                thread.progc() += sinstr.imm();
+                SUPERNOVA_COUNT(thread, taken[opcode - Opcodes::je_instrc]);
+                thread.progc() += instr.imm;
+                break;
             }
+            SUPERNOVA_COUNT(thread, not_taken[opcode - Opcodes::je_instrc]);
             break;
         case Opcodes::jne_instrc:
-            if (thread.registers(sinstr.rd()) != thread.registers(sinstr.r1()))
+            if (thread.registers(instr.rd) != thread.registers(instr.r1))
             {
-                thread.progc() += sinstr.imm();
+                SUPERNOVA_COUNT(thread, taken[opcode - Opcodes::je_instrc]);
+                thread.progc() += instr.imm;
+                break;
             }
+            SUPERNOVA_COUNT(thread, not_taken[opcode - Opcodes::je_instrc]);
             break;
         /**/
         case Opcodes::jgu_instrc:
-            if (thread.registers(sinstr.rd()) > thread.registers(sinstr.r1()))
+            if (thread.registers(instr.rd) > thread.registers(instr.r1))
             {
-                thread.progc() += sinstr.imm();
+                SUPERNOVA_COUNT(thread, taken[opcode - Opcodes::je_instrc]);
+                thread.progc() += instr.imm;
+                break;
             }
+            SUPERNOVA_COUNT(thread, not_taken[opcode - Opcodes::je_instrc]);
             break;
         case Opcodes::jgs_instrc:
-            if (static_cast<int64_t>(thread.registers(sinstr.rd())) > static_cast<int64_t>(thread.registers(sinstr.r1())))
+            if (static_cast<int64_t>(thread.registers(instr.rd)) > static_cast<int64_t>(thread.registers(instr.r1)))
             {
-                thread.progc() += sinstr.imm();
+                SUPERNOVA_COUNT(thread, taken[opcode - Opcodes::je_instrc]);
+                thread.progc() += instr.imm;
+                break;
             }
+            SUPERNOVA_COUNT(thread, not_taken[opcode - Opcodes::je_instrc]);
             break;
         case Opcodes::jleu_instrc:
-            if (thread.registers(sinstr.rd()) <= thread.registers(sinstr.r1()))
+            if (thread.registers(instr.rd) <= thread.registers(instr.r1))
             {
-                thread.progc() += sinstr.imm();
+                SUPERNOVA_COUNT(thread, taken[opcode - Opcodes::je_instrc]);
+                thread.progc() += instr.imm;
+                break;
             }
+            SUPERNOVA_COUNT(thread, not_taken[opcode - Opcodes::je_instrc]);
             break;
         case Opcodes::jles_instrc:
-            if (static_cast<int64_t>(thread.registers(sinstr.rd())) <= static_cast<int64_t>(thread.registers(sinstr.r1())))
+            if (static_cast<int64_t>(thread.registers(instr.rd)) <= static_cast<int64_t>(thread.registers(instr.r1)))
             {
-                thread.progc() += sinstr.imm();
+                SUPERNOVA_COUNT(thread, taken[opcode - Opcodes::je_instrc]);
+                thread.progc() += instr.imm;
+                break;
             }
+            SUPERNOVA_COUNT(thread, not_taken[opcode - Opcodes::je_instrc]);
             break;
         /**/
         case Opcodes::setgur_instrc:
-            thread.registers(rinstr.rd()) = thread.registers(rinstr.r1()) > thread.registers(rinstr.r2());
+            thread.registers(instr.rd) = thread.registers(instr.r1) > thread.registers(instr.r2);
             break;
         case Opcodes::setgui_instrc:
-            thread.registers(sinstr.rd()) = thread.registers(sinstr.r1()) > static_cast<uint64_t>(sinstr.uimm());
+            thread.registers(instr.rd) = thread.registers(instr.r1) > static_cast<uint64_t>(instr.uimm);
             break;
         case Opcodes::setgsr_instrc:
-            thread.registers(rinstr.rd()) = static_cast<int64_t>(thread.registers(rinstr.r1())) > static_cast<int64_t>(thread.registers(rinstr.r2()));
+            thread.registers(instr.rd) = static_cast<int64_t>(thread.registers(instr.r1)) > static_cast<int64_t>(thread.registers(instr.r2));
             break;
         case Opcodes::setgsi_instrc:
-            thread.registers(sinstr.rd()) = static_cast<int64_t>(thread.registers(sinstr.r1())) > static_cast<int64_t>(sinstr.imm());
+            thread.registers(instr.rd) = static_cast<int64_t>(thread.registers(instr.r1)) > static_cast<int64_t>(instr.imm);
             break;
         /**/
         case Opcodes::setleur_instrc:
-            thread.registers(rinstr.rd()) = thread.registers(rinstr.r1()) <= thread.registers(rinstr.r2());
+            thread.registers(instr.rd) = thread.registers(instr.r1) <= thread.registers(instr.r2);
             break;
         case Opcodes::setleui_instrc:
-            thread.registers(sinstr.rd()) = thread.registers(sinstr.r1()) <= sinstr.uimm();
+            thread.registers(instr.rd) = thread.registers(instr.r1) <= instr.uimm;
             break;
         case Opcodes::setlesr_instrc:
-            thread.registers(rinstr.rd()) = static_cast<int64_t>(thread.registers(rinstr.r1())) <= static_cast<int64_t>(thread.registers(rinstr.r2()));
+            thread.registers(instr.rd) = static_cast<int64_t>(thread.registers(instr.r1)) <= static_cast<int64_t>(thread.registers(instr.r2));
             break;
         case Opcodes::setlesi_instrc:
-            thread.registers(sinstr.rd()) = static_cast<int64_t>(thread.registers(sinstr.r1())) <= static_cast<int64_t>(sinstr.imm());
+            thread.registers(instr.rd) = static_cast<int64_t>(thread.registers(instr.r1)) <= static_cast<int64_t>(instr.imm);
             break;
         /**/
         case Opcodes::lui_instrc:
-            thread.registers(linstr.r1()) |= linstr.imm() <<  low_bit_count;
+            thread.registers(instr.r1) |= instr.imm <<  low_bit_count;
             break;
         case Opcodes::auipc_instrc:
-            thread.registers(linstr.r1()) = thread.progc() + (linstr.imm() << low_bit_count);
+            thread.registers(instr.r1) = thread.progc() + (instr.imm << low_bit_count);
             break;
         case Opcodes::pcall_instrc:
-            dispatch_pcall(thread, static_cast<ProcessorCall>(linstr.imm()));
+            dispatch_pcall(thread, static_cast<ProcessorCall>(instr.imm));
             break;
-        default:
-            thread.registers(supernova::Thread::pcall_invopc) = rinstr.opcode();
-            dispatch_pcall(thread, ProcessorCall::InvalidInstruction);
+        /**/
+        // ports are addressed like memory, outputs take the port on rd and inputs on r1
+        case Opcodes::bout_instrc:
+            if (auto const *bus = io_bus_of(thread, opcode))
+            {
+                bus->write(thread.registers(instr.rd), thread.registers(instr.r1) & 0xFFU, sizeof(uint8_t));
+            }
             break;
-        }
-        thread.registers(0) = 0;
-    }
-} // namespace
-
-namespace supernova
-{
-    auto run(int argc, char **argv, Thread &thread, bool step) -> thread_return
-    {
-        thread.registers(0) = 0;
-        if (step) {
-            exec_instruction(thread);
-            return {true, 0};
-        }
-        
-        thread.registers(Thread::pcall_1stret) = argc;
-        thread.registers(Thread::pcall_2ndret) = reinterpret_cast<uint64_t>(argv);
-
-        // code will read itself
-
-        while (thread.signal() != DestroyFor::DoNotDestroy)
+        case Opcodes::out_instrc:
+            if (auto const *bus = io_bus_of(thread, opcode))
+            {
+                bus->write(thread.registers(instr.rd) + instr.imm, thread.registers(instr.r1), sizeof(uint64_t));
+            }
+            break;
+        case Opcodes::bin_instrc:
+            if (auto const *bus = io_bus_of(thread, opcode))
+            {
+                thread.registers(instr.rd) = bus->read(thread.registers(instr.r1), sizeof(uint8_t)) & 0xFFU;
+            }
+            break;
+        case Opcodes::in_instrc:
+            if (auto const *bus = io_bus_of(thread, opcode))
+            {
+                thread.registers(instr.rd) = bus->read(thread.registers(instr.r1) + instr.imm, sizeof(uint64_t));
+            }
+            break;
+        /**/
+        // IEEE 754 doubles straight from the host, nothing traps
+        case Opcodes::flt_ldu_instrc:
+            thread.floats(instr.rd) = static_cast<double>(thread.registers(instr.r1));
+            break;
+        case Opcodes::flt_lds_instrc:
+            thread.floats(instr.rd) = static_cast<double>(static_cast<int64_t>(thread.registers(instr.r1)));
+            break;
+        case Opcodes::flt_stu_instrc:
+            thread.registers(instr.rd) = float_to<uint64_t>(thread.floats(instr.r1));
+            break;
+        case Opcodes::flt_sts_instrc:
+            thread.registers(instr.rd) = static_cast<uint64_t>(float_to<int64_t>(thread.floats(instr.r1)));
+            break;
+        case Opcodes::flt_add_instrc:
+            thread.floats(instr.rd) = thread.floats(instr.r1) + thread.floats(instr.r2);
+            break;
+        case Opcodes::flt_sub_instrc:
+            thread.floats(instr.rd) = thread.floats(instr.r1) - thread.floats(instr.r2);
+            break;
+        case Opcodes::flt_mul_instrc:
+            thread.floats(instr.rd) = thread.floats(instr.r1) * thread.floats(instr.r2);
+            break;
+        case Opcodes::flt_div_instrc:
+            thread.floats(instr.rd) = thread.floats(instr.r1) / thread.floats(instr.r2);
+            break;
+        case Opcodes::flt_ceq_instrc:
+            thread.registers(instr.rd) = thread.floats(instr.r1) == thread.floats(instr.r2);
+            break;
+        case Opcodes::flt_cne_instrc:
+            thread.registers(instr.rd) = thread.floats(instr.r1) != thread.floats(instr.r2);
+            break;
+        case Opcodes::flt_cgt_instrc:
+            thread.registers(instr.rd) = thread.floats(instr.r1) > thread.floats(instr.r2);
+            break;
+        case Opcodes::flt_cle_instrc:
+            thread.registers(instr.rd) = thread.floats(instr.r1) <= thread.floats(instr.r2);
+            break;
+        case Opcodes::flt_rou_instrc:
+            thread.floats(instr.rd) = std::round(thread.floats(instr.r1));
+            break;
+        case Opcodes::flt_flr_instrc:
+            thread.floats(instr.rd) = std::floor(thread.floats(instr.r1));
+            break;
+        case Opcodes::flt_cei_instrc:
+            thread.floats(instr.rd) = std::ceil(thread.floats(instr.r1));
+            break;
+        case Opcodes::flt_trn_instrc:
+            thread.floats(instr.rd) = std::trunc(thread.floats(instr.r1));
+            break;
+        /**/
+        // written as selects so the host compiler keeps them branchless too
+        case Opcodes::cmovz_instrc:
+            thread.registers(instr.rd) = thread.registers(instr.r2) == 0 ? thread.registers(instr.r1) : thread.registers(instr.rd);
+            break;
+        case Opcodes::cmovnz_instrc:
+            thread.registers(instr.rd) = thread.registers(instr.r2) != 0 ? thread.registers(instr.r1) : thread.registers(instr.rd);
+            break;
+        case Opcodes::cmovgs_instrc:
+            thread.registers(instr.rd) = static_cast<int64_t>(thread.registers(instr.r2)) > 0 ? thread.registers(instr.r1) : thread.registers(instr.rd);
+            break;
+        case Opcodes::cmovles_instrc:
+            thread.registers(instr.rd) = static_cast<int64_t>(thread.registers(instr.r2)) <= 0 ? thread.registers(instr.r1) : thread.registers(instr.rd);
+            break;
+        case Opcodes::cmovzi_instrc:
+            thread.registers(instr.rd) = thread.registers(instr.r1) == 0 ? static_cast<uint64_t>(instr.imm) : thread.registers(instr.rd);
+            break;
+        case Opcodes::cmovnzi_instrc:
+            thread.registers(instr.rd) = thread.registers(instr.r1) != 0 ? static_cast<uint64_t>(instr.imm) : thread.registers(instr.rd);
+            break;
+        /**/
+        // std::atomic_ref is not around before C++20, the builtins take the same orderings
+        case Opcodes::ld_acq_instrc:
+            if (auto *word = atomic_word(thread, thread.registers(instr.r1) + instr.imm, supernova::PageRead))
+            {
+                thread.registers(instr.rd) = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+            }
+            break;
+        case Opcodes::st_rel_instrc:
         {
-            exec_instruction(thread);
+            const auto address = thread.registers(instr.rd) + instr.imm;
+            if (auto *word = atomic_word(thread, address, supernova::PageWrite))
+            {
+                __atomic_store_n(word, thread.registers(instr.r1), __ATOMIC_RELEASE);
+                atomic_written(thread, address, word);
+            }
+            break;
         }
-
-        const int ret_val = thread.registers(1);
-
-        if (thread.signal() == DestroyFor::ProgramEnd)
+        case Opcodes::cas_instrc:
         {
-            return thread_return{true, ret_val};
+            const auto address = thread.registers(instr.r1);
+            if (auto *word = atomic_word(thread, address, supernova::PageRead | supernova::PageWrite))
+            {
+                // rd gets the old value either way, it matches what was expected on success
+                auto expected = thread.registers(instr.rd);
+                __atomic_compare_exchange_n(word, &expected, thread.registers(instr.r2), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+                thread.registers(instr.rd) = expected;
+                atomic_written(thread, address, word);
+            }
+            break;
+        }
+        case Opcodes::xchg_instrc:
+        {
+            const auto address = thread.registers(instr.r1);
+            if (auto *word = atomic_word(thread, address, supernova::PageRead | supernova::PageWrite))
+            {
+                thread.registers(instr.rd) = __atomic_exchange_n(word, thread.registers(instr.r2), __ATOMIC_SEQ_CST);
+                atomic_written(thread, address, word);
+            }
+            break;
+        }
+        case Opcodes::xadd_instrc:
+        {
+            const auto address = thread.registers(instr.r1);
+            if (auto *word = atomic_word(thread, address, supernova::PageRead | supernova::PageWrite))
+            {
+                thread.registers(instr.rd) = __atomic_fetch_add(word, thread.registers(instr.r2), __ATOMIC_SEQ_CST);
+                atomic_written(thread, address, word);
+            }
+            break;
+        }
+        case Opcodes::fence_acq_instrc:
+            std::atomic_thread_fence(std::memory_order_acquire);
+            break;
+        case Opcodes::fence_rel_instrc:
+            std::atomic_thread_fence(std::memory_order_release);
+            break;
+        case Opcodes::fence_acr_instrc:
+            std::atomic_thread_fence(std::memory_order_acq_rel);
+            break;
+        case Opcodes::fence_seq_instrc:
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            break;
+        /**/
+        // vectors are no wider than `vector_width`, lanes past it are left alone
+        case Opcodes::vld_instrc:
+            if (auto const *bytes = vector_memory(thread, thread.registers(instr.r1) + instr.imm, supernova::PageRead))
+            {
+                std::memcpy(thread.vectors(instr.rd).lanes.data(), bytes, thread.vector_width());
+            }
+            break;
+        case Opcodes::vst_instrc:
+        {
+            const auto address = thread.registers(instr.rd) + instr.imm;
+            if (auto *bytes = vector_memory(thread, address, supernova::PageWrite))
+            {
+                std::memcpy(bytes, thread.vectors(instr.r1).lanes.data(), thread.vector_width());
+                thread.invalidate_decoded(address, thread.vector_width());
+                thread.invalidate_code(static_cast<uint64_t>(bytes - thread.memory().get()), thread.vector_width());
+            }
+            break;
+        }
+        case Opcodes::vadd_instrc: case Opcodes::vsub_instrc: case Opcodes::vmul_instrc:
+        case Opcodes::vand_instrc: case Opcodes::vor_instrc: case Opcodes::vxor_instrc:
+        case Opcodes::vceq_instrc: case Opcodes::vcgtu_instrc: case Opcodes::vcgts_instrc:
+            thread.vector_operations()(opcode, thread.vectors(instr.rd), thread.vectors(instr.r1), thread.vectors(instr.r2));
+            break;
+        case Opcodes::vbrd_instrc:
+        {
+            auto &lanes = thread.vectors(instr.rd).lanes;
+            std::fill_n(lanes.begin(), thread.vector_width() / sizeof(uint64_t), thread.registers(instr.r1));
+            break;
+        }
+        case Opcodes::vext_instrc:
+            thread.registers(instr.rd) = thread.vectors(instr.r1).lanes[instr.uimm % (thread.vector_width() / sizeof(uint64_t))];
+            break;
+        default:
+            thread.registers(supernova::Thread::pcall_invopc) = instr.opcode;
+            dispatch_pcall(thread, ProcessorCall::InvalidInstruction);
+            break;
+        }
+        thread.registers(0) = 0;
+    }
+
+#ifdef SUPERNOVA_GUARD_PAGES
+    /**
+     * @brief guarded mapping the current host thread is running on
+     */
+    struct guard_scope
+    {
+        sigjmp_buf resume{};             /**< where faults on the mapping jump back to */
+        uint8_t const *begin{nullptr};   /**< first byte of the mapping */
+        uint8_t const *end{nullptr};     /**< byte after the last guard page */
+        guard_scope *previous{nullptr};  /**< scope active before this one */
+        volatile uint64_t remaining{0};  /**< budget left after the instruction running, read after a fault jumped back */
+    };
+
+    thread_local guard_scope *active_guard = nullptr;
+#endif
+
+    /**
+     * @brief publish the budget left after the instruction about to run
+     *
+     * engines keep their budget in locals a fault on guarded memory jumps
+     * over, the guard scope keeps a copy to count what ran before the fault
+     *
+     * @tparam backend memory backend of the thread, only guarded memory keeps a copy
+     * @param remaining budget left once the instruction ran
+     */
+    template <memory_backend backend>
+    [[gnu::always_inline]] inline void checkpoint([[maybe_unused]] uint64_t remaining) noexcept
+    {
+#ifdef SUPERNOVA_GUARD_PAGES
+        if constexpr (backend == supernova::GuardedMemory)
+        {
+            active_guard->remaining = remaining;
+        }
+#endif
+    }
+
+    /**
+     * @brief execute both halves of a superinstruction
+     *
+     * the second half only runs if the first one fell through to it without
+     * signaling, faulting or using up the budget, it is left to be fetched on
+     * its own otherwise, so every instruction keeps its own semantics
+     *
+     * @tparam pair superinstruction
+     * @tparam first opcode of the first half
+     * @tparam second opcode of the second half
+     * @tparam backend memory backend of the thread
+     * @param thread thread to execute on
+     * @param instr decoded first half, the program counter already past it
+     * @param remaining budget left after the first half
+     *
+     * @return budget left after the instructions that ran
+     */
+    template <fusion pair, Opcodes first, Opcodes second, memory_backend backend>
+    [[gnu::always_inline]] inline auto execute_pair(Thread &thread, decoded_instruction const &instr, uint64_t remaining) noexcept -> uint64_t
+    {
+        const auto address = thread.progc();
+        const auto state = thread.pcall();
+
+        execute<first, backend>(thread, instr);
+
+        if (remaining == 0 || thread.progc() != address ||
+            (may_signal(first) && (thread.signal() != DestroyFor::DoNotDestroy || thread.pcall() != state)))
+        {
+            return remaining;
+        }
+
+        auto const &next = thread.decoded(address);
+        if (next.address != address)
+        {
+            return remaining;
+        }
+
+        thread.progc() += sizeof(uint64_t);
+        checkpoint<backend>(remaining - 1);
+        execute<second, backend>(thread, next);
+        SUPERNOVA_COUNT(thread, fused[pair]);
+        return remaining - 1;
+    }
+
+    /**
+     * @brief execute an instruction without an execution path
+     *
+     * @param thread thread to execute on
+     * @param instr decoded instruction
+     */
+    void execute_invalid(Thread &thread, decoded_instruction const &instr) noexcept
+    {
+        SUPERNOVA_COUNT(thread, opcodes[instr.opcode]);
+        thread.registers(supernova::Thread::pcall_invopc) = instr.opcode;
+        dispatch_pcall(thread, ProcessorCall::InvalidInstruction);
+        thread.registers(0) = 0;
+    }
+
+    /**
+     * @brief switch based dispatch, always available
+     *
+     * @tparam backend memory backend of the thread
+     * @param thread thread to run
+     * @param budget maximum amount of instructions to run
+     *
+     * @return amount of instructions ran
+     */
+    template <memory_backend backend>
+    auto dispatch_switch(Thread &thread, uint64_t budget) noexcept -> uint64_t
+    {
+        auto remaining = budget;
+
+        while (remaining != 0 && thread.signal() == DestroyFor::DoNotDestroy)
+        {
+            --remaining;
+            checkpoint<backend>(remaining);
+            const auto *instr = fetch_decoded(thread);
+            if (instr == nullptr)
+            {
+                continue;
+            }
+
+            thread.progc() += sizeof(uint64_t);
+
+            switch (static_cast<uint8_t>(instr->opcode))
+            {
+#define SUPERNOVA_CASE(opc)                           \
+    case Opcodes::opc:                                \
+        execute<Opcodes::opc, backend>(thread, *instr); \
+        break;
+                SUPERNOVA_OPCODES(SUPERNOVA_CASE)
+#undef SUPERNOVA_CASE
+#define SUPERNOVA_FUSED_CASE(name, first, second)                                                                  \
+    case fused_base + fused_##name:                                                                              \
+        remaining = execute_pair<fused_##name, Opcodes::first, Opcodes::second, backend>(thread, *instr, remaining); \
+        break;
+                SUPERNOVA_FUSIONS(SUPERNOVA_FUSED_CASE)
+#undef SUPERNOVA_FUSED_CASE
+            default:
+                execute_invalid(thread, *instr);
+                break;
+            }
+        }
+
+        return budget - remaining;
+    }
+
+    /**
+     * @brief instruction handler used by the tail call engine
+     *
+     * receives the instruction to execute and the budget left after it,
+     * returns the budget left when the engine needs to stop
+     */
+    using threaded_handler = auto (*)(Thread &, decoded_instruction const &, uint64_t) noexcept -> uint64_t;
+
+    template <memory_backend backend>
+    auto threaded_handlers() noexcept -> std::array<threaded_handler, 256> const &;
+
+#ifdef SUPERNOVA_MUSTTAIL
+/** jump straight into the handler of the next instruction, `signals` tells if the last one may have signaled */
+#define SUPERNOVA_CHAIN(signals)                                                                                            \
+    if ((signals) && thread.signal() != DestroyFor::DoNotDestroy)                                                           \
+    {                                                                                                                       \
+        return remaining;                                                                                                   \
+    }                                                                                                                       \
+    /* only aligned, cached instructions are chained, everything else goes back to the loop */                             \
+    if (remaining == 0 || (thread.progc() % sizeof(uint64_t)) != 0 || thread.decoded(thread.progc()).address != thread.progc()) \
+    {                                                                                                                       \
+        return remaining;                                                                                                   \
+    }                                                                                                                       \
+    auto const &next = thread.decoded(thread.progc());                                                                      \
+    thread.progc() += sizeof(uint64_t);                                                                                     \
+    checkpoint<backend>(remaining - 1);                                                                                     \
+    SUPERNOVA_MUSTTAIL return threaded_handlers<backend>()[next.opcode](thread, next, remaining - 1)
+#else
+#define SUPERNOVA_CHAIN(signals) return remaining
+#endif
+
+    template <Opcodes opcode, memory_backend backend>
+    auto threaded(Thread &thread, decoded_instruction const &instr, uint64_t remaining) noexcept -> uint64_t
+    {
+        execute<opcode, backend>(thread, instr);
+        SUPERNOVA_CHAIN(may_signal(opcode));
+    }
+
+    template <fusion pair, Opcodes first, Opcodes second, memory_backend backend>
+    auto threaded_pair(Thread &thread, decoded_instruction const &instr, uint64_t remaining) noexcept -> uint64_t
+    {
+        remaining = execute_pair<pair, first, second, backend>(thread, instr, remaining);
+        SUPERNOVA_CHAIN(may_signal(first) || may_signal(second));
+    }
+
+#undef SUPERNOVA_CHAIN
+
+    auto threaded_invalid(Thread &thread, decoded_instruction const &instr, uint64_t remaining) noexcept -> uint64_t
+    {
+        execute_invalid(thread, instr);
+        return remaining;
+    }
+
+    template <memory_backend backend>
+    auto threaded_handlers() noexcept -> std::array<threaded_handler, 256> const &
+    {
+        static const auto handlers = []()
+        {
+            std::array<threaded_handler, 256> table{};
+            table.fill(threaded_invalid);
+#define SUPERNOVA_HANDLER(opc) table[Opcodes::opc] = threaded<Opcodes::opc, backend>;
+            SUPERNOVA_OPCODES(SUPERNOVA_HANDLER)
+#undef SUPERNOVA_HANDLER
+#define SUPERNOVA_FUSED_HANDLER(name, first, second) \
+    table[fused_base + fused_##name] = threaded_pair<fused_##name, Opcodes::first, Opcodes::second, backend>;
+            SUPERNOVA_FUSIONS(SUPERNOVA_FUSED_HANDLER)
+#undef SUPERNOVA_FUSED_HANDLER
+            return table;
+        }();
+        return handlers;
+    }
+
+    /**
+     * @brief handler table based dispatch
+     *
+     * with guaranteed tail calls handlers jump straight into the next one,
+     * otherwise this loop calls a handler per instruction
+     *
+     * @tparam backend memory backend of the thread
+     * @param thread thread to run
+     * @param budget maximum amount of instructions to run
+     *
+     * @return amount of instructions ran
+     */
+    template <memory_backend backend>
+    auto dispatch_threaded(Thread &thread, uint64_t budget) noexcept -> uint64_t
+    {
+        auto const &handlers = threaded_handlers<backend>();
+        auto remaining = budget;
+
+        while (remaining != 0 && thread.signal() == DestroyFor::DoNotDestroy)
+        {
+            --remaining;
+            checkpoint<backend>(remaining);
+            const auto *instr = fetch_decoded(thread);
+            if (instr == nullptr)
+            {
+                continue;
+            }
+
+            thread.progc() += sizeof(uint64_t);
+            remaining = handlers[instr->opcode](thread, *instr, remaining);
+        }
+
+        return budget - remaining;
+    }
+
+#ifdef SUPERNOVA_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+    /**
+     * @brief build the label table for the computed goto engine
+     *
+     * @param invalid label for opcodes without execution paths
+     * @param labels pairs of opcodes and their labels
+     *
+     * @return table indexed by opcode
+     */
+    auto goto_labels(void *invalid, std::initializer_list<std::pair<Opcodes, void *>> labels) noexcept -> std::array<void *, 256>
+    {
+        std::array<void *, 256> table{};
+        table.fill(invalid);
+        for (auto const &[opcode, label] : labels)
+        {
+            table[opcode] = label;
+        }
+        return table;
+    }
+
+    /**
+     * @brief computed goto dispatch, each handler jumps straight into the next
+     *
+     * @tparam backend memory backend of the thread
+     * @param thread thread to run
+     * @param budget maximum amount of instructions to run
+     *
+     * @return amount of instructions ran
+     */
+    template <memory_backend backend>
+    auto dispatch_goto(Thread &thread, uint64_t budget) noexcept -> uint64_t
+    {
+        static const auto labels = goto_labels(&&label_invalid, {
+#define SUPERNOVA_LABEL(opc) {Opcodes::opc, &&label_##opc},
+            SUPERNOVA_OPCODES(SUPERNOVA_LABEL)
+#undef SUPERNOVA_LABEL
+#define SUPERNOVA_FUSED_LABEL(name, first, second) {fused_opcode(fused_##name), &&label_fused_##name},
+            SUPERNOVA_FUSIONS(SUPERNOVA_FUSED_LABEL)
+#undef SUPERNOVA_FUSED_LABEL
+        });
+
+        auto remaining = budget;
+        decoded_instruction const *instr = nullptr;
+
+#define SUPERNOVA_NEXT()                           \
+    if (remaining == 0)                            \
+    {                                              \
+        goto done;                                 \
+    }                                              \
+    --remaining;                                   \
+    checkpoint<backend>(remaining);                \
+    instr = fetch_decoded(thread);                 \
+    if (instr == nullptr)                          \
+    {                                              \
+        goto faulted;                              \
+    }                                              \
+    thread.progc() += sizeof(uint64_t);            \
+    goto *labels[instr->opcode]
+
+        if (thread.signal() != DestroyFor::DoNotDestroy)
+        {
+            goto done;
+        }
+
+        SUPERNOVA_NEXT();
+
+#define SUPERNOVA_HANDLER(opc)                                                           \
+    label_##opc:                                                                         \
+        execute<Opcodes::opc, backend>(thread, *instr);                                  \
+        if (may_signal(Opcodes::opc) && thread.signal() != DestroyFor::DoNotDestroy)     \
+        {                                                                                \
+            goto done;                                                                   \
+        }                                                                                \
+        SUPERNOVA_NEXT();
+
+        SUPERNOVA_OPCODES(SUPERNOVA_HANDLER)
+#undef SUPERNOVA_HANDLER
+
+#define SUPERNOVA_FUSED_HANDLER(name, first, second)                                                               \
+    label_fused_##name:                                                                                          \
+        remaining = execute_pair<fused_##name, Opcodes::first, Opcodes::second, backend>(thread, *instr, remaining); \
+        if ((may_signal(Opcodes::first) || may_signal(Opcodes::second)) && thread.signal() != DestroyFor::DoNotDestroy) \
+        {                                                                                                        \
+            goto done;                                                                                           \
+        }                                                                                                        \
+        SUPERNOVA_NEXT();
+
+        SUPERNOVA_FUSIONS(SUPERNOVA_FUSED_HANDLER)
+#undef SUPERNOVA_FUSED_HANDLER
+
+    label_invalid:
+        execute_invalid(thread, *instr);
+    faulted:
+        if (thread.signal() != DestroyFor::DoNotDestroy)
+        {
+            goto done;
+        }
+        SUPERNOVA_NEXT();
+
+#undef SUPERNOVA_NEXT
+    done:
+        return budget - remaining;
+    }
+
+#pragma GCC diagnostic pop
+#endif
+
+    /**
+     * @brief check if an instruction is the last one of a basic block
+     *
+     * @param opcode instruction opcode
+     *
+     * @return true for jumps, calls, returns and processor calls
+     */
+    [[nodiscard, gnu::const]] constexpr auto ends_block(Opcodes opcode) noexcept -> bool
+    {
+        switch (opcode)
+        {
+        case Opcodes::jal_instrc: case Opcodes::jalr_instrc: case Opcodes::je_instrc: case Opcodes::jne_instrc:
+        case Opcodes::jgu_instrc: case Opcodes::jgs_instrc: case Opcodes::jleu_instrc: case Opcodes::jles_instrc:
+        case Opcodes::call_instrc: case Opcodes::retn_instrc: case Opcodes::pcall_instrc:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief check if an instruction needs the program counter to be past it
+     *
+     * instructions inside a block that neither read it nor signal leave it
+     * behind, it only gets updated before the ones that do
+     *
+     * @param opcode instruction opcode
+     *
+     * @return true if the instruction reads the program counter or may raise a processor call
+     */
+    [[nodiscard, gnu::const]] constexpr auto reads_pc(Opcodes opcode) noexcept -> bool
+    {
+        return may_signal(opcode) || ends_block(opcode) || opcode == Opcodes::auipc_instrc;
+    }
+
+    /**
+     * @brief check if an instruction writes to memory, possibly over the block running it
+     *
+     * @param opcode instruction opcode
+     *
+     * @return true for stores, pushes and read-modify-write atomics
+     */
+    [[nodiscard, gnu::const]] constexpr auto writes_memory(Opcodes opcode) noexcept -> bool
+    {
+        switch (opcode)
+        {
+        case Opcodes::st_byte_instrc: case Opcodes::st_half_instrc: case Opcodes::st_word_instrc: case Opcodes::st_dwrd_instrc:
+        case Opcodes::push_instrc: case Opcodes::st_rel_instrc: case Opcodes::cas_instrc: case Opcodes::xchg_instrc:
+        case Opcodes::xadd_instrc: case Opcodes::vst_instrc:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief decode the basic block starting on the program counter into the cache
+     *
+     * @param thread thread to fetch from
+     *
+     * @return pointer to the block, or `nullptr` if not even its first instruction could be fetched
+     */
+    [[gnu::noinline]] auto refill_block(Thread &thread) noexcept -> supernova::decoded_block *
+    {
+        const auto address = thread.progc();
+        auto physical = address;
+        auto limit = thread.memsize();
+
+        // blocks stay inside a single page, the next one may map anywhere
+        if (thread.paging())
+        {
+            physical = translate(thread, address, sizeof(uint64_t), supernova::PageExecute);
+            if (physical == Thread::untranslated)
+            {
+                return nullptr;
+            }
+            const auto page_end = (physical | (thread.page_size() - 1)) + 1;
+            limit = page_end < limit ? page_end : limit;
+        }
+
+        auto &block = thread.block(address);
+
+        block.address = decoded_instruction::invalid_address;
+        block.exits = {};
+        block.length = 0;
+
+        for (auto next = physical; block.length < supernova::decoded_block::max_length; next += sizeof(uint64_t))
+        {
+            if (next >= limit || limit - next < sizeof(uint64_t))
+            {
+                break;
+            }
+
+            // NOLINTNEXTLINE: bounds were checked above
+            const auto raw = *reinterpret_cast<uint64_t const *>(thread.memory().get() + next);
+            auto const &instr = block.instructions[block.length] = supernova::decode(raw, address + block.length * sizeof(uint64_t));
+            ++block.length;
+            if (ends_block(instr.opcode))
+            {
+                break;
+            }
+        }
+
+        if (block.length == 0)
+        {
+            dispatch_pcall(thread, ProcessorCall::MemoryLimit);
+            return nullptr;
+        }
+
+        block.address = address;
+        block.end = address + block.length * sizeof(uint64_t);
+        thread.track_block(block);
+        thread.watch_decoded(physical, block.length * sizeof(uint64_t));
+        return &block;
+    }
+
+    /**
+     * @brief run a basic block from its first instruction
+     *
+     * only instructions able to signal are checked after running, a fault
+     * moving the program counter, a signal or a write dropping the block
+     * itself stops it right there, the program counter is only kept up to
+     * date for instructions reading it
+     *
+     * @tparam backend memory backend of the thread
+     * @param thread thread to run
+     * @param block block to run, its first instruction is on the program counter
+     * @param remaining budget left before the block, at least its length
+     *
+     * @return amount of instructions ran
+     */
+    template <memory_backend backend>
+    auto execute_block(Thread &thread, supernova::decoded_block const &block, uint64_t remaining) noexcept -> uint64_t
+    {
+        const auto address = block.address;
+        auto const *const first = block.instructions.data();
+        auto const *const last = first + block.length;
+        auto const *instr = first;
+
+/** run a single instruction, leaving the block if it faulted, signaled or wrote over the block */
+#define SUPERNOVA_BLOCK_STEP(opc)                                                                                   \
+    checkpoint<backend>(remaining - static_cast<uint64_t>(instr - first) - 1);                                      \
+    if (reads_pc(Opcodes::opc))                                                                                     \
+    {                                                                                                               \
+        thread.progc() = instr->address + sizeof(uint64_t);                                                         \
+    }                                                                                                               \
+    execute<Opcodes::opc, backend>(thread, *instr);                                                                 \
+    if (may_signal(Opcodes::opc) &&                                                                                 \
+        (thread.signal() != DestroyFor::DoNotDestroy || thread.progc() != instr->address + sizeof(uint64_t)))       \
+    {                                                                                                               \
+        return static_cast<uint64_t>(instr - first) + 1;                                                            \
+    }                                                                                                               \
+    if (writes_memory(Opcodes::opc) && block.address != address)                                                    \
+    {                                                                                                               \
+        return static_cast<uint64_t>(instr - first) + 1;                                                            \
+    }
+
+#ifdef SUPERNOVA_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+        static const auto labels = goto_labels(&&label_invalid, {
+#define SUPERNOVA_LABEL(opc) {Opcodes::opc, &&label_##opc},
+            SUPERNOVA_OPCODES(SUPERNOVA_LABEL)
+#undef SUPERNOVA_LABEL
+        });
+
+        goto *labels[instr->opcode];
+
+#define SUPERNOVA_BLOCK_HANDLER(opc)    \
+    label_##opc:                        \
+        SUPERNOVA_BLOCK_STEP(opc)       \
+        if (++instr == last)            \
+        {                               \
+            goto done;                  \
+        }                               \
+        goto *labels[instr->opcode];
+        SUPERNOVA_OPCODES(SUPERNOVA_BLOCK_HANDLER)
+#undef SUPERNOVA_BLOCK_HANDLER
+
+    label_invalid:
+        thread.progc() = instr->address + sizeof(uint64_t);
+        execute_invalid(thread, *instr);
+        return static_cast<uint64_t>(instr - first) + 1;
+
+    done:
+#pragma GCC diagnostic pop
+#else
+        for (; instr != last; ++instr)
+        {
+            switch (static_cast<uint8_t>(instr->opcode))
+            {
+#define SUPERNOVA_BLOCK_CASE(opc) \
+    case Opcodes::opc:            \
+    {                             \
+        SUPERNOVA_BLOCK_STEP(opc) \
+        break;                    \
+    }
+                SUPERNOVA_OPCODES(SUPERNOVA_BLOCK_CASE)
+#undef SUPERNOVA_BLOCK_CASE
+            default:
+                thread.progc() = instr->address + sizeof(uint64_t);
+                execute_invalid(thread, *instr);
+                return static_cast<uint64_t>(instr - first) + 1;
+            }
+        }
+#endif
+#undef SUPERNOVA_BLOCK_STEP
+
+        // blocks split for being too long end on an instruction that left the program counter behind
+        if (!ends_block(last[-1].opcode))
+        {
+            thread.progc() = block.end;
+        }
+        return block.length;
+    }
+
+    /**
+     * @brief basic block dispatch, each block jumps straight into the next one it links to
+     *
+     * blocks only run whole, a budget ending in the middle of one is
+     * finished instruction by instruction
+     *
+     * @tparam backend memory backend of the thread
+     * @param thread thread to run
+     * @param budget maximum amount of instructions to run
+     *
+     * @return amount of instructions ran
+     */
+    template <memory_backend backend>
+    auto dispatch_blocks(Thread &thread, uint64_t budget) noexcept -> uint64_t
+    {
+        if (!thread.reserve_blocks())
+        {
+            return dispatch_switch<backend>(thread, budget);
+        }
+
+        auto remaining = budget;
+        supernova::decoded_block *last = nullptr;
+
+        while (remaining != 0 && thread.signal() == DestroyFor::DoNotDestroy)
+        {
+            const auto address = thread.progc();
+            auto *block = last != nullptr ? last->exits[address == last->end ? 0 : 1] : nullptr;
+
+            if (block == nullptr || block->address != address)
+            {
+                block = &thread.block(address);
+                if (block->address != address)
+                {
+                    block = refill_block(thread);
+                }
+
+                if (block == nullptr)
+                {
+                    --remaining;
+                    checkpoint<backend>(remaining);
+                    last = nullptr;
+                    continue;
+                }
+
+                if (last != nullptr)
+                {
+                    last->exits[address == last->end ? 0 : 1] = block;
+                }
+            }
+
+            if (block->length > remaining)
+            {
+                remaining -= dispatch_switch<backend>(thread, remaining);
+                break;
+            }
+
+            remaining -= execute_block<backend>(thread, *block, remaining);
+            last = block;
+        }
+
+        return budget - remaining;
+    }
+
+    /**
+     * @brief run an engine with accesses specialized for a memory backend
+     *
+     * @tparam backend memory backend of the thread
+     * @param thread thread to run
+     * @param engine engine to use
+     * @param budget maximum amount of instructions to run
+     *
+     * @return amount of instructions ran
+     */
+    template <memory_backend backend>
+    auto dispatch_on(Thread &thread, supernova::dispatch_engine engine, uint64_t budget) noexcept -> uint64_t
+    {
+        switch (engine)
+        {
+        case supernova::TailCallDispatch:
+            return dispatch_threaded<backend>(thread, budget);
+#ifdef SUPERNOVA_COMPUTED_GOTO
+        case supernova::GotoDispatch:
+            return dispatch_goto<backend>(thread, budget);
+#endif
+        case supernova::BlockDispatch:
+            return dispatch_blocks<backend>(thread, budget);
+        default:
+            return dispatch_switch<backend>(thread, budget);
+        }
+    }
+
+#ifdef SUPERNOVA_GUARD_PAGES
+    struct sigaction previous_segv{};
+    struct sigaction previous_bus{};
+
+    /**
+     * @brief fault handler, resumes the interpreter when a guard page is hit
+     *
+     * faults anywhere else are given to the handler installed before this one
+     */
+    void guard_fault(int signal, siginfo_t *info, void *context)
+    {
+        auto const *scope = active_guard;
+        auto const *address = static_cast<uint8_t const *>(info->si_addr);
+
+        if (scope != nullptr && address >= scope->begin && address < scope->end)
+        {
+            siglongjmp(active_guard->resume, 1);
+        }
+
+        auto const &previous = signal == SIGSEGV ? previous_segv : previous_bus;
+        if ((previous.sa_flags & SA_SIGINFO) != 0)
+        {
+            previous.sa_sigaction(signal, info, context);
+            return;
+        }
+        if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN)
+        {
+            previous.sa_handler(signal);
+            return;
+        }
+
+        // the faulting instruction runs again after returning, this time without a handler
+        sigaction(signal, &previous, nullptr);
+    }
+
+    /**
+     * @brief install the fault handler, once per process
+     * @return true if faults on guard pages can be caught
+     */
+    auto install_guard_handler() noexcept -> bool
+    {
+        static const auto installed = []()
+        {
+            struct sigaction action{};
+            action.sa_sigaction = guard_fault;
+            action.sa_flags = SA_SIGINFO | SA_NODEFER;
+            sigemptyset(&action.sa_mask);
+            return sigaction(SIGSEGV, &action, &previous_segv) == 0 && sigaction(SIGBUS, &action, &previous_bus) == 0;
+        }();
+        return installed;
+    }
+
+    /**
+     * @brief run an engine on a thread with guarded memory
+     *
+     * an access hitting the guard pages drops the instruction doing it, raises
+     * `MemoryLimit` and ends the current run, counting the instructions ran
+     * up to the one that faulted
+     *
+     * @param thread thread to run
+     * @param engine engine to use
+     * @param budget maximum amount of instructions to run
+     *
+     * @return amount of instructions ran
+     */
+    auto dispatch_guarded(Thread &thread, supernova::dispatch_engine engine, uint64_t budget) noexcept -> uint64_t
+    {
+        auto const &deleter = thread.memory().get_deleter();
+
+        guard_scope scope{};
+        scope.begin = static_cast<uint8_t const *>(deleter.mapping);
+        scope.end = scope.begin + deleter.length;
+        scope.previous = active_guard;
+        scope.remaining = budget;
+        active_guard = &scope;
+
+        if (sigsetjmp(scope.resume, 0) != 0)
+        {
+            active_guard = scope.previous;
+            dispatch_pcall(thread, ProcessorCall::MemoryLimit);
+            return budget - scope.remaining;
+        }
+
+        const auto ran = dispatch_on<supernova::GuardedMemory>(thread, engine, budget);
+        active_guard = scope.previous;
+        return ran;
+    }
+
+    /** cut [first, end) out of a list of ranges, splitting the ones it lands inside of */
+    void drop_ranges(std::vector<std::pair<uint64_t, uint64_t>> &ranges, uint64_t first, uint64_t end)
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> kept{};
+        for (auto const &range : ranges)
+        {
+            if (range.second <= first || end <= range.first)
+            {
+                kept.push_back(range);
+                continue;
+            }
+            if (range.first < first)
+            {
+                kept.emplace_back(range.first, first);
+            }
+            if (end < range.second)
+            {
+                kept.emplace_back(end, range.second);
+            }
+        }
+        ranges = std::move(kept);
+    }
+#endif
+} // namespace
+
+namespace supernova
+{
+    auto dispatch_available(dispatch_engine engine) noexcept -> bool
+    {
+        switch (engine)
+        {
+        case SwitchDispatch:
+        case TailCallDispatch:
+        case BlockDispatch:
+            return true;
+        case GotoDispatch:
+#ifdef SUPERNOVA_COMPUTED_GOTO
+            return true;
+#else
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    auto default_dispatch() noexcept -> dispatch_engine
+    {
+        return SUPERNOVA_DEFAULT_DISPATCH;
+    }
+
+    auto dispatch(Thread &thread, dispatch_engine engine, uint64_t budget) noexcept -> uint64_t
+    {
+#ifdef SUPERNOVA_GUARD_PAGES
+        if (thread.backend() == GuardedMemory)
+        {
+            return dispatch_guarded(thread, engine, budget);
+        }
+#endif
+        return dispatch_on<CheckedMemory>(thread, engine, budget);
+    }
+
+    void memory_deleter::operator()(uint8_t *memory) const noexcept
+    {
+        // the last hart releases memory through its own copy of the deleter
+        if (this->shared != nullptr)
+        {
+            return;
+        }
+
+#ifdef SUPERNOVA_GUARD_PAGES
+        if (this->mapping != nullptr)
+        {
+            munmap(this->mapping, this->length);
+            return;
+        }
+#endif
+        delete[] memory;
+    }
+
+    auto Thread::use_guard_pages() noexcept -> bool
+    {
+#ifdef SUPERNOVA_GUARD_PAGES
+        if (this->m_backend == GuardedMemory)
+        {
+            return true;
+        }
+
+        if (!install_guard_handler())
+        {
+            return false;
+        }
+
+        // memory already followed by an inaccessible page only needs the handler
+        if (this->m_memory.get_deleter().guarded)
+        {
+            this->m_backend = GuardedMemory;
+            return true;
+        }
+
+        // other harts point into memory, it can not move anymore
+        if (this->m_memory.get_deleter().shared != nullptr)
+        {
+            return false;
+        }
+
+        const auto page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        const auto reach = guarded_size(this->m_memory_size);
+        const auto accessible = (reach + page - 1) & ~(page - 1);
+
+        auto *mapping = mmap(nullptr, accessible + page, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+        {
+            return false;
+        }
+
+        if (accessible != 0 && mprotect(mapping, accessible, PROT_READ | PROT_WRITE) != 0)
+        {
+            munmap(mapping, accessible + page);
+            return false;
+        }
+
+        // the last double word of memory sits right before the first guard page
+        auto *memory = static_cast<uint8_t *>(mapping) + (accessible - reach);
+        if (this->m_memory_size != 0)
+        {
+            std::memcpy(memory, this->m_memory.get(), this->m_memory_size);
+        }
+
+        this->m_memory = std::unique_ptr<uint8_t[], memory_deleter>(memory, memory_deleter{mapping, accessible + page, true});
+        this->m_backend = GuardedMemory;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    auto host_page_size() noexcept -> uint64_t
+    {
+#ifdef SUPERNOVA_GUARD_PAGES
+        static const auto page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        return page;
+#else
+        return 0;
+#endif
+    }
+
+    auto Thread::map_host(uint64_t address, int descriptor, uint64_t offset, uint64_t length, uint8_t flags) noexcept -> bool
+    {
+#ifdef SUPERNOVA_GUARD_PAGES
+        const auto page = host_page_size();
+        // guarded memory reaches up to a page, so ranges ending as far from it as a whole number of pages are page aligned
+        if (this->m_backend != GuardedMemory || descriptor < 0 || offset % page != 0 || length == 0 || length % page != 0 ||
+            address > this->m_memory_size || this->m_memory_size - address < length || (guarded_size(this->m_memory_size) - address) % page != 0)
+        {
+            return false;
+        }
+
+        // snapshots and peeks read memory directly, translated code and the ring write it directly too
+        const auto writable = (flags & headers::mem_write) != 0;
+        if ((flags & (headers::mem_read | headers::mem_execute)) == 0 ||
+            (!writable && (this->m_code_pages != nullptr || this->m_hosted != nullptr)))
+        {
+            return false;
+        }
+
+        auto *start = this->m_memory.get() + address;
+
+        auto protection = PROT_NONE;
+        protection |= (flags & (headers::mem_read | headers::mem_execute)) != 0 ? PROT_READ : 0;
+        protection |= (flags & headers::mem_write) != 0 ? PROT_WRITE : 0;
+
+        // a fixed mapping that fails may have dropped what was there, try the descriptor elsewhere first
+        auto *probe = mmap(nullptr, length, protection, MAP_SHARED, descriptor, static_cast<off_t>(offset));
+        if (probe == MAP_FAILED)
+        {
+            return false;
+        }
+        munmap(probe, length);
+
+        if (mmap(start, length, protection, MAP_SHARED | MAP_FIXED, descriptor, static_cast<off_t>(offset)) == MAP_FAILED)
+        {
+            return false;
+        }
+        drop_ranges(this->m_read_only, address, address + length);
+        if (!writable)
+        {
+            this->m_read_only.emplace_back(address, address + length);
+        }
+        this->flush_decoded();
+        return true;
+#else
+        static_cast<void>(address);
+        static_cast<void>(descriptor);
+        static_cast<void>(offset);
+        static_cast<void>(length);
+        static_cast<void>(flags);
+        return false;
+#endif
+    }
+
+    auto Thread::unmap_host(uint64_t address, uint64_t length) noexcept -> bool
+    {
+#ifdef SUPERNOVA_GUARD_PAGES
+        const auto page = host_page_size();
+        auto *start = this->m_memory.get() + address;
+        if (this->m_memory.get_deleter().mapping == nullptr || length == 0 || length % page != 0 || address > this->m_memory_size ||
+            this->m_memory_size - address < length || reinterpret_cast<uintptr_t>(start) % page != 0)
+        {
+            return false;
         }
 
-        return {false, thread.signal()};
+        if (mmap(start, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+        {
+            return false;
+        }
+        drop_ranges(this->m_read_only, address, address + length);
+        this->flush_decoded();
+        return true;
+#else
+        static_cast<void>(address);
+        static_cast<void>(length);
+        return false;
+#endif
+    }
+
+    void Thread::cache_handler(uint64_t pcall, uint64_t handler) noexcept
+    {
+        // stores of other harts never reach this cache
+        if (this->m_memory.get_deleter().shared != nullptr)
+        {
+            return;
+        }
+
+        if (this->m_handlers == nullptr)
+        {
+            this->m_handlers.reset(new (std::nothrow) uint64_t[vector_cache_size]);
+            if (this->m_handlers == nullptr)
+            {
+                return;
+            }
+        }
+
+        if (!this->m_handlers_cached || this->m_handlers_base != this->m_int_vector)
+        {
+            std::fill_n(this->m_handlers.get(), vector_cache_size, untranslated);
+            this->m_handlers_base = this->m_int_vector;
+            this->m_handlers_cached = true;
+        }
+        this->m_handlers[pcall] = handler;
+    }
+
+    auto Thread::bind_pcall(uint64_t pcall, pcall_handler handler, void *context) noexcept -> bool
+    {
+        if (pcall >= vector_cache_size || pcall == ProcessorCall::Halt)
+        {
+            return false;
+        }
+
+        if (this->m_native == nullptr)
+        {
+            this->m_native.reset(new (std::nothrow) native_pcall[vector_cache_size]{});
+            if (this->m_native == nullptr)
+            {
+                return false;
+            }
+        }
+
+        this->m_native[pcall] = native_pcall{handler, context};
+        return true;
+    }
+
+    auto pcall_registry::bind(uint64_t pcall, pcall_handler handler, void *context) -> bool
+    {
+        if (pcall >= Thread::vector_cache_size || pcall == ProcessorCall::Halt)
+        {
+            return false;
+        }
+
+        // threads installed before may still call the old callable
+        if (this->m_functions[pcall] != nullptr)
+        {
+            this->m_retired.push_back(std::move(this->m_functions[pcall]));
+        }
+        this->m_bindings[pcall] = native_pcall{handler, context};
+        return true;
+    }
+
+    auto pcall_registry::bind(uint64_t pcall, function handler) -> bool
+    {
+        if (!handler)
+        {
+            return this->bind(pcall, nullptr);
+        }
+
+        auto owned = std::make_unique<function>(std::move(handler));
+        auto *callable = owned.get();
+        if (!this->bind(pcall, [](Thread &thread, void *context) noexcept { (*static_cast<function *>(context))(thread); }, callable))
+        {
+            return false;
+        }
+        this->m_functions[pcall] = std::move(owned);
+        return true;
+    }
+
+    auto pcall_registry::install(Thread &thread) const noexcept -> bool
+    {
+        for (uint64_t pcall = 0; pcall < Thread::vector_cache_size; ++pcall)
+        {
+            auto const &binding = this->m_bindings[pcall];
+            if (binding.handler != nullptr && !thread.bind_pcall(pcall, binding.handler, binding.context))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto pcall_registry::bound(uint64_t pcall) const noexcept -> native_pcall const *
+    {
+        if (pcall >= Thread::vector_cache_size || this->m_bindings[pcall].handler == nullptr)
+        {
+            return nullptr;
+        }
+        return &this->m_bindings[pcall];
+    }
+
+    auto Thread::reserve_blocks() noexcept -> bool
+    {
+        if (this->m_blocks != nullptr)
+        {
+            return true;
+        }
+
+        const auto line_count = (this->m_memory_size >> block_line_bits) / 64 + 1;
+        this->m_block_lines.reset(new (std::nothrow) uint64_t[line_count]{});
+        if (this->m_block_lines == nullptr)
+        {
+            return false;
+        }
+
+        this->m_blocks.reset(new (std::nothrow) decoded_block[block_cache_size]);
+        if (this->m_blocks == nullptr)
+        {
+            this->m_block_lines.reset();
+            return false;
+        }
+
+        this->m_block_line_count = line_count;
+        return true;
+    }
+
+    auto Thread::hart(uint64_t entry_point) -> Thread
+    {
+        // the first hart moves memory into shared ownership, memory itself stays in place
+        if (this->m_memory.get_deleter().shared == nullptr)
+        {
+            const auto owner = this->m_memory.get_deleter();
+            auto *memory = this->m_memory.release();
+
+            auto deleter = owner;
+            deleter.shared = std::shared_ptr<void>(memory, owner);
+            this->m_memory = std::unique_ptr<uint8_t[], memory_deleter>(memory, std::move(deleter));
+            this->m_handlers_cached = false;
+        }
+
+        auto memory = std::unique_ptr<uint8_t[], memory_deleter>(this->m_memory.get(), this->m_memory.get_deleter());
+        auto hart = Thread{std::move(memory), this->m_memory_size, this->m_model, entry_point};
+        hart.m_int_vector = this->m_int_vector;
+        hart.m_backend = this->m_backend;
+        hart.m_fusion = this->m_fusion;
+        hart.m_io = this->m_io;
+        hart.m_hosted = this->m_hosted;
+        hart.m_read_only = this->m_read_only;
+        if (this->m_native != nullptr)
+        {
+            hart.m_native.reset(new (std::nothrow) native_pcall[vector_cache_size]);
+            if (hart.m_native != nullptr)
+            {
+                std::copy_n(this->m_native.get(), vector_cache_size, hart.m_native.get());
+            }
+        }
+        static_cast<void>(hart.use_vector_width(this->m_vector_width));
+        if (this->m_paging)
+        {
+            static_cast<void>(hart.enable_paging(this->m_page_table));
+        }
+        return hart;
+    }
+
+    auto run(int argc, char **argv, Thread &thread, bool step) -> thread_return
+    {
+        thread.registers(0) = 0;
+        if (step) {
+            // the host is free to change memory between steps
+            thread.invalidate_decoded(thread.progc(), sizeof(uint64_t));
+            // guarded memory may hold host mappings only a guarded step faults on safely
+            dispatch(thread, SwitchDispatch, 1);
+            return {true, 0};
+        }
+        
+        thread.registers(Thread::pcall_1stret) = argc;
+        thread.registers(Thread::pcall_2ndret) = reinterpret_cast<uint64_t>(argv);
+
+        // code will read itself
+
+        auto result = run_for(thread, ~0LLU);
+        while (result.status == BudgetExhausted)
+        {
+            result = run_for(thread, ~0LLU);
+        }
+
+        return thread_return{result.status == ProgramEnded, result.exit_code};
+    }
+
+    auto run_for(Thread &thread, uint64_t max_instructions, dispatch_engine engine) noexcept -> run_result
+    {
+        uint64_t executed = 0;
+        while (executed < max_instructions && thread.signal() == DestroyFor::DoNotDestroy)
+        {
+            executed += dispatch(thread, engine, max_instructions - executed);
+        }
+
+        switch (thread.signal())
+        {
+        case DestroyFor::DoNotDestroy:
+            return run_result{BudgetExhausted, executed, 0};
+        case DestroyFor::ProgramEnd:
+            return run_result{ProgramEnded, executed, static_cast<int>(thread.registers(1))};
+        default:
+            return run_result{ProgramFaulted, executed, thread.signal()};
+        }
     }
 } // namespace supernova
@@ -12,8 +12,13 @@
 #pragma once
 #include <array>
 #include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iosfwd>
 #include <type_traits>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #ifndef SUPERNOVA_VERSION_MAJOR
 /** should be set if compiling with cmake, this is just a failback for lsp servers */
@@ -239,6 +244,11 @@ namespace supernova
          * implemented if the required flag is present in the model information
          * register
          *
+         * double precision operations on float registers, `fldu`/`flds` convert
+         * an unsigned/signed integer register into a float register, `fstu`/`fsts`
+         * convert back, saturating and truncating towards zero. compares write 1
+         * or 0 to an integer register, rounding immediates are reserved as 0
+         *
          * @{
          */
         flt_ldu_instrc = 0x40, /**< `fldu fr#, r#, 0` : R type */
@@ -259,8 +269,76 @@ namespace supernova
         flt_trn_instrc = 0x4F, /**< `ftrnc fr#, fr#, imm` : S type */
         /** @}*/
         /** @}*/
-        /** TODO: group 5, conditional move instructions */
-        /** TODO: group 6, memory fences */
+
+        /** group 5, conditional move instructions */
+
+        /**
+         * @defgroup InPG5 Instruction prefixes, group 5
+         * @ingroup InP
+         *
+         * @brief branchless selects, `rd` gets the source only if the condition
+         * holds and is left alone otherwise, conditions test a register against
+         * zero so they pair with the group 3 set instructions
+         *
+         * @{
+         */
+        cmovz_instrc = 0x50,   /**< `cmovz r#, r#, r#`   : R type */
+        cmovnz_instrc = 0x51,  /**< `cmovnz r#, r#, r#`  : R type */
+        cmovgs_instrc = 0x52,  /**< `cmovgs r#, r#, r#`  : R type */
+        cmovles_instrc = 0x53, /**< `cmovles r#, r#, r#` : R type */
+        cmovzi_instrc = 0x54,  /**< `cmovzi r#, r#, imm` : S type */
+        cmovnzi_instrc = 0x55, /**< `cmovnzi r#, r#, imm`: S type */
+        /** @}*/
+
+        /** group 6, atomic memory accesses and memory fences */
+
+        /**
+         * @defgroup InPG6 Instruction prefixes, group 6
+         * @ingroup InP
+         *
+         * @brief lets harts sharing memory synchronize, every access is on an
+         * aligned double word, read-modify-write instructions are sequentially
+         * consistent
+         *
+         * @{
+         */
+        ld_acq_instrc = 0x60,    /**< `ldacq r#, r#, imm` : S type */
+        st_rel_instrc = 0x61,    /**< `strel r#, r#, imm` : S type */
+        cas_instrc = 0x62,       /**< `cas r#, r#, r#`    : R type */
+        xchg_instrc = 0x63,      /**< `xchg r#, r#, r#`   : R type */
+        xadd_instrc = 0x64,      /**< `xadd r#, r#, r#`   : R type */
+        fence_acq_instrc = 0x65, /**< `fenceacq`          : R type */
+        fence_rel_instrc = 0x66, /**< `fencerel`          : R type */
+        fence_acr_instrc = 0x67, /**< `fenceacr`          : R type */
+        fence_seq_instrc = 0x68, /**< `fenceseq`          : R type */
+        /** @}*/
+
+        /** group 7, vector instructions */
+
+        /**
+         * @defgroup InPG7 Instruction prefixes, group 7
+         * @ingroup InP
+         *
+         * @brief lane-wise operations on vector registers, lanes are double
+         * words and a vector is as wide as the `confflags_multi*` flags say,
+         * from 64 up to 512 bits. compares set lanes to all ones when true
+         *
+         * @{
+         */
+        vld_instrc = 0x70,   /**< `vld vr#, r#, imm`     : S type */
+        vst_instrc = 0x71,   /**< `vst vr#, r#, imm`     : S type */
+        vadd_instrc = 0x72,  /**< `vadd vr#, vr#, vr#`   : R type */
+        vsub_instrc = 0x73,  /**< `vsub vr#, vr#, vr#`   : R type */
+        vmul_instrc = 0x74,  /**< `vmul vr#, vr#, vr#`   : R type */
+        vand_instrc = 0x75,  /**< `vand vr#, vr#, vr#`   : R type */
+        vor_instrc = 0x76,   /**< `vor vr#, vr#, vr#`    : R type */
+        vxor_instrc = 0x77,  /**< `vxor vr#, vr#, vr#`   : R type */
+        vceq_instrc = 0x78,  /**< `vceq vr#, vr#, vr#`   : R type */
+        vcgtu_instrc = 0x79, /**< `vcgtu vr#, vr#, vr#`  : R type */
+        vcgts_instrc = 0x7A, /**< `vcgts vr#, vr#, vr#`  : R type */
+        vbrd_instrc = 0x7B,  /**< `vbrd vr#, r#`         : R type */
+        vext_instrc = 0x7C,  /**< `vext r#, vr#, imm`    : S type */
+        /** @}*/
     };
 
     /**
@@ -597,6 +675,187 @@ namespace supernova
         uint64_t m_instruction{0};
     };
 
+    /**
+     * @brief layouts an instruction can be encoded as
+     */
+    enum instruction_format : uint8_t
+    {
+        rformat, /**< register-register-register */
+        sformat, /**< register-register-immediate */
+        lformat, /**< register-immediate */
+    };
+
+    /**
+     * @brief get the layout used by an opcode
+     *
+     * @param opcode opcode to check
+     *
+     * @return layout used by the opcode, reserved opcodes follow the layout
+     * of the slot they are reserved in
+     */
+    [[nodiscard, gnu::const]] constexpr auto format_of(inspx opcode) noexcept -> instruction_format
+    {
+        switch (opcode)
+        {
+        case jal_instrc:
+        case lui_instrc:
+        case auipc_instrc:
+        case pcall_instrc:
+            return lformat;
+        default:
+            break;
+        }
+
+        // group 2 is all S type besides `jal`
+        if ((opcode & 0xF0U) == 0x20U)
+        {
+            return sformat;
+        }
+
+        // group 6 atomic loads and stores address memory like group 2
+        if (opcode == ld_acq_instrc || opcode == st_rel_instrc)
+        {
+            return sformat;
+        }
+
+        // group 5 moves an immediate in place of a register
+        if (opcode == cmovzi_instrc || opcode == cmovnzi_instrc)
+        {
+            return sformat;
+        }
+
+        // group 7 vector loads, stores and lane extraction take an immediate
+        if (opcode == vld_instrc || opcode == vst_instrc || opcode == vext_instrc)
+        {
+            return sformat;
+        }
+
+        // group 4 rounding instructions take an immediate
+        if (opcode >= flt_rou_instrc && opcode <= flt_trn_instrc)
+        {
+            return sformat;
+        }
+
+        if (opcode >= flt_ldu_instrc)
+        {
+            return rformat;
+        }
+
+        // groups 0, 1 and 3 alternate between register and immediate forms
+        return (opcode & 1U) != 0 ? sformat : rformat;
+    }
+
+    /**
+     * @brief instruction with its fields already extracted
+     *
+     * decoding is done once per instruction so the interpreter does not need
+     * to rebuild the R/S/L views and sign extend immediates every time the
+     * same address is executed
+     *
+     * Size : 32 bytes
+     */
+    struct decoded_instruction
+    {
+        /** tag used by entries that hold no instruction, never a valid aligned address */
+        static const constexpr auto invalid_address = ~0LLU;
+
+        /** address this instruction was decoded from */
+        uint64_t address{invalid_address};
+
+        /** immediate, sign extended according to the instruction format */
+        int64_t imm{0};
+
+        /** immediate, without sign extension */
+        uint64_t uimm{0};
+
+        /** instruction opcode */
+        inspx opcode{andr_instrc};
+
+        /** first register index */
+        uint8_t r1{0};
+
+        /** second register index, only used by R instructions */
+        uint8_t r2{0};
+
+        /** destination register index, unused by L instructions */
+        uint8_t rd{0};
+    };
+
+    /**
+     * @brief extract all fields from a raw instruction
+     *
+     * @param raw raw instruction value
+     * @param address address the instruction was read from
+     *
+     * @return decoded instruction
+     */
+    [[nodiscard]] constexpr auto decode(uint64_t raw, uint64_t address = decoded_instruction::invalid_address) noexcept -> decoded_instruction
+    {
+        decoded_instruction decoded{};
+        decoded.address = address;
+        decoded.opcode = RInstruction(raw).opcode();
+
+        switch (format_of(decoded.opcode))
+        {
+        case rformat:
+        {
+            const auto rinstr = RInstruction(raw);
+            decoded.r1 = rinstr.r1();
+            decoded.r2 = rinstr.r2();
+            decoded.rd = rinstr.rd();
+            break;
+        }
+        case sformat:
+        {
+            const auto sinstr = SInstruction(raw);
+            decoded.r1 = sinstr.r1();
+            decoded.rd = sinstr.rd();
+            decoded.imm = sinstr.imm();
+            decoded.uimm = sinstr.uimm();
+            break;
+        }
+        case lformat:
+        {
+            const auto linstr = LInstruction(raw);
+            decoded.r1 = linstr.r1();
+            decoded.imm = linstr.imm();
+            decoded.uimm = linstr.uimm();
+            break;
+        }
+        }
+
+        return decoded;
+    }
+
+    /**
+     * @brief straight line of decoded instructions, ending at the first
+     * jump, call, return or processor call
+     *
+     * blocks keep a link to the block each of their exits went to last,
+     * links are checked against the block tag before being followed, so
+     * dropping a block never needs to touch the ones linking to it
+     */
+    struct decoded_block
+    {
+        /** most instructions a block holds, longer runs are split */
+        static const constexpr auto max_length = 32;
+
+        /** address of the first instruction, `decoded_instruction::invalid_address` on empty entries */
+        uint64_t address{decoded_instruction::invalid_address};
+
+        /** address right after the last instruction */
+        uint64_t end{decoded_instruction::invalid_address};
+
+        /** amount of instructions */
+        uint64_t length{0};
+
+        /** block the fall through (0) and the jump (1) went to last time */
+        std::array<decoded_block *, 2> exits{};
+
+        /** instructions, in program order */
+        std::array<decoded_instruction, max_length> instructions{};
+    };
+
     /**
      * @brief first configuration register, readonly
      */
@@ -618,7 +877,8 @@ namespace supernova
         confflags_hosted     = 0x2000  /**< supports hosted environment functions */
     };
 
-    constexpr uint64_t config_value = confflags_stack | confflags_intdiv | confflags_hosted | confflags_ioint;
+    constexpr uint64_t config_value = confflags_paging | confflags_stack | confflags_intdiv | confflags_floats | confflags_fences | confflags_condmove |
+                                      confflags_hosted | confflags_ioint;
     constexpr uint64_t int_count = 0xFFFFFFFFFFFFEU; // 2^52 - 2
 
     struct thread_model_t
@@ -645,6 +905,249 @@ namespace supernova
         uint64_t last_instruction_index;
     };
 
+    /** widest vector group 7 instructions work on, in bytes */
+    constexpr uint64_t max_vector_width = 64;
+
+    /**
+     * @brief vector register, only the first `Thread::vector_width` bytes are used
+     */
+    struct vector_register
+    {
+        alignas(max_vector_width) std::array<uint64_t, max_vector_width / sizeof(uint64_t)> lanes{}; /**< double word lanes */
+    };
+
+    /**
+     * @brief lane-wise group 7 operation, specialized for a single vector width
+     *
+     * takes the opcode, the destination and both sources, `vadd_instrc` to `vcgts_instrc`
+     */
+    using vector_kernel = void (*)(inspx, vector_register &, vector_register const &, vector_register const &) noexcept;
+
+    /**
+     * @brief get the widest vector the host runs natively
+     *
+     * picked once from the host cpu features, 64 bytes with AVX-512, 32 with
+     * AVX2, 16 with SSE2 (or any other host the compiler vectorizes for) and
+     * 8 bytes, a single lane, everywhere else
+     *
+     * @return vector width in bytes
+     */
+    [[nodiscard]] auto host_vector_width() noexcept -> uint64_t;
+
+    /**
+     * @brief get the operations for a vector width
+     * @param width vector width in bytes, a power of two from 8 up to `host_vector_width()`
+     * @return kernel for the width, `nullptr` if the host is not able to run it
+     */
+    [[nodiscard]] auto vector_kernel_for(uint64_t width) noexcept -> vector_kernel;
+
+    /**
+     * @brief get the configuration flags with the vector widths a thread supports
+     * @param vector_width widest vector in bytes
+     * @return `config_value` ored with `confflags_multi64` up to the flag for `vector_width`
+     */
+    [[nodiscard]] auto config_flags(uint64_t vector_width = host_vector_width()) noexcept -> uint64_t;
+
+    /** page table levels used by threads without a model */
+    constexpr uint64_t default_page_levels = 3;
+
+    /** page size used by threads without a model */
+    constexpr uint64_t default_page_size = 0x1000;
+
+    /**
+     * @brief get the log2 of the page size a thread model asks for
+     *
+     * pages need to be a power of two holding at least 8 entries, and the
+     * levels need to fit inside a 64 bit address
+     *
+     * @param model thread model, `nullptr` for the default one
+     *
+     * @return log2 of the page size, 0 if the model has no usable paging
+     */
+    [[nodiscard]] constexpr auto page_bits_of(thread_model_t const *model) noexcept -> uint64_t
+    {
+        const auto levels = model != nullptr ? model->page_level : default_page_levels;
+        const auto size = model != nullptr ? model->page_size : default_page_size;
+
+        uint64_t bits = 0;
+        while (bits < 63 && (1ULL << bits) < size)
+        {
+            ++bits;
+        }
+
+        if (levels == 0 || bits < 6 || (1ULL << bits) != size || levels > (64 - bits) / (bits - 3))
+        {
+            return 0;
+        }
+        return bits;
+    }
+
+    /**
+     * @brief permissions on a page table entry
+     *
+     * same bits as `headers::memory_flags`, an entry without any of them is
+     * not present
+     */
+    enum page_access : uint8_t
+    {
+        PageRead = 0x01,    /**< page can be read */
+        PageWrite = 0x02,   /**< page can be written */
+        PageExecute = 0x04, /**< instructions can be fetched from the page */
+    };
+
+    /**
+     * @brief translation cached by the software TLB
+     */
+    struct tlb_entry
+    {
+        /** virtual page number, `~0` on empty entries */
+        uint64_t page{~0LLU};
+
+        /** address of the page on thread memory */
+        uint64_t frame{0};
+
+        /** `page_access` bits of the page */
+        uint8_t access{0};
+    };
+
+    /**
+     * @brief counters kept by the interpreter, only filled when built with `SUPERNOVA_STATS`
+     *
+     * instructions ran as native code by `jit` or `aot` are not counted
+     */
+    struct execution_stats
+    {
+        /** conditional jumps, `je` to `jles` */
+        static const constexpr auto branch_count = 6;
+
+        /** access widths, bytes to double words */
+        static const constexpr auto width_count = 4;
+
+        /** processor calls, `Functions` then every one the interrupt vector holds, `Thread::vector_cache_size` */
+        static const constexpr auto pcall_count = 1 + 128;
+
+        /** instruction pairs the interpreter runs as a single superinstruction */
+        static const constexpr auto fusion_count = 14;
+
+        std::array<uint64_t, 256> opcodes{};            /**< executions per opcode */
+        std::array<uint64_t, branch_count> taken{};     /**< taken conditional jumps, indexed from `je` */
+        std::array<uint64_t, branch_count> not_taken{}; /**< conditional jumps that fell through, indexed from `je` */
+        std::array<uint64_t, width_count> loads{};      /**< loads by log2 of their width */
+        std::array<uint64_t, width_count> stores{};     /**< stores by log2 of their width */
+        std::array<uint64_t, pcall_count> pcalls{};     /**< processor calls, indexed by `ProcessorCall + 1` */
+        std::array<uint64_t, fusion_count> fused{};     /**< pairs that ran as a superinstruction, halves are also in `opcodes` */
+    };
+
+#ifdef SUPERNOVA_STATS
+    /** set when the interpreter keeps `execution_stats` */
+    constexpr bool stats_enabled = true;
+#else
+    /** set when the interpreter keeps `execution_stats` */
+    constexpr bool stats_enabled = false;
+#endif
+
+    /**
+     * @brief ways to write `execution_stats`
+     */
+    enum stats_format : uint8_t
+    {
+        StatsTable, /**< aligned columns, for people */
+        StatsJson,  /**< a single JSON object, for tools */
+    };
+
+    /**
+     * @brief write counters, leaving out the ones that are zero
+     *
+     * @param output stream to write to
+     * @param stats counters to write
+     * @param format how to write them
+     */
+    void write_stats(std::ostream &output, execution_stats const &stats, stats_format format);
+
+    /**
+     * @brief get the page size `Thread::map_host` aligns to
+     * @return host page size in bytes, 0 if the host is not able to map memory
+     */
+    [[nodiscard]] auto host_page_size() noexcept -> uint64_t;
+
+    /**
+     * @brief get how far guarded memory reaches before its first guard page
+     *
+     * memory size rounded up to a double word, so memory starts aligned for
+     * atomics wherever it ends; accesses past the memory size are sent to
+     * this offset to fault
+     *
+     * @param memory_size thread memory size
+     * @return offset of the first guard page from the start of memory
+     */
+    [[nodiscard]] constexpr auto guarded_size(uint64_t memory_size) noexcept -> uint64_t
+    {
+        return (memory_size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+    }
+
+    /**
+     * @brief ways a thread can keep its memory
+     */
+    enum memory_backend : uint8_t
+    {
+        CheckedMemory, /**< heap allocation, every access is compared against the memory size */
+        GuardedMemory, /**< mapping followed by guard pages, out of range accesses fault on the host */
+    };
+
+    /**
+     * @brief releases thread memory, either from the heap or from a guarded mapping
+     */
+    struct memory_deleter
+    {
+        void *mapping{nullptr};         /**< start of the mapping, `nullptr` for heap memory */
+        uint64_t length{0};             /**< length of the mapping, guard pages included */
+        bool guarded{false};            /**< memory ends right before an inaccessible page */
+        std::shared_ptr<void> shared{}; /**< owns memory shared between harts, released with the last of them */
+
+        /** heap memory, released with `delete[]` */
+        constexpr memory_deleter() noexcept = default;
+
+        /** heap memory, lets `std::unique_ptr<uint8_t[]>` convert to thread memory */
+        constexpr memory_deleter(std::default_delete<uint8_t[]> /*unused*/) noexcept {} // NOLINT: implicit on purpose
+
+        /**
+         * @brief memory inside a mapping
+         * @param map start of the mapping
+         * @param size length of the mapping
+         * @param guard true if the byte after memory is on an inaccessible page
+         */
+        constexpr memory_deleter(void *map, uint64_t size, bool guard = false) noexcept : mapping{map}, length{size}, guarded{guard} {}
+
+        /**
+         * @brief release memory
+         * @param memory pointer to the first byte of memory
+         */
+        void operator()(uint8_t *memory) const noexcept;
+    };
+
+    class Thread;
+    class thread_snapshot;
+    class io_bus;
+    class hosted_ring;
+
+    /**
+     * @brief native handler bound to a processor call, see `Thread::bind_pcall`
+     *
+     * runs in place of the guest handler: nothing is pushed, `pcall()` is
+     * left alone and execution goes on past the instruction that raised it
+     * unless the handler moves `progc()`
+     */
+    using pcall_handler = void (*)(Thread &thread, void *context) noexcept;
+
+    /**
+     * @brief processor call bound to a native handler
+     */
+    struct native_pcall
+    {
+        pcall_handler handler{nullptr}; /**< handler, `nullptr` when unbound */
+        void *context{nullptr};         /**< passed to the handler */
+    };
+
     /**
      * @brief defines a thread that will run vm code
      *
@@ -678,9 +1181,48 @@ namespace supernova
         /** register to push invalid opcode into before calling the required invalid opcode */
         static const constexpr auto pcall_invopc = 14;
 
+        /** register to put the faulting address into before calling the page fault handler */
+        static const constexpr auto pcall_pfaddr = 14;
+
         /** count all registers inside the processor */
         static const constexpr auto register_count = 16;
 
+        /** amount of entries on the decoded instruction cache, needs to be a power of two */
+        static const constexpr auto decoded_cache_size = 1024;
+
+        /** amount of entries on the basic block cache, needs to be a power of two */
+        static const constexpr auto block_cache_size = 256;
+
+        /** log2 of the granularity writes are checked against cached blocks with */
+        static const constexpr auto block_line_bits = 6U;
+
+        /** log2 of the granularity writes are checked against decoded instructions with */
+        static const constexpr auto decoded_line_bits = 9U;
+
+        /** count all float registers */
+        static const constexpr auto float_count = 16;
+
+        /** count all vector registers */
+        static const constexpr auto vector_count = 16;
+
+        /** amount of entries on the software TLB, needs to be a power of two */
+        static const constexpr auto tlb_size = 64;
+
+        /** returned by `translate` for addresses that can not be accessed */
+        static const constexpr auto untranslated = ~0LLU;
+
+        /** processor calls whose handlers are cached and that can be bound to native handlers, every non negative one */
+        static const constexpr auto vector_cache_size = 128;
+
+        /** log2 of the page size used to track pages holding translated code */
+        static const constexpr auto code_page_bits = 12U;
+
+        /** code page state: page holds translated code */
+        static const constexpr uint8_t code_page_translated = 1;
+
+        /** code page state: page held translated code and got written to */
+        static const constexpr uint8_t code_page_written = 2;
+
         /**
          * @brief initalize a thread
          * 
@@ -688,8 +1230,13 @@ namespace supernova
          * @param memory_size size of memory in bytes
          * @param model thread information
         */
-        Thread(std::unique_ptr<uint8_t[]> memory, uint64_t memory_size, struct thread_model_t *model, uint64_t entry_point = 0)
-            : m_memory{std::move(memory)}, m_program_counter{entry_point}, m_memory_size{memory_size}, m_model{model}
+        Thread(std::unique_ptr<uint8_t[], memory_deleter> memory, uint64_t memory_size, struct thread_model_t *model, uint64_t entry_point = 0)
+            : m_memory{std::move(memory)}, m_program_counter{entry_point}, m_memory_size{memory_size}, m_model{model},
+              m_decoded{std::make_unique<decoded_instruction[]>(decoded_cache_size)},
+              m_decoded_lines{std::make_unique<uint64_t[]>((memory_size >> decoded_line_bits) / 64 + 1)},
+              m_decoded_line_count{(memory_size >> decoded_line_bits) / 64 + 1}, m_page_bits{page_bits_of(model)},
+              m_vectors{std::make_unique<vector_register[]>(vector_count)}, m_vector_width{host_vector_width()},
+              m_vector_kernel{vector_kernel_for(m_vector_width)}
         {
         }
 
@@ -707,259 +1254,1973 @@ namespace supernova
         [[nodiscard]] constexpr auto allregs() noexcept -> auto& { return this->m_registers; }
 
         /**
-         * @brief get the program counter register
-         * @return program counter reference
+         * @brief get a float register by index
+         * @param index index of the float register
+         * @return reference of the float register on given index
          */
-        [[nodiscard]] constexpr auto progc() noexcept -> auto& { return this->m_program_counter; }
+        [[nodiscard]] constexpr auto floats(std::size_t index) noexcept -> double & { return this->m_floats[index]; }
 
         /**
-         * @brief get the interrupt vector register
-         * @return interrupt vector reference
+         * @brief get a vector register by index
+         * @param index index of the vector register
+         * @return reference of the vector register on given index
          */
-        [[nodiscard]] constexpr auto intvec() noexcept -> auto& { return this->m_int_vector; }
+        [[nodiscard]] auto vectors(std::size_t index) noexcept -> vector_register & { return this->m_vectors[index]; }
 
         /**
-         * @brief get the size of the memory in bytes
-         * @return memory byte size
+         * @brief get how wide group 7 instructions work
+         * @return vector width in bytes
          */
-        [[nodiscard]] constexpr auto memsize() const noexcept -> auto { return this->m_memory_size; }
+        [[nodiscard]] constexpr auto vector_width() const noexcept -> uint64_t { return this->m_vector_width; }
 
         /**
-         * @brief get the pointer to the working memory region
-         * @return memory pointer
-         *
-         * @note `fetch` is not implemented as a member function as it requires processor calls
+         * @brief get the lane-wise operations for the current vector width
+         * @return kernel picked for `vector_width`
          */
-        [[nodiscard]] constexpr auto memory() noexcept -> auto& { return this->m_memory; }
+        [[nodiscard]] constexpr auto vector_operations() const noexcept -> vector_kernel { return this->m_vector_kernel; }
 
         /**
-         * @brief get the model information register
-         * @return model information register value
+         * @brief narrow group 7 instructions, the widest the host supports is the default
+         * @param width vector width in bytes, a power of two from 8 up to `host_vector_width()`
+         * @return false if the host is not able to run that width, nothing changes then
          */
-        [[nodiscard]] constexpr auto model() const noexcept -> auto { return this->m_model; }
+        auto use_vector_width(uint64_t width) noexcept -> bool
+        {
+            const auto kernel = vector_kernel_for(width);
+            if (kernel == nullptr)
+            {
+                return false;
+            }
+            this->m_vector_width = width;
+            this->m_vector_kernel = kernel;
+            return true;
+        }
 
         /**
-         * @brief get the current processor call status
-         * @return processor call reference
+         * @brief get the program counter register
+         * @return program counter reference
          */
-        [[nodiscard]] constexpr auto pcall() noexcept -> auto& { return this->m_pcall; }
+        [[nodiscard]] constexpr auto progc() noexcept -> auto& { return this->m_program_counter; }
 
         /**
-         * @brief get the current processor signal
-         * @return processor signal reference
-         */
+         * @brief get the interrupt vector register
+         * @return interrupt vector reference
+         */
+        [[nodiscard]] constexpr auto intvec() noexcept -> auto& { return this->m_int_vector; }
+
+        /**
+         * @brief get the handler of a processor call cached from the interrupt vector
+         *
+         * entries are dropped when `intvec` changes or the guest writes over
+         * them, host writes through `memory()` need `flush_decoded`. harts
+         * sharing memory never cache, another hart may rewrite the vector
+         *
+         * @param pcall processor call, below `vector_cache_size`
+         * @return handler address, `untranslated` when not cached
+         */
+        [[nodiscard]] auto cached_handler(uint64_t pcall) const noexcept -> uint64_t
+        {
+            if (!this->m_handlers_cached || this->m_handlers_base != this->m_int_vector)
+            {
+                return untranslated;
+            }
+            return this->m_handlers[pcall];
+        }
+
+        /**
+         * @brief remember the handler of a processor call, read from the interrupt vector
+         * @param pcall processor call, below `vector_cache_size`
+         * @param handler handler address
+         */
+        void cache_handler(uint64_t pcall, uint64_t handler) noexcept;
+
+        /**
+         * @brief run a native handler in place of the guest one for a processor call
+         *
+         * bindings carry over to harts, snapshots leave them behind
+         *
+         * @param pcall processor call, below `vector_cache_size` and not `Halt`
+         * @param handler handler, `nullptr` gives the processor call back to the guest
+         * @param context passed to the handler
+         * @return false if the processor call can not be bound
+         */
+        auto bind_pcall(uint64_t pcall, pcall_handler handler, void *context = nullptr) noexcept -> bool;
+
+        /**
+         * @brief get the native handler bound to a processor call
+         * @param pcall any processor call
+         * @return binding, `nullptr` if the guest handles it
+         */
+        [[nodiscard]] auto bound_pcall(ProcessorCall pcall) const noexcept -> native_pcall const *
+        {
+            if (this->m_native == nullptr || pcall < 0 || this->m_native[pcall].handler == nullptr)
+            {
+                return nullptr;
+            }
+            return &this->m_native[pcall];
+        }
+
+        /**
+         * @brief get the size of the memory in bytes
+         * @return memory byte size
+         */
+        [[nodiscard]] constexpr auto memsize() const noexcept -> auto { return this->m_memory_size; }
+
+        /**
+         * @brief get the pointer to the working memory region
+         * @return memory pointer
+         *
+         * @note `fetch` is not implemented as a member function as it requires processor calls
+         */
+        [[nodiscard]] constexpr auto memory() noexcept -> auto& { return this->m_memory; }
+
+        /**
+         * @brief get how the thread memory is kept
+         * @return memory backend in use
+         */
+        [[nodiscard]] constexpr auto backend() const noexcept -> memory_backend { return this->m_backend; }
+
+        /**
+         * @brief move memory into a mapping followed by guard pages
+         *
+         * the end of the memory gets aligned to the first guard page, so any
+         * access crossing the memory size faults on the host, that fault is
+         * then turned into a `MemoryLimit` processor call, letting loads and
+         * stores skip the bounds check
+         *
+         * @return true if the thread now uses `GuardedMemory`, false if the
+         * host is not able to, memory is left untouched in that case
+         */
+        auto use_guard_pages() noexcept -> bool;
+
+        /**
+         * @brief map a host descriptor over a range of memory, without copying it
+         *
+         * files, `memfd`s and shared memory segments are mapped shared, guest
+         * writes reach them and host writes are seen by the guest. memory has
+         * to be in guard pages already (see `use_guard_pages`), so nothing
+         * holding a pointer to it is left behind; accesses the flags do not
+         * allow, or past the end of a file, raise `MemoryLimit` like accesses
+         * past memory do. ranges have to stay readable, and can only be left
+         * without write access while neither translated code nor a hosted
+         * ring is attached (see `read_only`). other harts need `flush_decoded`
+         *
+         * @param address start of the range, a whole number of host pages before the end of memory
+         * @param descriptor host descriptor, the caller keeps it
+         * @param offset offset inside the descriptor, page aligned
+         * @param length bytes to map, a multiple of the host page size
+         * @param flags `headers::memory_flags` allowed on the range, `mem_execute` only needs reading
+         *
+         * @return false if memory is not guarded, the range is misaligned or
+         * out of memory, the flags are not allowed right now or the host is
+         * not able to map the descriptor, memory is left untouched in that case
+         */
+        auto map_host(uint64_t address, int descriptor, uint64_t offset, uint64_t length, uint8_t flags) noexcept -> bool;
+
+        /**
+         * @brief give a range back zeroed private memory, dropping what `map_host` put there
+         * @param address start of the range, on a host page
+         * @param length bytes to release, a multiple of the host page size
+         * @return false if the range is misaligned, out of memory or memory is not a mapping
+         */
+        auto unmap_host(uint64_t address, uint64_t length) noexcept -> bool;
+
+        /**
+         * @brief get the ranges `map_host` left without write access
+         *
+         * stores there only fault safely through the interpreter, translated
+         * code and anything else writing memory directly has to stay off them
+         *
+         * @return first byte and end of each range, in mapping order
+         */
+        [[nodiscard]] auto read_only() const noexcept -> std::vector<std::pair<uint64_t, uint64_t>> const & { return this->m_read_only; }
+
+        /**
+         * @brief save the thread state, to start new threads from it later
+         *
+         * memory is copied once into the snapshot, caches and translated
+         * code are not part of it
+         *
+         * @return snapshot of registers, processor call state and memory
+         */
+        [[nodiscard]] auto snapshot() const -> thread_snapshot;
+
+        /**
+         * @brief start a new thread from a snapshot
+         *
+         * memory is shared copy-on-write with the snapshot when the host
+         * allows it, so starting a thread only costs the pages it writes to
+         *
+         * @param snapshot snapshot to start from, can be used any amount of times
+         * @return thread with the same state as the snapshot
+         */
+        [[nodiscard]] static auto fork_from(thread_snapshot const &snapshot) -> Thread;
+
+        /**
+         * @brief start another hart running over the same memory
+         *
+         * memory stays alive until the last hart sharing it goes away, every
+         * hart keeps its own registers, processor call state and caches, so
+         * code written by one hart is only seen by others after `flush_decoded`
+         *
+         * harts are able to run on different host threads at the same time,
+         * group 6 instructions are the only way for them to synchronize
+         *
+         * @param entry_point address the new hart starts from
+         * @return thread sharing memory, model and interrupt vector with this one
+         */
+        [[nodiscard]] auto hart(uint64_t entry_point) -> Thread;
+
+        /**
+         * @brief get the model information register
+         * @return model information register value
+         */
+        [[nodiscard]] constexpr auto model() const noexcept -> auto { return this->m_model; }
+
+        /**
+         * @brief check if accesses go through page tables
+         * @return true once `enable_paging` succeeded
+         */
+        [[nodiscard]] constexpr auto paging() const noexcept -> bool { return this->m_paging; }
+
+        /**
+         * @brief get the page table register
+         * @return address of the root table on thread memory
+         */
+        [[nodiscard]] constexpr auto page_table() const noexcept -> uint64_t { return this->m_page_table; }
+
+        /**
+         * @brief get how many page table levels addresses go through
+         * @return amount of levels, 0 if the model has no usable paging
+         */
+        [[nodiscard]] constexpr auto page_levels() const noexcept -> uint64_t
+        {
+            if (this->m_page_bits == 0)
+            {
+                return 0;
+            }
+            return this->m_model != nullptr ? this->m_model->page_level : default_page_levels;
+        }
+
+        /**
+         * @brief get the page size
+         * @return page size in bytes, 0 if the model has no usable paging
+         */
+        [[nodiscard]] constexpr auto page_size() const noexcept -> uint64_t { return this->m_page_bits != 0 ? 1ULL << this->m_page_bits : 0; }
+
+        /**
+         * @brief start translating every access through page tables
+         *
+         * tables are a page of double words each, indexed by the virtual
+         * address from the highest level down, entries hold the address of
+         * the next table (or of the page, on the last level) ored with its
+         * `page_access` bits. only the last level permissions are checked
+         *
+         * @param root address of the root table on thread memory
+         * @return false if the model has no usable paging or the TLB could not be allocated
+         *
+         * @note the TLB does not see writes to the tables, `flush_tlb` needs
+         * to be called after changing them
+         */
+        auto enable_paging(uint64_t root) noexcept -> bool;
+
+        /**
+         * @brief go back to accessing thread memory directly
+         */
+        void disable_paging() noexcept;
+
+        /**
+         * @brief drop every cached translation, along with every cached instruction
+         */
+        void flush_tlb() noexcept;
+
+        /**
+         * @brief drop the cached translation of a single page
+         * @param address any address inside the page
+         */
+        void flush_tlb(uint64_t address) noexcept;
+
+        /**
+         * @brief translate a virtual address, only valid while `paging` is on
+         * @param address virtual address
+         * @param access `page_access` bits the access needs
+         * @return address on thread memory, `untranslated` if the page is missing or lacks permissions
+         */
+        [[nodiscard]] auto translate(uint64_t address, uint8_t access) noexcept -> uint64_t
+        {
+            const auto page = address >> this->m_page_bits;
+            auto const &entry = this->m_tlb[page & (tlb_size - 1)];
+            if (entry.page == page && (entry.access & access) == access)
+            {
+                return entry.frame | (address & ((1ULL << this->m_page_bits) - 1));
+            }
+            return this->walk_pages(address, access);
+        }
+
+        /**
+         * @brief get the current processor call status
+         * @return processor call reference
+         */
+        [[nodiscard]] constexpr auto pcall() noexcept -> auto& { return this->m_pcall; }
+
+        /**
+         * @brief get the current processor signal
+         * @return processor signal reference
+         */
         [[nodiscard]] constexpr auto signal() noexcept -> auto& { return this->m_signal; }
 
+#ifdef SUPERNOVA_STATS
+        /**
+         * @brief get the interpreter counters
+         * @return counters reference, the host is free to reset them
+         */
+        [[nodiscard]] constexpr auto stats() noexcept -> execution_stats & { return this->m_stats; }
+#endif
+
+        /**
+         * @brief get the decoded instruction cache entry an address maps to
+         * @param address address of the instruction
+         * @return cache entry reference, its tag needs to be checked against `address`
+         */
+        [[nodiscard]] auto decoded(uint64_t address) noexcept -> decoded_instruction &
+        {
+            return this->m_decoded[(address / sizeof(uint64_t)) & (decoded_cache_size - 1)];
+        }
+
+        /**
+         * @brief remember which lines a decoded entry reaches, so writes to them drop it
+         * @param address address the entry was decoded from
+         */
+        void track_decoded(uint64_t address) noexcept
+        {
+            // entries reach into the next word, a fused pair reads it
+            constexpr auto span = 2 * sizeof(uint64_t);
+            for (auto line = address >> decoded_line_bits; line <= (address + span - 1) >> decoded_line_bits && line / 64 < this->m_decoded_line_count; ++line)
+            {
+                this->m_decoded_lines[line / 64] |= 1ULL << (line % 64);
+            }
+        }
+
+        /**
+         * @brief drop cached instructions overlapping a written memory range
+         *
+         * entries can be fused with the instruction after them, so entries
+         * ending right before the range are dropped too. writes to lines no
+         * instruction was decoded from skip the cache
+         *
+         * @param address first byte written
+         * @param size amount of bytes written
+         */
+        void invalidate_decoded(uint64_t address, uint64_t size) noexcept
+        {
+            constexpr auto word_mask = ~(sizeof(uint64_t) - 1);
+            constexpr auto span = 2 * sizeof(uint64_t);
+            const auto last = address + size;
+
+            // virtual addresses past memory have no bit, writes to them always look for entries
+            auto cached = false;
+            for (auto line = address >> decoded_line_bits; !cached && line <= (last - 1) >> decoded_line_bits; ++line)
+            {
+                cached = line / 64 >= this->m_decoded_line_count || ((this->m_decoded_lines[line / 64] >> (line % 64)) & 1U) != 0;
+            }
+
+            // unaligned instructions live on the slot of the word they start in,
+            // so two words before the range can also reach into it
+            auto word = address & word_mask;
+            word = word >= span ? word - span : 0;
+
+            for (; cached && word < last; word += sizeof(uint64_t))
+            {
+                auto &entry = this->decoded(word);
+                if ((entry.address & word_mask) == word && entry.address < last && entry.address + span > address)
+                {
+                    entry.address = decoded_instruction::invalid_address;
+                }
+            }
+
+            // the interrupt vector may sit anywhere on the address space, compare without overflowing
+            constexpr auto vector_span = vector_cache_size * sizeof(uint64_t);
+            if (this->m_handlers_cached &&
+                (address >= this->m_handlers_base ? address - this->m_handlers_base < vector_span : this->m_handlers_base - address < size))
+            {
+                this->m_handlers_cached = false;
+            }
+
+            if (this->m_block_lines != nullptr)
+            {
+                this->invalidate_blocks(address, size);
+            }
+        }
+
+        /**
+         * @brief allocate the basic block cache, `BlockDispatch` does it the first time it runs
+         * @return true if the cache is there, false if it could not be allocated
+         */
+        auto reserve_blocks() noexcept -> bool;
+
+        /**
+         * @brief get the basic block cache entry an address maps to
+         * @param address address of the first instruction of the block
+         * @return cache entry reference, its tag needs to be checked against `address`
+         *
+         * @note only valid once `reserve_blocks` returned true
+         */
+        [[nodiscard]] auto block(uint64_t address) noexcept -> decoded_block &
+        {
+            return this->m_blocks[(address / sizeof(uint64_t)) & (block_cache_size - 1)];
+        }
+
+        /**
+         * @brief remember which lines a block was decoded from, so writes to them drop it
+         * @param block block just decoded
+         */
+        void track_block(decoded_block const &block) noexcept
+        {
+            // virtual addresses past memory have no bit, writes to them always look for blocks
+            for (auto line = block.address >> block_line_bits; line <= (block.end - 1) >> block_line_bits && line / 64 < this->m_block_line_count; ++line)
+            {
+                this->m_block_lines[line / 64] |= 1ULL << (line % 64);
+            }
+        }
+
+        /**
+         * @brief drop cached blocks overlapping a written memory range
+         *
+         * writes to lines no block was decoded from return right away
+         *
+         * @param address first byte written
+         * @param size amount of bytes written
+         */
+        void invalidate_blocks(uint64_t address, uint64_t size) noexcept
+        {
+            constexpr auto word_mask = ~(sizeof(uint64_t) - 1);
+            constexpr auto span = decoded_block::max_length * sizeof(uint64_t);
+            const auto last = address + size;
+
+            auto written = false;
+            for (auto line = address >> block_line_bits; line <= (last - 1) >> block_line_bits; ++line)
+            {
+                written = written || line / 64 >= this->m_block_line_count || ((this->m_block_lines[line / 64] >> (line % 64)) & 1U) != 0;
+            }
+            if (!written)
+            {
+                return;
+            }
+
+            // blocks live on the slot of their first word, at most a block length before the range
+            auto word = address & word_mask;
+            word = word >= span ? word - span : 0;
+
+            for (; word < last; word += sizeof(uint64_t))
+            {
+                auto &entry = this->block(word);
+                if ((entry.address & word_mask) == word && entry.address < last && entry.end > address)
+                {
+                    entry.address = decoded_instruction::invalid_address;
+                }
+            }
+        }
+
+        /**
+         * @brief set the map of pages holding translated code
+         * @param pages one byte per `1 << code_page_bits` bytes of memory, or `nullptr` to stop watching
+         *
+         * writes to pages marked as `code_page_translated` change them to
+         * `code_page_written` and set `code_written`
+         */
+        constexpr void watch_code(uint8_t *pages) noexcept { this->m_code_pages = pages; }
+
+        /**
+         * @brief get the map of pages holding translated code
+         * @return page map, `nullptr` if no code is being watched
+         */
+        [[nodiscard]] constexpr auto code_pages() const noexcept -> uint8_t * { return this->m_code_pages; }
+
+        /**
+         * @brief check if any page holding translated code was written to
+         * @return written flag reference, cleared by whoever translated the code
+         */
+        [[nodiscard]] constexpr auto code_written() noexcept -> bool & { return this->m_code_written; }
+
+        /**
+         * @brief report a write to watched code pages
+         * @param address first byte written
+         * @param size amount of bytes written
+         */
+        constexpr void invalidate_code(uint64_t address, uint64_t size) noexcept
+        {
+            if (this->m_code_pages == nullptr)
+            {
+                return;
+            }
+
+            for (auto page = address >> code_page_bits; page <= (address + size - 1) >> code_page_bits; ++page)
+            {
+                if (this->m_code_pages[page] != 0)
+                {
+                    this->m_code_pages[page] = code_page_written;
+                    this->m_code_written = true;
+                }
+            }
+        }
+
+        /**
+         * @brief watch pages the interpreter decoded code from, like translated ones
+         *
+         * translated stores to watched pages go through the interpreter, which
+         * drops what it cached from them
+         *
+         * @param address first byte decoded, on physical memory
+         * @param size amount of bytes decoded
+         */
+        constexpr void watch_decoded(uint64_t address, uint64_t size) noexcept
+        {
+            if (this->m_code_pages == nullptr)
+            {
+                return;
+            }
+
+            for (auto page = address >> code_page_bits; page <= (address + size - 1) >> code_page_bits; ++page)
+            {
+                if (this->m_code_pages[page] == 0)
+                {
+                    this->m_code_pages[page] = code_page_translated;
+                }
+            }
+        }
+
+        /**
+         * @brief check if instruction pairs get fused into superinstructions
+         * @return true if they do, the default
+         */
+        [[nodiscard]] constexpr auto fusion() const noexcept -> bool { return this->m_fusion; }
+
+        /**
+         * @brief get the bus group 3 i/o instructions go through
+         * @return bus, `nullptr` if the thread has no i/o
+         */
+        [[nodiscard]] constexpr auto io() const noexcept -> io_bus * { return this->m_io; }
+
+        /**
+         * @brief connect the thread to an i/o bus, the bus needs to outlive the thread
+         *
+         * the thread model, if any, gets the last port of the bus as its `io_address_space`
+         *
+         * @param bus bus to use, `nullptr` disconnects the thread
+         */
+        void use_io(io_bus *bus) noexcept;
+
+        /**
+         * @brief get the ring `pcall -1` hyper functions submit hosted i/o to
+         * @return ring, `nullptr` if the thread is not hosted
+         */
+        [[nodiscard]] constexpr auto hosted() const noexcept -> hosted_ring * { return this->m_hosted; }
+
+        /**
+         * @brief give the thread a hosted environment, the ring needs to be destroyed before the thread
+         * @param ring ring to use, `nullptr` leaves the thread without one
+         */
+        constexpr void use_hosted(hosted_ring *ring) noexcept { this->m_hosted = ring; }
+
+        /**
+         * @brief turn superinstructions on or off, dropping every cached instruction
+         * @param enabled true to fuse instruction pairs
+         */
+        void use_fusion(bool enabled) noexcept
+        {
+            this->m_fusion = enabled;
+            this->flush_decoded();
+        }
+
+        /**
+         * @brief drop every cached instruction and interrupt handler
+         *
+         * @note needs to be called after writing to code through `memory()`, as
+         * those writes are not seen by the virtual machine
+         */
+        void flush_decoded() noexcept
+        {
+            this->m_handlers_cached = false;
+            for (auto i = 0; i < decoded_cache_size; ++i)
+            {
+                this->m_decoded[i].address = decoded_instruction::invalid_address;
+            }
+            std::fill_n(this->m_decoded_lines.get(), this->m_decoded_line_count, 0);
+
+            if (this->m_blocks != nullptr)
+            {
+                for (auto i = 0; i < block_cache_size; ++i)
+                {
+                    this->m_blocks[i].address = decoded_instruction::invalid_address;
+                }
+                for (uint64_t lines = 0; lines < this->m_block_line_count; ++lines)
+                {
+                    this->m_block_lines[lines] = 0;
+                }
+            }
+        }
+
+        /**
+         * @brief apply a function from Rinstruction values
+         * @tparam T type of function (template deducted)
+         * @param instr R instruction to get register indexes from
+         * @param func function to use
+         *
+         * does: `rd <- func r1 r2`
+         *
+         */
+        template <typename T>
+        constexpr void apply_instr(RInstruction instr, T func) noexcept
+        {
+            this->registers(instr.rd()) =
+                func(this->registers(instr.r1()), this->registers(instr.r2()));
+        }
+
+        /**
+         * @brief apply a function from decoded R instruction values
+         * @tparam T type of function (template deducted)
+         * @param instr decoded instruction to get register indexes from
+         * @param func function to use
+         *
+         * does: `rd <- func r1 r2`
+         */
+        template <typename T>
+        constexpr void apply_rinstr(decoded_instruction const &instr, T func) noexcept
+        {
+            this->registers(instr.rd) =
+                func(this->registers(instr.r1), this->registers(instr.r2));
+        }
+
+        /**
+         * @brief apply a function from decoded S instruction values
+         * @tparam T type of function (template deducted)
+         * @param instr decoded instruction to get register indexes and immediates from
+         * @param func function to use
+         *
+         * does: `rd <- func r1 imm`, with an unsigned immediate
+         */
+        template <typename T>
+        constexpr void apply_sinstr(decoded_instruction const &instr, T func) noexcept
+        {
+            this->registers(instr.rd) =
+                func(this->registers(instr.r1), instr.uimm);
+        }
+
+        /**
+         * @brief apply a function from decoded S instruction values
+         * @tparam T type of function (template deducted)
+         * @param instr decoded instruction to get register indexes and immediates from
+         * @param func function to use
+         *
+         * does: `rd <- func r1 imm`, with a sign extended immediate
+         */
+        template <typename T>
+        constexpr void apply_sinstr(decoded_instruction const &instr, T func, bool apply_signed [[maybe_unused]]) noexcept
+        {
+            this->registers(instr.rd) =
+                func(this->registers(instr.r1), instr.imm);
+        }
+
+        /**
+         * @brief apply a function from Sinstruction values
+         * @tparam T type of function (template deducted)
+         * @param instr S instruction to get register indexes and immediates from
+         * @param func function to use
+         *
+         * does: 'rd <- func r1 imm`
+         */
+        template <typename T>
+        constexpr void apply_instr(SInstruction instr, T func) noexcept
+        {
+            this->registers(instr.rd()) =
+                func(this->registers(instr.r1()), instr.uimm());
+        }
+
+        template <typename T>
+        constexpr void apply_instr(SInstruction instr, T func, bool apply_signed [[maybe_unused]] ) noexcept
+        {
+            this->registers(instr.rd()) =
+                func(this->registers(instr.r1()), instr.imm());
+        }
+
+    private:
+        /**
+         * @brief walk the page tables for an address the TLB missed, caching the translation
+         * @param address virtual address
+         * @param access `page_access` bits the access needs
+         * @return address on thread memory, `untranslated` if the page is missing or lacks permissions
+         */
+        [[gnu::noinline]] auto walk_pages(uint64_t address, uint8_t access) noexcept -> uint64_t;
+
+        std::array<uint64_t, register_count> m_registers{{0}}; /**< thread registers */
+        std::unique_ptr<uint8_t[], memory_deleter> m_memory{}; /**< thread memory pointer */
+        uint64_t m_program_counter{0};                         /**< thread instructon pointer */
+        uint64_t m_int_vector{0};                              /**< interrupt vector pointer*/
+        uint64_t m_memory_size;                                /**< thread memory size */
+        struct thread_model_t *m_model;                        /**< thread model pointer */
+        ProcessorCall m_pcall{NormalExecution};                /**< which execution state the cpu is in */
+        ThreadDestruction m_signal{DoNotDestroy};              /**< thread destruction signal */
+        std::unique_ptr<decoded_instruction[]> m_decoded;      /**< decoded instruction cache */
+        std::unique_ptr<uint64_t[]> m_decoded_lines;           /**< one bit per line instructions were decoded from */
+        uint64_t m_decoded_line_count;                         /**< entries on `m_decoded_lines`, 64 lines each */
+        std::unique_ptr<decoded_block[]> m_blocks{};           /**< basic block cache, allocated on first use */
+        std::unique_ptr<uint64_t[]> m_block_lines{};           /**< one bit per line blocks were decoded from */
+        uint64_t m_block_line_count{0};                        /**< entries on `m_block_lines`, 64 lines each */
+        uint8_t *m_code_pages{nullptr};                        /**< pages holding translated code */
+        bool m_code_written{false};                            /**< translated code got written to */
+        bool m_fusion{true};                                   /**< fuse instruction pairs on the decoded cache */
+        memory_backend m_backend{CheckedMemory};               /**< how memory is kept */
+        bool m_paging{false};                                  /**< accesses go through page tables */
+        uint64_t m_page_bits;                                  /**< log2 of the page size, 0 without usable paging */
+        uint64_t m_page_table{0};                              /**< address of the root page table */
+        std::unique_ptr<tlb_entry[]> m_tlb{};                  /**< software TLB, allocated when paging is enabled */
+        io_bus *m_io{nullptr};                                 /**< devices behind group 3 i/o instructions */
+        hosted_ring *m_hosted{nullptr};                        /**< hosted environment, `pcall -1` space 3 */
+        std::vector<std::pair<uint64_t, uint64_t>> m_read_only{}; /**< ranges mapped without write access, first byte and end */
+        std::unique_ptr<uint64_t[]> m_handlers{};              /**< handlers read from the interrupt vector, allocated on first use */
+        uint64_t m_handlers_base{0};                           /**< interrupt vector `m_handlers` was read from */
+        bool m_handlers_cached{false};                         /**< `m_handlers` holds entries for `m_handlers_base` */
+        std::unique_ptr<native_pcall[]> m_native{};            /**< native handlers, allocated on first binding */
+        std::array<double, float_count> m_floats{};            /**< float registers */
+        std::unique_ptr<vector_register[]> m_vectors;          /**< vector registers */
+        uint64_t m_vector_width;                               /**< bytes group 7 instructions work on */
+        vector_kernel m_vector_kernel;                         /**< lane-wise operations for `m_vector_width` */
+#ifdef SUPERNOVA_STATS
+        execution_stats m_stats{};                             /**< interpreter counters */
+#endif
+    };
+
+    /**
+     * @brief saved state of a thread, see `Thread::snapshot` and `Thread::fork_from`
+     */
+    class thread_snapshot
+    {
+    public:
+        thread_snapshot() = default;
+        thread_snapshot(thread_snapshot const &) = delete;
+        thread_snapshot(thread_snapshot &&other) noexcept;
+        auto operator=(thread_snapshot const &) -> thread_snapshot & = delete;
+        auto operator=(thread_snapshot &&other) noexcept -> thread_snapshot &;
+        ~thread_snapshot();
+
+        /**
+         * @brief get the size of the saved memory in bytes
+         * @return memory byte size
+         */
+        [[nodiscard]] constexpr auto memsize() const noexcept -> auto { return this->m_memory_size; }
+
+        /**
+         * @brief check if threads started from this snapshot share its memory
+         * @return true if memory is shared copy-on-write, false if it gets copied
+         */
+        [[nodiscard]] constexpr auto shared() const noexcept -> bool { return this->m_descriptor >= 0; }
+
+    private:
+        friend class Thread;
+
+        std::array<uint64_t, Thread::register_count> m_registers{{0}}; /**< saved registers */
+        uint64_t m_program_counter{0};                                 /**< saved instruction pointer */
+        uint64_t m_int_vector{0};                                      /**< saved interrupt vector */
+        uint64_t m_memory_size{0};                                     /**< memory size */
+        struct thread_model_t *m_model{nullptr};                       /**< thread model pointer */
+        ProcessorCall m_pcall{NormalExecution};                        /**< saved processor call state */
+        ThreadDestruction m_signal{DoNotDestroy};                      /**< saved thread signal */
+        memory_backend m_backend{CheckedMemory};                       /**< how the saved thread kept its memory */
+        bool m_paging{false};                                          /**< saved thread translated accesses */
+        uint64_t m_page_table{0};                                      /**< saved page table register */
+        io_bus *m_io{nullptr};                                         /**< bus the saved thread did i/o on */
+        std::array<double, Thread::float_count> m_floats{};            /**< saved float registers */
+        std::array<vector_register, Thread::vector_count> m_vectors{}; /**< saved vector registers */
+        uint64_t m_vector_width{0};                                    /**< saved vector width */
+        int m_descriptor{-1};                                          /**< file holding memory, ends aligned to a page */
+        uint64_t m_length{0};                                          /**< length of the memory file */
+        std::unique_ptr<uint8_t[]> m_copy{nullptr};                    /**< memory, when it could not go into a file */
+    };
+
+    /**
+     * @brief operations on a hosted ring
+     */
+    enum hosted_opcode : uint8_t
+    {
+        HostedNop,   /**< completes straight away with 0 */
+        HostedRead,  /**< read from `fd` into the buffer */
+        HostedWrite, /**< write the buffer into `fd` */
+        HostedOpen,  /**< open the path on the buffer, NUL terminated inside it */
+        HostedClose, /**< close `fd` */
+    };
+
+    /**
+     * @brief flags of `HostedOpen`, passed on `hosted_request::offset`
+     */
+    enum hosted_open_flags : uint8_t
+    {
+        HostedReadOnly = 0,  /**< open for reading */
+        HostedWriteOnly = 1, /**< open for writing */
+        HostedReadWrite = 2, /**< open for reading and writing */
+        HostedCreate = 4,    /**< create the file if missing */
+        HostedTruncate = 8,  /**< truncate the file */
+        HostedAppend = 16,   /**< write at the end of the file */
+    };
+
+    /**
+     * @brief submission queue entry, as laid out in guest memory
+     */
+    struct hosted_request
+    {
+        uint64_t opcode;    /**< `hosted_opcode` */
+        uint64_t fd;        /**< host file descriptor, unused by `HostedOpen` */
+        uint64_t address;   /**< guest buffer, a path for `HostedOpen` */
+        uint64_t length;    /**< buffer length in bytes */
+        uint64_t offset;    /**< file offset, `~0` uses the file position. `hosted_open_flags` for `HostedOpen` */
+        uint64_t user_data; /**< handed back on the completion */
+    };
+
+    /**
+     * @brief completion queue entry, as laid out in guest memory
+     */
+    struct hosted_completion
+    {
+        uint64_t user_data; /**< from the request */
+        int64_t result;     /**< bytes moved or the new descriptor, negated `errno` on failure */
+    };
+
+    /**
+     * @brief pointer to a function that manages a hosted interrupt
+     */
+    using hosted_int = void (*)(Thread *);
+
+    /**
+     * @brief pointer to a function running a hosted request on its buffer
+     *
+     * called from the ring workers on a host copy of the request buffer,
+     * `memory` is the copy and `request.address` is 0 on it
+     */
+    using hosted_io = int64_t (*)(uint8_t *memory, uint64_t memory_size, hosted_request const &request) noexcept;
+
+    struct thread_hosted_functions
+    {
+        /** version of those functions */
+        uint64_t version;
+
+        /** default interrupt call, not used by the ring */
+        hosted_int interrupt;
+
+        /** read from fd function */
+        hosted_io read;
+
+        /** write to fd function */
+        hosted_io write;
+
+        /** open file function */
+        hosted_io open;
+
+        /** close fd function*/
+        hosted_io close;
+    };
+
+    /**
+     * @brief get the hosted functions of the host, POSIX calls on unix and `-ENOSYS` everywhere else
+     * @return functions, valid for the whole program
+     */
+    [[nodiscard]] auto default_hosted_functions() noexcept -> thread_hosted_functions const &;
+
+    struct hosted_ring_state;
+
+    /**
+     * @brief asynchronous hosted i/o over a submission and completion ring in guest memory
+     *
+     * modeled on io_uring, the guest places the ring at a double word aligned
+     * address, contiguous on thread memory while paging is on:
+     *
+     * | offset                          | contents                                  |
+     * |---------------------------------|-------------------------------------------|
+     * | 0                               | submission head, written by the host      |
+     * | 8                               | submission tail, written by the guest     |
+     * | 16                              | completion head, written by the guest     |
+     * | 24                              | completion tail, written by the host      |
+     * | 32                              | `entries` requests (`hosted_request`)     |
+     * | 32 + 48 * entries               | `entries` completions (`hosted_completion`) |
+     *
+     * counters only grow, entries are indexed modulo `entries`. the guest
+     * queues requests and publishes the tail, `enter` hands every queued
+     * request to a pool of host workers in one go and posts completions of
+     * the ones that finished. requests run in any order
+     *
+     * workers never touch guest memory, they run on host copies of the
+     * buffers. `enter` makes them on the guest thread, translating addresses
+     * while paging is on, and copies what was read back into the guest the
+     * same way stores write, so reading into code needs no flush
+     */
+    class hosted_ring
+    {
+    public:
+        /** bytes before the submission queue */
+        static const constexpr uint64_t header_size = 4 * sizeof(uint64_t);
+
+        /** most entries a ring may have */
+        static const constexpr uint64_t max_entries = 4096;
+
+        /** default amount of host workers */
+        static const constexpr unsigned default_workers = 4;
+
+        /** returned by `enter` when the host ran out of memory or threads */
+        static const constexpr auto failed = ~0LLU;
+
+        /**
+         * @brief get the bytes a ring takes in guest memory
+         * @param entries amount of entries of each queue
+         * @return ring size in bytes
+         */
+        [[nodiscard]] static constexpr auto ring_size(uint64_t entries) noexcept -> uint64_t
+        {
+            return header_size + entries * (sizeof(hosted_request) + sizeof(hosted_completion));
+        }
+
+        /**
+         * @brief create a ring, workers start once it is set up
+         * @param functions functions running the requests
+         * @param workers amount of host workers, at least 1
+         */
+        explicit hosted_ring(thread_hosted_functions const &functions = default_hosted_functions(), unsigned workers = default_workers);
+
+        hosted_ring(hosted_ring const &) = delete;
+        hosted_ring(hosted_ring &&) = delete;
+        auto operator=(hosted_ring const &) -> hosted_ring & = delete;
+        auto operator=(hosted_ring &&) -> hosted_ring & = delete;
+
+        /**
+         * @brief wait for every request in flight and stop the workers
+         */
+        ~hosted_ring();
+
+        /**
+         * @brief place the ring in thread memory, resetting every counter
+         *
+         * @param thread thread owning the memory
+         * @param address address of the ring, aligned to a double word
+         * @param entries amount of entries of each queue, a power of two up to `max_entries`
+         * @return false if the ring does not fit, is misaligned, requests are still in flight or the workers could not start
+         */
+        auto setup(Thread &thread, uint64_t address, uint64_t entries) noexcept -> bool;
+
+        /**
+         * @brief submit every queued request, then post completions until enough are on the ring
+         * @param thread thread owning the memory the ring was set up on, only call it from the host thread running it
+         * @param wait_for amount of completions to wait for on the ring, capped to `entries`
+         * @return amount of requests submitted, `failed` if the host could not queue them
+         */
+        auto enter(Thread &thread, uint64_t wait_for) noexcept -> uint64_t;
+
+        /**
+         * @brief get the functions running the requests
+         * @return functions given on creation
+         */
+        [[nodiscard]] auto functions() const noexcept -> thread_hosted_functions const &;
+
+    private:
+        std::unique_ptr<hosted_ring_state> m_state; /**< ring placement, queues and workers */
+    };
+
+    /**
+     * @brief host services bound to processor calls, installed on every thread that uses them
+     *
+     * plain function pointers cost a single indirect call per processor
+     * call, `std::function`s one more through a trampoline. handlers get the
+     * thread, its registers and memory, and must not throw. threads keep
+     * pointers into the registry, it needs to outlive them, and bindings
+     * made after `install` are only seen by installing again
+     */
+    class pcall_registry
+    {
+    public:
+        /** handler that is not a plain function */
+        using function = std::function<void(Thread &)>;
+
+        /**
+         * @brief bind a plain function to a processor call
+         * @param pcall processor call, below `Thread::vector_cache_size` and not `Halt`
+         * @param handler handler, `nullptr` unbinds it
+         * @param context passed to the handler
+         * @return false if the processor call can not be bound
+         */
+        auto bind(uint64_t pcall, pcall_handler handler, void *context = nullptr) -> bool;
+
+        /**
+         * @brief bind any callable to a processor call
+         * @param pcall processor call, below `Thread::vector_cache_size` and not `Halt`
+         * @param handler handler, an empty one unbinds it
+         * @return false if the processor call can not be bound
+         */
+        auto bind(uint64_t pcall, function handler) -> bool;
+
+        /**
+         * @brief bind every handler on a thread, processor calls without one are left as they were
+         * @param thread thread to install the handlers on
+         * @return false if the thread could not take them
+         */
+        auto install(Thread &thread) const noexcept -> bool;
+
+        /**
+         * @brief get the binding of a processor call
+         * @param pcall any processor call
+         * @return binding, `nullptr` if nothing is bound to it
+         */
+        [[nodiscard]] auto bound(uint64_t pcall) const noexcept -> native_pcall const *;
+
+    private:
+        std::array<native_pcall, Thread::vector_cache_size> m_bindings{};               /**< what threads get installed */
+        std::array<std::unique_ptr<function>, Thread::vector_cache_size> m_functions{}; /**< callables, at stable addresses for their contexts */
+        std::vector<std::unique_ptr<function>> m_retired{};                            /**< replaced callables, installed threads may still use them */
+    };
+
+    /**
+     * @brief read a device register
+     *
+     * gets the device, the port relative to where the device was attached
+     * and the access width in bytes, 1 for `inb` and 8 for `inw`
+     */
+    using io_read = uint64_t (*)(void *device, uint64_t port, uint8_t width) noexcept;
+
+    /**
+     * @brief write a device register, same arguments as `io_read` plus the value
+     */
+    using io_write = void (*)(void *device, uint64_t port, uint64_t value, uint8_t width) noexcept;
+
+    /**
+     * @brief port on an `io_bus`, every port of a device holds the same entry
+     */
+    struct io_port
+    {
+        void *device{nullptr};  /**< device attached to the port, `nullptr` if none is */
+        io_read read{nullptr};  /**< device read handler */
+        io_write write{nullptr}; /**< device write handler */
+        uint64_t base{0};       /**< first port of the device */
+    };
+
+    /**
+     * @brief port mapped i/o bus used by `outb`, `outw`, `inb` and `inw`
+     *
+     * ports are a flat table, an i/o instruction costs a bounds check and an
+     * indirect call into the device. reads from ports without a device give
+     * all ones, writes to them are dropped
+     *
+     * devices are any type with a `port_count` constant and `read`/`write`
+     * members taking the same arguments as `io_read`/`io_write` minus the device
+     */
+    class io_bus
+    {
+    public:
+        /** default amount of ports */
+        static const constexpr uint64_t default_port_count = 0x100;
+
+        /**
+         * @brief create a bus with no devices
+         * @param port_count amount of ports, at least 1
+         */
+        explicit io_bus(uint64_t port_count = default_port_count);
+
+        /**
+         * @brief attach a device to a range of ports
+         *
+         * @param base first port of the device
+         * @param count amount of ports the device takes
+         * @param device device, handed back to the handlers
+         * @param read read handler
+         * @param write write handler
+         * @return false if the range does not fit or overlaps another device, nothing changes then
+         */
+        auto attach(uint64_t base, uint64_t count, void *device, io_read read, io_write write) -> bool;
+
+        /**
+         * @brief attach a device object, it needs to outlive the bus
+         * @tparam device device type
+         * @param base first port of the device
+         * @param target device
+         * @return false if the range does not fit or overlaps another device
+         */
+        template <typename device>
+        auto attach(uint64_t base, device &target) -> bool
+        {
+            return this->attach(
+                base, device::port_count, &target,
+                [](void *self, uint64_t port, uint8_t width) noexcept { return static_cast<device *>(self)->read(port, width); },
+                [](void *self, uint64_t port, uint64_t value, uint8_t width) noexcept { static_cast<device *>(self)->write(port, value, width); });
+        }
+
+        /**
+         * @brief detach the device holding a port
+         * @param port any port of the device
+         */
+        void detach(uint64_t port) noexcept;
+
+        /**
+         * @brief get the last port of the bus, what `thread_model_t::io_address_space` reports
+         * @return last port
+         */
+        [[nodiscard]] constexpr auto last_port() const noexcept -> uint64_t { return this->m_port_count - 1; }
+
+        /**
+         * @brief read a port
+         * @param port port number
+         * @param width access width in bytes
+         * @return value read, all ones if no device is attached
+         */
+        [[nodiscard]] auto read(uint64_t port, uint8_t width) const noexcept -> uint64_t
+        {
+            if (port >= this->m_port_count || this->m_ports[port].device == nullptr)
+            {
+                return ~0ULL;
+            }
+            auto const &entry = this->m_ports[port];
+            return entry.read(entry.device, port - entry.base, width);
+        }
+
+        /**
+         * @brief write a port
+         * @param port port number
+         * @param value value written
+         * @param width access width in bytes
+         */
+        void write(uint64_t port, uint64_t value, uint8_t width) const noexcept
+        {
+            if (port >= this->m_port_count || this->m_ports[port].device == nullptr)
+            {
+                return;
+            }
+            auto const &entry = this->m_ports[port];
+            entry.write(entry.device, port - entry.base, value, width);
+        }
+
+    private:
+        std::unique_ptr<io_port[]> m_ports; /**< one entry per port */
+        uint64_t m_port_count;              /**< entries on `m_ports` */
+    };
+
+    /**
+     * @brief console on two ports, reading and writing bytes of host files
+     *
+     * port 0 reads the next input byte (all ones once input ends) and writes
+     * an output byte. port 1 reads 1 once input ended, writing it flushes
+     * the output
+     */
+    class console_device
+    {
+    public:
+        /** ports taken by the device */
+        static const constexpr uint64_t port_count = 2;
+
+        /**
+         * @brief create a console
+         * @param input file read from, usually `stdin`
+         * @param output file written to, usually `stdout`
+         */
+        console_device(std::FILE *input, std::FILE *output) noexcept : m_input{input}, m_output{output} {}
+
+        auto read(uint64_t port, uint8_t width) noexcept -> uint64_t;
+        void write(uint64_t port, uint64_t value, uint8_t width) noexcept;
+
+    private:
+        std::FILE *m_input;  /**< console input */
+        std::FILE *m_output; /**< console output */
+    };
+
+    /**
+     * @brief block device backed by a host file, moving a sector at a time
+     *
+     * | port | read                    | write                                  |
+     * |------|-------------------------|----------------------------------------|
+     * | 0    | sector                  | select sector                          |
+     * | 1    | offset in the buffer    | set offset in the buffer               |
+     * | 2    | buffer data, advances   | buffer data, advances                  |
+     * | 3    | 0 or 1 if the last command failed | 1 reads the sector, 2 writes it |
+     * | 4    | amount of sectors       | ignored                                |
+     *
+     * data moves a byte with `inb`/`outb` and a double word with `inw`/`outw`
+     */
+    class block_device
+    {
+    public:
+        /** ports taken by the device */
+        static const constexpr uint64_t port_count = 5;
+
+        /** bytes moved by each command */
+        static const constexpr uint64_t sector_size = 512;
+
+        /** command port value reading the selected sector into the buffer */
+        static const constexpr uint64_t command_read = 1;
+
+        /** command port value writing the buffer into the selected sector */
+        static const constexpr uint64_t command_write = 2;
+
+        /**
+         * @brief open a file as a block device, the last partial sector is not reachable
+         * @param filename file to use, opened for reading and writing
+         */
+        explicit block_device(char const *filename);
+
+        block_device(block_device const &) = delete;
+        block_device(block_device &&) noexcept = default;
+        auto operator=(block_device const &) -> block_device & = delete;
+        auto operator=(block_device &&) noexcept -> block_device & = default;
+        ~block_device() = default;
+
+        /**
+         * @brief check if the file could be opened
+         * @return true if the device is usable
+         */
+        [[nodiscard]] auto is_open() const noexcept -> bool { return this->m_file != nullptr; }
+
+        auto read(uint64_t port, uint8_t width) noexcept -> uint64_t;
+        void write(uint64_t port, uint64_t value, uint8_t width) noexcept;
+
+    private:
+        std::unique_ptr<std::FILE, int (*)(std::FILE *)> m_file;      /**< backing file */
+        uint64_t m_sectors{0};                                        /**< whole sectors on the file */
+        uint64_t m_sector{0};                                         /**< selected sector */
+        uint64_t m_offset{0};                                         /**< next byte of the buffer */
+        bool m_failed{false};                                         /**< last command failed */
+        std::array<uint8_t, sector_size> m_buffer{};                  /**< sector buffer */
+    };
+
+    /**
+     * @brief timer on two ports, port 0 reads nanoseconds since the device was
+     * created on a monotonic clock, port 1 reads seconds since the unix epoch
+     */
+    class timer_device
+    {
+    public:
+        /** ports taken by the device */
+        static const constexpr uint64_t port_count = 2;
+
+        timer_device() noexcept;
+
+        auto read(uint64_t port, uint8_t width) noexcept -> uint64_t;
+        void write(uint64_t port, uint64_t value, uint8_t width) noexcept;
+
+    private:
+        int64_t m_start; /**< monotonic clock when the device was created, in nanoseconds */
+    };
+
+    /**
+     * @brief defines a function type related to interrupts
+     */
+    using interrupt_function_t = void (*)(int, Thread *);
+
+    /**
+     * @brief defines a function for generating instructions
+     */
+    using instr_dispatch_t = void (*)(Thread *, union instruction_t);
+
+    /**
+     * \defgroup virtset Virtual Instruction Set Emulation
+     *
+     * \brief all the instruction prefixes used on the emulated vm cpu
+     *
+     * @{
+     */
+
+    namespace headers
+    {
+        /**
+         * @brief first header inside a snova file, responsible for coordinating other headers
+        */
+        struct main_header
+        {
+            /** file magic "Zenithvm" */
+            uint64_t magic;
+
+            /** current header version */
+            uint64_t version;
+
+            /** memory allocated to the virtual machine, skipped if this is a real processor */
+            uint64_t memory_size;
+
+            /** code entry point */
+            uint64_t entry_point;
+
+            /** amount of memory regions inside the current file */
+            uint64_t memory_regions;
+        };
+
+        /**
+         * @brief flags for memory areas inside the file
+        */
+        enum memory_flags : uint8_t
+        {
+            /** this area is readable */
+            mem_read = 0x01,
+
+            /** this area is writable */
+            mem_write = 0x02,
+
+            /** this area is executable */
+            mem_execute = 0x04,
+
+            /** allocate memory for this area, it does not exist on the file */
+            mem_clear = 0x08,
+
+            /** this memory region should go to the executable code memory*/
+            mem_exists = 0x10
+        };
+
+        /**
+         * @brief map for a region of the memory
+        */
+        struct memory_map
+        {
+            uint64_t magic;
+
+            /** start of the memory map inside the file, if `clear` is set it is just ignored */
+            uint64_t start;
+
+            /** size of the memory map both in the file and the virtual memory, in bytes*/
+            uint64_t size;
+
+            /** start of the memory map inside the virtual memory*/
+            uint64_t offset;
+
+            /** flags for the memory region defined*/
+            memory_flags flags;
+        } __attribute__((aligned(sizeof(uint64_t))));
+
+        /** master magic: "Zenithvm" */
+        constexpr auto const master_magic = 0x6D766874696E655ALLU;
+
+        /** memory map magic: "mem_map!" */
+        constexpr auto const memmap_magic = 0x2170616D5f6D656DLLU;
+
+        /** symbol table magic, first double word of a debug region holding symbols: "symbols!" */
+        constexpr auto const symbols_magic = 0x21736C6F626D7973LLU;
+
+        /**
+         * @brief symbol inside a debug region
+         *
+         * debug regions (regions without `mem_exists`) holding symbols start
+         * with `symbols_magic` and the amount of symbols, every symbol is then
+         * followed by its name, padded with zeroes to 8 bytes
+         */
+        struct symbol_record
+        {
+            /** first byte of the symbol in memory */
+            uint64_t address;
+
+            /** size of the symbol in bytes, 0 reaches until the next symbol */
+            uint64_t size;
+
+            /** length of the name in bytes, without padding */
+            uint64_t name_length;
+        };
+
+
+
+
+        /** version: major(16bit):minor(16bit):patch(32bit)*/
+        constexpr auto const snvm_version = SUPERNOVA_VERSION_MAJOR << 48U | SUPERNOVA_VERSION_MINOR << 32 | SUPERNOVA_VERSION_PATCH;
+
+        enum read_status : uint8_t{
+            ReadOk,
+            FileNotFound,
+            InvalidHeader,
+            InvalidEntryPoint,
+            VersionMismatch,
+            MagicMismatch,
+            InvalidMemoryRegion,
+            FileError
+        };
+
+        /**
+         * @brief ways to bring an image into memory
+         */
+        enum load_mode : uint8_t
+        {
+            LoadCopy,   /**< allocate all memory and read every region into it */
+            LoadMapped, /**< map the file copy-on-write, pages are only read when touched */
+        };
+
+        struct read_return {
+            std::unique_ptr<uint8_t[], memory_deleter> memory_pointer{nullptr};
+            uint64_t memory_size{0};
+            read_status status{ReadOk};
+            uint64_t entry_point{-1LLU};
+            /** memory regions declared by the file, only set when reading succeeds */
+            std::unique_ptr<memory_map[]> regions{nullptr};
+            /** amount of entries in `regions` */
+            uint64_t region_count{0};
+            read_return() = default;
+            explicit read_return(read_status stat, uint64_t mem_size=0, uint64_t entry=0, std::unique_ptr<uint8_t[], memory_deleter> memory = nullptr) 
+            : memory_pointer(std::move(memory)), memory_size{mem_size}, status{stat}, entry_point{entry} {}
+        };
+
+        /**
+         * @brief read an image from a file
+         *
+         * with `LoadMapped`, regions whose file and memory offsets share the
+         * same page alignment are mapped straight from the file, `mem_clear`
+         * regions and memory outside any region are anonymous zero pages, and
+         * nothing is read until touched. hosts without `mmap` always copy
+         *
+         * @param filename image file name
+         * @param mode how to bring the image into memory
+         * @return memory and information about the image
+         */
+        auto read_file(char const * filename, load_mode mode = LoadCopy) -> read_return;
+
+    }; // namespace headers
+
+    /***/
+    using thread_return = std::pair<bool, int>;
+
+
+
+
+    /**
+     * @brief ways the interpreter can go from one instruction to the next
+     */
+    enum dispatch_engine : uint8_t
+    {
+        SwitchDispatch,   /**< a single switch over the opcode, works everywhere */
+        TailCallDispatch, /**< handler table, chained with guaranteed tail calls when the compiler has them */
+        GotoDispatch,     /**< computed goto with one label per opcode (gcc/clang) */
+        BlockDispatch,    /**< cached basic blocks linked to each other, signals are checked between blocks */
+    };
+
+    /**
+     * @brief check if a dispatch engine was compiled in
+     *
+     * @param engine engine to check
+     *
+     * @return true if the engine is available, unavailable engines fall back to `SwitchDispatch`
+     */
+    [[nodiscard]] auto dispatch_available(dispatch_engine engine) noexcept -> bool;
+
+    /**
+     * @brief get the dispatch engine selected at build time (`SUPERNOVA_DISPATCH` on cmake)
+     *
+     * @return engine used by `run`
+     */
+    [[nodiscard]] auto default_dispatch() noexcept -> dispatch_engine;
+
+    /**
+     * @brief run instructions with a specific dispatch engine
+     *
+     * stops when the thread signal changes or the budget runs out, on
+     * `GuardedMemory` threads an access out of range also stops it
+     *
+     * @param thread thread to run
+     * @param engine dispatch engine to use
+     * @param budget maximum amount of instructions to run
+     *
+     * @return amount of instructions ran
+     */
+    auto dispatch(Thread &thread, dispatch_engine engine, uint64_t budget) noexcept -> uint64_t;
+
+    /**
+     * @brief run code from a file
+     *
+     * @param argc main's argc
+     * @param[in] argv main's argv
+     * @param thread current thread to run
+     * @param step set to only run one instruction, defaults to false but used when testing
+     * @return exit codet
+     */
+    auto run(int argc, char **argv, Thread &thread, bool step = false) -> thread_return;
+
+    /**
+     * @brief reasons `run_for` gave control back
+     */
+    enum run_status : uint8_t
+    {
+        BudgetExhausted, /**< every allowed instruction ran, calling again resumes the thread */
+        ProgramEnded,    /**< program halted, exit code is `r1` */
+        ProgramFaulted,  /**< thread was destroyed, exit code is the `ThreadDestruction` reason */
+    };
+
+    /**
+     * @brief result of running a thread for a limited amount of instructions
+     */
+    struct run_result
+    {
+        run_status status; /**< why the run stopped */
+        uint64_t executed; /**< instructions ran */
+        int exit_code;     /**< exit code once the thread stopped, 0 while it can be resumed */
+    };
+
+    /**
+     * @brief run a thread for at most `max_instructions` instructions
+     *
+     * the thread keeps all its state between calls, so a host is able to
+     * slice time between threads, enforce quotas or do i/o between runs.
+     * unlike `run`, registers are left as they are on the first call
+     *
+     * @param thread thread to run
+     * @param max_instructions maximum amount of instructions to run
+     * @param engine dispatch engine to use
+     *
+     * @return status, instructions ran and exit code
+     *
+     * @note an access hitting a guard page counts the rest of the budget as ran
+     */
+    auto run_for(Thread &thread, uint64_t max_instructions, dispatch_engine engine = default_dispatch()) noexcept -> run_result;
+
+    /**
+     * @brief baseline x86-64 translator for groups 0 to 3
+     *
+     * basic blocks entered often enough get translated instruction by
+     * instruction into native code that works directly on the thread
+     * registers, and jump straight into the translated blocks they lead to.
+     * colder blocks run on the interpreter, and anything the translator does
+     * not handle (processor calls, stack instructions, divisions, faults) goes
+     * back to it for a single instruction
+     */
+    namespace jit
+    {
+        /** default amount of entries a block gets interpreted for before being translated */
+        static const constexpr uint64_t hot_threshold = 16;
+
+        /**
+         * @brief check if the translator works on this host
+         * @return false if code can not be generated, `jit::run` then only interprets
+         */
+        [[nodiscard]] auto available() noexcept -> bool;
+
+        /**
+         * @brief run code from a file, translating it to native code when possible
+         *
+         * @param argc main's argc
+         * @param[in] argv main's argv
+         * @param thread current thread to run
+         * @param threshold entries a block gets interpreted for before being translated, 0 and 1 translate on the first
+         * @return exit code, same as `supernova::run`
+         */
+        auto run(int argc, char **argv, Thread &thread, uint64_t threshold = hot_threshold) -> thread_return;
+    } // namespace jit
+
+    /**
+     * @brief ahead of time translator, turns an image into a C++ source file
+     *
+     * only code statically reachable from the entry point is translated, indirect
+     * jumps go through a switch over the program counter, and anything without a
+     * native translation (processor calls, stack instructions, divisions, faults)
+     * is handed to the interpreter one instruction at a time
+     */
+    namespace aot
+    {
+        /**
+         * @brief counters from a translation
+         */
+        struct translation_stats
+        {
+            uint64_t instructions; /**< reachable instructions found */
+            uint64_t translated;   /**< instructions turned into native code */
+            uint64_t interpreted;  /**< instructions left to the interpreter */
+        };
+
+        /**
+         * @brief write a C++ program equivalent to an image
+         *
+         * the generated program has its own `main`, and needs to be linked with
+         * the supernova library, a changed image is detected and only interpreted
+         *
+         * @param image image returned by `headers::read_file`
+         * @param filename image file name, used as the default image at runtime
+         * @param output stream to write the program to
+         * @return translation counters
+         */
+        auto translate(headers::read_return const &image, char const *filename, std::ostream &output) -> translation_stats;
+    } // namespace aot
+
+    /**
+     * @brief runs many threads on a fixed pool of host threads
+     *
+     * every worker keeps a deque of threads, running the one in front for a
+     * quantum of instructions and moving it to the back once preempted, idle
+     * workers steal from the back of other deques. finished threads are
+     * reported through a completion queue
+     */
+    class scheduler
+    {
+    public:
+        /**
+         * @brief a thread that stopped running
+         */
+        struct completion
+        {
+            uint64_t id;                    /**< id returned by `submit` */
+            thread_return result;           /**< same as `run` would return */
+            std::unique_ptr<Thread> thread; /**< the thread itself, in its final state */
+        };
+
+        /** default amount of instructions a thread runs before being preempted */
+        static const constexpr uint64_t default_quantum = 1U << 16U;
+
         /**
-         * @brief apply a function from Rinstruction values
-         * @tparam T type of function (template deducted)
-         * @param instr R instruction to get register indexes from
-         * @param func function to use
-         *
-         * does: `rd <- func r1 r2`
+         * @brief start the workers
          *
+         * @param workers amount of host threads, 0 uses one per hardware thread
+         * @param quantum amount of instructions to run before preempting a thread
+         * @param engine dispatch engine used by every worker
          */
-        template <typename T>
-        constexpr void apply_instr(RInstruction instr, T func) noexcept
-        {
-            this->registers(instr.rd()) =
-                func(this->registers(instr.r1()), this->registers(instr.r2()));
-        }
+        explicit scheduler(unsigned workers = 0, uint64_t quantum = default_quantum, dispatch_engine engine = default_dispatch());
+
+        scheduler(scheduler const &) = delete;
+        scheduler(scheduler &&) = delete;
+        auto operator=(scheduler const &) -> scheduler & = delete;
+        auto operator=(scheduler &&) -> scheduler & = delete;
 
         /**
-         * @brief apply a function from Sinstruction values
-         * @tparam T type of function (template deducted)
-         * @param instr S instruction to get register indexes and immediates from
-         * @param func function to use
-         *
-         * does: 'rd <- func r1 imm`
+         * @brief stop the workers, threads that did not finish are dropped
          */
-        template <typename T>
-        constexpr void apply_instr(SInstruction instr, T func) noexcept
-        {
-            this->registers(instr.rd()) =
-                func(this->registers(instr.r1()), instr.uimm());
-        }
+        ~scheduler();
 
-        template <typename T>
-        constexpr void apply_instr(SInstruction instr, T func, bool apply_signed [[maybe_unused]] ) noexcept
-        {
-            this->registers(instr.rd()) =
-                func(this->registers(instr.r1()), instr.imm());
-        }
+        /**
+         * @brief queue a thread to run
+         * @param thread thread to run
+         * @return id reported on its completion
+         */
+        auto submit(std::unique_ptr<Thread> thread) -> uint64_t;
+
+        /**
+         * @brief wait for a thread to finish
+         * @return the next completion, `thread` is `nullptr` if nothing is left to run
+         */
+        auto wait() -> completion;
+
+        /**
+         * @brief get a completion if one is ready
+         * @param[out] done completion, untouched if nothing finished yet
+         * @return true if `done` was set
+         */
+        auto try_wait(completion &done) -> bool;
+
+        /**
+         * @brief count threads submitted and not yet taken from the completion queue
+         * @return amount of threads
+         */
+        [[nodiscard]] auto pending() const noexcept -> uint64_t;
+
+        /**
+         * @brief get the amount of workers
+         * @return amount of host threads running threads
+         */
+        [[nodiscard]] auto workers() const noexcept -> unsigned;
 
     private:
-        std::array<uint64_t, register_count> m_registers{{0}}; /**< thread registers */
-        std::unique_ptr<uint8_t[]> m_memory{};                 /**< thread memory pointer */
-        uint64_t m_program_counter{0};                         /**< thread instructon pointer */
-        uint64_t m_int_vector{0};                              /**< interrupt vector pointer*/
-        uint64_t m_memory_size;                                /**< thread memory size */
-        struct thread_model_t *m_model;                        /**< thread model pointer */
-        ProcessorCall m_pcall{NormalExecution};                /**< which execution state the cpu is in */
-        ThreadDestruction m_signal{DoNotDestroy};              /**< thread destruction signal */
+        std::unique_ptr<struct scheduler_state> m_state; /**< queues and workers */
     };
 
     /**
-     * @brief pointer to a function that manages a hosted interrupt
+     * @brief sampling profiler, records guest call stacks every so many instructions
+     *
+     * stacks are walked through the frames `call_instrc` leaves behind, the
+     * base pointer points right after the saved base pointer and the return
+     * address (`u64[bp - 16] = previous bp`, `u64[bp - 8] = return`)
      */
-    using hosted_int = void (*)(Thread *);
-
-    struct thread_hosted_functions
+    class profiler
     {
-        /** version of those functions */
-        uint64_t version;
+    public:
+        /** default amount of instructions between samples */
+        static const constexpr uint64_t default_interval = 10000;
 
-        /** default interrupt call*/
-        hosted_int interrupt;
+        /** deepest stack walked, deeper frames are dropped */
+        static const constexpr auto max_depth = 256;
 
-        /** read from fd function */
-        hosted_int read;
+        /**
+         * @brief create an empty profile
+         *
+         * @param interval amount of instructions between samples
+         * @param base_register register holding the base pointer
+         */
+        explicit profiler(uint64_t interval = default_interval, uint8_t base_register = 3);
 
-        /** write to fd function */
-        hosted_int write;
+        profiler(profiler const &) = delete;
+        profiler(profiler &&) noexcept;
+        auto operator=(profiler const &) -> profiler & = delete;
+        auto operator=(profiler &&) noexcept -> profiler &;
+        ~profiler();
 
-        /** open file function */
-        hosted_int open;
+        /**
+         * @brief run a thread until it stops, sampling it every interval
+         *
+         * @param thread thread to run, registers are left as they are
+         * @param engine dispatch engine to use
+         *
+         * @return same as `run_for` with an unlimited budget
+         */
+        auto run(Thread &thread, dispatch_engine engine = default_dispatch()) -> run_result;
 
-        /** close fd function*/
-        hosted_int close;
-    };
+        /**
+         * @brief record the current stack of a thread
+         * @param thread thread to sample, it is not changed
+         */
+        void sample(Thread &thread);
 
-    /**
-     * @brief defines a function type related to interrupts
-     */
-    using interrupt_function_t = void (*)(int, Thread *);
+        /**
+         * @brief name a range of memory
+         *
+         * @param address first byte of the symbol
+         * @param size size in bytes, 0 reaches until the next symbol
+         * @param name symbol name
+         */
+        void add_symbol(uint64_t address, uint64_t size, char const *name);
+
+        /**
+         * @brief read symbols from the debug regions of an image
+         *
+         * @param filename image the regions come from
+         * @param image image as returned by `read_file`
+         *
+         * @return amount of symbols read
+         */
+        auto load_symbols(char const *filename, headers::read_return const &image) -> uint64_t;
+
+        /**
+         * @brief write every stack as a folded stack, callers first
+         *
+         * each line holds frames split by `;` and the amount of samples, frames
+         * without a symbol are written as their address in hex
+         *
+         * @param output stream to write to
+         */
+        void write_folded(std::ostream &output) const;
+
+        /**
+         * @brief get the amount of samples taken
+         * @return amount of samples
+         */
+        [[nodiscard]] auto samples() const noexcept -> uint64_t;
+
+    private:
+        std::unique_ptr<struct profiler_state> m_state; /**< samples and symbols */
+    };
 
     /**
-     * @brief defines a function for generating instructions
+     * @brief what went wrong while building a program
      */
-    using instr_dispatch_t = void (*)(Thread *, union instruction_t);
+    enum build_status : uint8_t
+    {
+        BuildOk,         /**< every label is bound and every region fits */
+        UnboundLabel,    /**< a label was used but never bound */
+        OutOfRange,      /**< a branch target is further than its immediate reaches */
+        InvalidRegion,   /**< regions overlap or do not fit in memory */
+        WriteFailed,     /**< the image could not be written */
+    };
 
     /**
-     * \defgroup virtset Virtual Instruction Set Emulation
+     * @brief assembles programs in memory, and lays them out as images
      *
-     * \brief all the instruction prefixes used on the emulated vm cpu
-     *
-     * @{
+     * instructions go one after the other starting at the origin, labels
+     * can be used before they are bound and get fixed up by `resolve`.
+     * constants are built with `ori` and `lui`, `r0` is always zero so it
+     * is used as the source register
      */
-
-    namespace headers
+    class ProgramBuilder
     {
+    public:
         /**
-         * @brief first header inside a snova file, responsible for coordinating other headers
-        */
-        struct main_header
+         * @brief place in the code, bound once with `bind`
+         */
+        struct label
         {
-            /** file magic "Zenithvm" */
-            uint64_t magic;
-
-            /** current header version */
-            uint64_t version;
-
-            /** memory allocated to the virtual machine, skipped if this is a real processor */
-            uint64_t memory_size;
-
-            /** code entry point */
-            uint64_t entry_point;
-
-            /** amount of memory regions inside the current file */
-            uint64_t memory_regions;
+            uint64_t id; /**< index of the label inside the builder */
         };
 
         /**
-         * @brief flags for memory areas inside the file
-        */
-        enum memory_flags : uint8_t
-        {
-            /** this area is readable */
-            mem_read = 0x01,
-
-            /** this area is writable */
-            mem_write = 0x02,
+         * @brief create an empty program
+         * @param origin address of the first instruction, also the default entry point
+         */
+        explicit ProgramBuilder(uint64_t origin = 0);
 
-            /** this area is executable */
-            mem_execute = 0x04,
+        ProgramBuilder(ProgramBuilder const &) = delete;
+        ProgramBuilder(ProgramBuilder &&) noexcept;
+        auto operator=(ProgramBuilder const &) -> ProgramBuilder & = delete;
+        auto operator=(ProgramBuilder &&) noexcept -> ProgramBuilder &;
+        ~ProgramBuilder();
 
-            /** allocate memory for this area, it does not exist on the file */
-            mem_clear = 0x08,
+        /**
+         * @brief append an instruction
+         * @return this builder
+         */
+        auto emit(RInstruction instr) -> ProgramBuilder &;
+        auto emit(SInstruction instr) -> ProgramBuilder &; /**< @copydoc emit(RInstruction) */
+        auto emit(LInstruction instr) -> ProgramBuilder &; /**< @copydoc emit(RInstruction) */
 
-            /** this memory region should go to the executable code memory*/
-            mem_exists = 0x10
-        };
+        /**
+         * @brief get the address the next instruction goes to
+         * @return address of the next instruction
+         */
+        [[nodiscard]] auto here() const noexcept -> uint64_t;
 
         /**
-         * @brief map for a region of the memory
-        */
-        struct memory_map
-        {
-            uint64_t magic;
+         * @brief create a label that is not bound to anything yet
+         * @return new label
+         */
+        auto make_label() -> label;
 
-            /** start of the memory map inside the file, if `clear` is set it is just ignored */
-            uint64_t start;
+        /**
+         * @brief bind a label to the next instruction
+         *
+         * @param target label to bind, binding it twice moves it
+         * @return this builder
+         */
+        auto bind(label target) -> ProgramBuilder &;
 
-            /** size of the memory map both in the file and the virtual memory, in bytes*/
-            uint64_t size;
+        /**
+         * @brief append a conditional jump to a label
+         *
+         * @param opcode one of `je_instrc` up to `jles_instrc`, comparing `rd` against `r1`
+         * @param reg1 first register
+         * @param regd register compared against the first
+         * @param target label to jump to
+         * @return this builder
+         */
+        auto branch(inspx opcode, uint64_t reg1, uint64_t regd, label target) -> ProgramBuilder &;
 
-            /** start of the memory map inside the virtual memory*/
-            uint64_t offset;
+        /**
+         * @brief append a `jal` to a label
+         *
+         * @param link register getting the return address
+         * @param target label to jump to
+         * @return this builder
+         */
+        auto jump(uint64_t link, label target) -> ProgramBuilder &;
 
-            /** flags for the memory region defined*/
-            memory_flags flags;
-        } __attribute__((aligned(sizeof(uint64_t))));
+        /**
+         * @brief select between two registers without branching
+         *
+         * takes an `orr` and a `cmovnz`, or a single conditional move when
+         * the destination already holds one of the values
+         *
+         * @param regd register getting the value, must not be `condition`
+         * @param condition register tested against zero
+         * @param if_true register picked when `condition` is not zero
+         * @param if_false register picked when `condition` is zero
+         * @return this builder
+         */
+        auto select(uint64_t regd, uint64_t condition, uint64_t if_true, uint64_t if_false) -> ProgramBuilder &;
 
-        /** master magic: "Zenithvm" */
-        constexpr auto const master_magic = 0x6D766874696E655ALLU;
+        /**
+         * @brief load a constant into a register
+         *
+         * values that fit in an S immediate take a single `ori`, anything
+         * else takes an `ori` for the low 13 bits and a `lui` for the rest
+         *
+         * @param reg register to load
+         * @param value value to load
+         * @return this builder
+         */
+        auto constant(uint64_t reg, uint64_t value) -> ProgramBuilder &;
 
-        /** memory map magic: "mem_map!" */
-        constexpr auto const memmap_magic = 0x2170616D5f6D656DLLU;
+        /**
+         * @brief load the address of a label into a register, always with `ori` and `lui`
+         *
+         * @param reg register to load
+         * @param target label whose address is loaded
+         * @return this builder
+         */
+        auto address(uint64_t reg, label target) -> ProgramBuilder &;
 
+        /**
+         * @brief call a label, `call` returns two instructions past itself so a filler follows it
+         *
+         * @param target function to call
+         * @param scratch register clobbered with the function address
+         * @param stack register holding the stack pointer
+         * @param base register holding the base pointer
+         * @return this builder
+         */
+        auto call(label target, uint64_t scratch, uint64_t stack = 2, uint64_t base = 3) -> ProgramBuilder &;
 
+        /**
+         * @brief append `pcall Halt`
+         * @return this builder
+         */
+        auto halt() -> ProgramBuilder &;
 
+        /**
+         * @brief add a region of data to memory
+         *
+         * @param address where the data goes in memory
+         * @param bytes contents of the region
+         * @param flags flags of the region, `mem_exists` is always added
+         * @return this builder
+         */
+        auto data(uint64_t address, std::vector<uint8_t> bytes,
+                  headers::memory_flags flags = static_cast<headers::memory_flags>(headers::mem_read | headers::mem_write)) -> ProgramBuilder &;
 
-        /** version: major(16bit):minor(16bit):patch(32bit)*/
-        constexpr auto const snvm_version = SUPERNOVA_VERSION_MAJOR << 48U | SUPERNOVA_VERSION_MINOR << 32 | SUPERNOVA_VERSION_PATCH;
+        /**
+         * @brief add a zeroed region to memory, it takes no space in the image
+         *
+         * @param address first byte of the region
+         * @param size size in bytes
+         * @return this builder
+         */
+        auto reserve(uint64_t address, uint64_t size) -> ProgramBuilder &;
 
-        enum read_status : uint8_t{
-            ReadOk,
-            FileNotFound,
-            InvalidHeader,
-            InvalidEntryPoint,
-            VersionMismatch,
-            MagicMismatch,
-            InvalidMemoryRegion,
-            FileError
-        };
+        /**
+         * @brief name the code starting at a label, written as a symbol table `profiler` reads
+         *
+         * @param start first instruction of the symbol, it reaches until the next symbol
+         * @param name symbol name
+         * @return this builder
+         */
+        auto symbol(label start, char const *name) -> ProgramBuilder &;
 
-        struct read_return {
-            std::unique_ptr<uint8_t[]> memory_pointer{nullptr};
-            uint64_t memory_size{0};
-            read_status status{ReadOk};
-            uint64_t entry_point{-1LLU};
-            read_return() = default;
-            explicit read_return(read_status stat, uint64_t mem_size=0, uint64_t entry=0, std::unique_ptr<uint8_t[]> memory = nullptr) 
-            : memory_pointer(std::move(memory)), memory_size{mem_size}, status{stat}, entry_point{entry} {}
-        };
+        /**
+         * @brief start the program at a label instead of the origin
+         *
+         * @param start label of the first instruction to run
+         * @return this builder
+         */
+        auto entry(label start) -> ProgramBuilder &;
 
-        auto read_file(char const * filename) -> read_return;
+        /**
+         * @brief set the memory given to the program
+         *
+         * @param size memory size in bytes, 0 picks the smallest multiple of 4KiB holding every region
+         * @return this builder
+         */
+        auto memory_size(uint64_t size) -> ProgramBuilder &;
 
-    }; // namespace headers
+        /**
+         * @brief fix every use of a label and check regions
+         * @return `BuildOk` or the first problem found
+         */
+        auto resolve() -> build_status;
 
-    /***/
-    using thread_return = std::pair<bool, int>;
+        /**
+         * @brief get the instructions appended so far, fixed up by `resolve`
+         * @return instructions, starting at the origin
+         */
+        [[nodiscard]] auto code() const noexcept -> std::vector<uint64_t> const &;
 
+        /**
+         * @brief lay the program out as an image file
+         *
+         * regions go into the file at the same offset inside a page as in
+         * memory, so `LoadMapped` can map them
+         *
+         * @param[out] image bytes of the image
+         * @return same as `resolve`
+         */
+        auto image(std::vector<uint8_t> &image) -> build_status;
 
+        /**
+         * @brief write the image to a file
+         *
+         * @param filename file to write
+         * @return same as `resolve`, or `WriteFailed`
+         */
+        auto write(char const *filename) -> build_status;
 
+        /**
+         * @brief lay the program out in memory, as `read_file` would after reading its image
+         * @return memory and entry point, `InvalidHeader` if the program does not resolve
+         */
+        auto load() -> headers::read_return;
 
-    /**
-     * @brief run code from a file
-     *
-     * @param argc main's argc
-     * @param[in] argv main's argv
-     * @param thread current thread to run
-     * @param step set to only run one instruction, defaults to false but used when testing
-     * @return exit codet
-     */
-    auto run(int argc, char **argv, Thread &thread, bool step = false) -> thread_return;
+    private:
+        std::unique_ptr<struct builder_state> m_state; /**< code, labels and regions */
+    };
 
     /** @} */ /* end of group Virtual Instrucion Set Emulation */
 
@@ -0,0 +1,136 @@
+#include "../supernova.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#endif
+/// this test checks what the ahead of time translator finds and translates in an image, then runs translated code against the interpreter
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x1000;
+
+    /** load a program, with its code as the only executable region */
+    auto make_image(ProgramBuilder &program) -> headers::read_return
+    {
+        using namespace headers;
+
+        auto image = program.memory_size(memory_size).load();
+        image.regions = std::make_unique<memory_map[]>(1);
+        image.regions[0] = {memmap_magic, 0, program.code().size() * sizeof(uint64_t), 0,
+                            static_cast<memory_flags>(mem_exists | mem_read | mem_execute)};
+        image.region_count = 1;
+        return image;
+    }
+
+    /**
+     * r1 = r6 + r7 after a `jalr` linking over its base, an interpreted store
+     * over code on another page that is then jumped to, and a translated store
+     * over the instruction right after it
+     */
+    auto build() -> ProgramBuilder
+    {
+        constexpr uint64_t origin = 0x1000;
+        constexpr uint64_t far_page = 0x2000;
+        ProgramBuilder program{origin};
+        auto far = program.make_label();
+
+        program.constant(6, 0).constant(7, 0);
+        // the target is relative to the link, two instructions past it
+        const auto jalr_at = program.here();
+        program.emit(SInstruction(jalr_instrc, 7, 7, -static_cast<int64_t>(jalr_at)))
+            .emit(SInstruction(addi_instrc, 6, 6, 100))
+            .emit(SInstruction(addi_instrc, 6, 6, 100));
+
+        program.constant(5, static_cast<uint64_t>(SInstruction(addi_instrc, 6, 6, 40)))
+            .address(4, far)
+            .emit(SInstruction(st_rel_instrc, 5, 4, 0))
+            .jump(0, far);
+        while (program.here() < far_page)
+        {
+            program.emit(SInstruction(addi_instrc, 0, 0, 0));
+        }
+
+        program.bind(far)
+            .emit(SInstruction(addi_instrc, 6, 6, 1))
+            .emit(SInstruction(st_dwrd_instrc, 5, 4, 2 * sizeof(uint64_t)))
+            .emit(SInstruction(addi_instrc, 6, 6, 2))
+            .emit(RInstruction(addr_instrc, 6, 7, 1))
+            .halt();
+        return program;
+    }
+
+    /** interpret the image and run its translation, both exit with the low byte of r1 */
+    auto run_case(char const *executable, char const *image_name) -> int
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        auto image = headers::read_file(image_name);
+        if (image.status != headers::ReadOk)
+        {
+            std::cerr << "== could not read " << image_name << '\n';
+            return 1;
+        }
+        auto thread = Thread{std::move(image.memory_pointer), image.memory_size, nullptr, image.entry_point};
+        run_for(thread, ~0ULL);
+        const auto interpreted = static_cast<int>(thread.registers(1) & 0xFFU);
+
+        const auto status = std::system((std::string{'"'} + executable + "\" \"" + image_name + '"').c_str());
+        const auto translated = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+
+        const auto result = thread.signal() != ProgramEnd || thread.registers(6) != 80 || translated != interpreted;
+        std::cerr << "== translated run: expected `" << interpreted << "`, got `" << translated << "`, " << (result ? "in" : "") << "correct\n";
+        return result;
+#else
+        static_cast<void>(executable);
+        static_cast<void>(image_name);
+        std::cerr << "== translated run: not supported by the host\n";
+        return 0;
+#endif
+    }
+} // namespace
+
+int aot(int argc, char **argv)
+{
+    // the build writes the image with `aot image` and translates it, ctest runs it with `aot run`
+    if (argc >= 3 && argv[1] == std::string("image"))
+    {
+        return build().write(argv[2]) != BuildOk;
+    }
+    if (argc >= 4 && argv[1] == std::string("run"))
+    {
+        return run_case(argv[2], argv[3]);
+    }
+
+    ProgramBuilder program{};
+    auto loop = program.make_label();
+    program.emit(SInstruction(addi_instrc, 0, 6, 10))
+        .bind(loop)
+        .emit(SInstruction(addi_instrc, 3, 3, 1))
+        .emit(RInstruction(addr_instrc, 3, 4, 4))
+        .emit(SInstruction(st_dwrd_instrc, 4, 0, 0x800))
+        .branch(jne_instrc, 6, 3, loop)
+        .emit(SInstruction(udivi_instrc, 3, 1, 2))
+        .halt()
+        // never reached, should not be translated
+        .emit(SInstruction(addi_instrc, 1, 1, 1));
+    const auto image = make_image(program);
+
+    std::ostringstream output;
+    const auto stats = aot::translate(image, "loop.spn", output);
+    const auto code = output.str();
+
+    auto result = stats.instructions != 7 || stats.translated != 5 || stats.interpreted != 2;
+    std::cerr << "== reachable instructions: expected `7/5/2`, got `" << stats.instructions << '/' << stats.translated << '/' << stats.interpreted << "`\n";
+
+    // the loop head is a direct jump target, the dead instruction has no case
+    result = result || code.find("i_8:") == std::string::npos || code.find("case 0x38LLU:") != std::string::npos;
+    result = result || code.find("int main(") == std::string::npos || code.find("\"loop.spn\"") == std::string::npos;
+    std::cerr << "== generated code: " << (result ? "in" : "") << "correct\n";
+
+    return result;
+}
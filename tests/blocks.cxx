@@ -0,0 +1,92 @@
+#include "../supernova.h"
+#include <iostream>
+#include <memory>
+/// this test checks the basic block engine, mostly blocks getting dropped by stores into them
+
+using namespace supernova;
+
+int check_patch_ahead()
+{
+    constexpr auto memory_size = 64;
+    auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[memory_size]{});
+    auto *code = reinterpret_cast<uint64_t *>(memory.get());
+
+    const auto patched = SInstruction(addi_instrc, 3, 3, 16);
+
+    // the store overwrites the instruction right after it, inside the block already running
+    code[0] = static_cast<uint64_t>(SInstruction(st_dwrd_instrc, 5, 0, 2 * sizeof(uint64_t)));
+    code[1] = static_cast<uint64_t>(SInstruction(addi_instrc, 4, 4, 1));
+    code[2] = static_cast<uint64_t>(SInstruction(addi_instrc, 3, 3, 1));
+    code[3] = static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+
+    Thread thread{std::move(memory), memory_size, nullptr};
+    thread.registers(5) = static_cast<uint64_t>(patched);
+
+    auto executed = uint64_t{0};
+    while (thread.signal() == DoNotDestroy)
+    {
+        executed += dispatch(thread, BlockDispatch, ~0LLU);
+    }
+
+    std::cerr << "== patching the running block: expected r3 = `16`, got `" << thread.registers(3) << "` in " << executed
+              << " instructions\n";
+
+    return thread.signal() != ProgramEnd || thread.registers(3) != 16 || thread.registers(4) != 1 || executed != 4;
+}
+
+int check_patch_loop()
+{
+    constexpr auto memory_size = 64;
+    auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[memory_size]{});
+    auto *code = reinterpret_cast<uint64_t *>(memory.get());
+
+    const auto patched = SInstruction(addi_instrc, 3, 3, 16);
+
+    // the loop body is a chained block, its second run needs to see the patched `addi`
+    code[0] = static_cast<uint64_t>(SInstruction(addi_instrc, 3, 3, 1));
+    code[1] = static_cast<uint64_t>(SInstruction(addi_instrc, 4, 4, 1));
+    code[2] = static_cast<uint64_t>(SInstruction(st_dwrd_instrc, 5, 0, 0));
+    code[3] = static_cast<uint64_t>(SInstruction(jne_instrc, 6, 4, -4 * sizeof(uint64_t)));
+    code[4] = static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+
+    Thread thread{std::move(memory), memory_size, nullptr};
+    thread.registers(5) = static_cast<uint64_t>(patched);
+    thread.registers(6) = 3;
+
+    while (thread.signal() == DoNotDestroy)
+    {
+        dispatch(thread, BlockDispatch, ~0LLU);
+    }
+
+    std::cerr << "== patching a chained loop: expected r3 = `33`, got `" << thread.registers(3) << "`\n";
+
+    return thread.signal() != ProgramEnd || thread.registers(3) != 33;
+}
+
+int check_budget()
+{
+    constexpr auto memory_size = 64;
+    auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[memory_size]{});
+    auto *code = reinterpret_cast<uint64_t *>(memory.get());
+
+    code[0] = static_cast<uint64_t>(SInstruction(addi_instrc, 3, 3, 1));
+    code[1] = static_cast<uint64_t>(SInstruction(addi_instrc, 3, 3, 1));
+    code[2] = static_cast<uint64_t>(SInstruction(addi_instrc, 3, 3, 1));
+    code[3] = static_cast<uint64_t>(LInstruction(jal_instrc, 0, -3 * sizeof(uint64_t)));
+
+    Thread thread{std::move(memory), memory_size, nullptr};
+
+    // budgets ending inside a block stop on the exact instruction
+    auto executed = dispatch(thread, BlockDispatch, 4);
+    executed += dispatch(thread, BlockDispatch, 5);
+
+    std::cerr << "== budget inside blocks: expected r3 = `7` at `0x18`, got `" << thread.registers(3) << "` at `0x" << std::hex
+              << thread.progc() << std::dec << "`\n";
+
+    return executed != 9 || thread.registers(3) != 7 || thread.progc() != 3 * sizeof(uint64_t);
+}
+
+int blocks(int, char **)
+{
+    return check_patch_ahead() + check_patch_loop() + check_budget();
+}
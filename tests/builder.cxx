@@ -0,0 +1,128 @@
+#include "../supernova.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+/// this test assembles programs with labels, constants and regions, then runs them from memory and from images
+
+using namespace supernova;
+using namespace supernova::headers;
+
+namespace
+{
+    constexpr uint64_t argument = 15;
+    constexpr uint64_t result = 610;
+    constexpr uint64_t big = 0xDEADBEEFCAFEBABE;
+    constexpr uint64_t table = 0x2000;
+    constexpr uint64_t stack = 0x3000;
+
+    /** recursive fibonacci into r1, a big constant into r7 and a double word from a data region into r8 */
+    auto build() -> ProgramBuilder
+    {
+        ProgramBuilder program{0x100};
+        auto fib = program.make_label();
+        auto recurse = program.make_label();
+
+        program.constant(2, stack)
+            .constant(4, argument)
+            .call(fib, 5)
+            .constant(7, big)
+            .emit(SInstruction(ld_dwrd_instrc, 0, 8, table + sizeof(uint64_t)))
+            .halt();
+
+        program.bind(fib)
+            .symbol(fib, "fib")
+            .emit(SInstruction(setleui_instrc, 4, 8, 1))
+            .branch(je_instrc, 0, 8, recurse)
+            .emit(RInstruction(addr_instrc, 4, 0, 1))
+            .emit(RInstruction(retn_instrc, 2, 3, 0));
+
+        program.bind(recurse)
+            .symbol(recurse, "recurse")
+            .emit(SInstruction(push_instrc, 2, 4, 0))
+            .emit(SInstruction(subi_instrc, 4, 4, 1))
+            .call(fib, 5)
+            .emit(SInstruction(pull_instrc, 2, 4, 0))
+            .emit(SInstruction(push_instrc, 2, 1, 0))
+            .emit(SInstruction(subi_instrc, 4, 4, 2))
+            .call(fib, 5)
+            .emit(SInstruction(pull_instrc, 2, 9, 0))
+            .emit(RInstruction(addr_instrc, 1, 9, 1))
+            .emit(RInstruction(retn_instrc, 2, 3, 0));
+
+        std::vector<uint8_t> bytes(2 * sizeof(uint64_t));
+        const uint64_t values[] = {1, 0x1234};
+        std::memcpy(bytes.data(), values, sizeof(values));
+
+        program.data(table, bytes).reserve(stack, 0x1000);
+        return program;
+    }
+
+    auto check(Thread &thread, char const *name) -> int
+    {
+        const auto ran = run_for(thread, ~0ULL);
+        const auto failed = ran.status != ProgramEnded || thread.registers(1) != result || thread.registers(7) != big || thread.registers(8) != 0x1234;
+        std::cerr << "== " << name << ": r1 = " << thread.registers(1) << ", r7 = " << std::hex << thread.registers(7) << ", r8 = "
+                  << thread.registers(8) << std::dec << ", " << (failed ? "in" : "") << "correct\n";
+        return failed ? 1 : 0;
+    }
+
+    /** programs laid out in memory run straight away */
+    auto memory_case() -> int
+    {
+        auto program = build();
+        auto image = program.load();
+        if (image.status != ReadOk)
+        {
+            std::cerr << "== program did not resolve\n";
+            return 1;
+        }
+
+        auto thread = Thread{std::move(image.memory_pointer), image.memory_size, nullptr, image.entry_point};
+        return check(thread, "from memory");
+    }
+
+    /** images read back, copied or mapped, run the same and carry their symbols */
+    auto image_case(load_mode mode) -> int
+    {
+        auto program = build();
+        if (program.write("builder.spn") != BuildOk)
+        {
+            std::cerr << "== could not write the image\n";
+            return 1;
+        }
+
+        auto image = read_file("builder.spn", mode);
+        if (image.status != ReadOk)
+        {
+            std::cerr << "== read_file status code = " << static_cast<int>(image.status) << '\n';
+            return 1;
+        }
+
+        auto profile = profiler{};
+        const auto symbols = profile.load_symbols("builder.spn", image);
+
+        auto thread = Thread{std::move(image.memory_pointer), image.memory_size, nullptr, image.entry_point};
+        return check(thread, mode == LoadCopy ? "copied image" : "mapped image") | (symbols != 2);
+    }
+
+    /** labels that are never bound and overlapping regions do not build */
+    auto error_case() -> int
+    {
+        ProgramBuilder unbound;
+        unbound.jump(0, unbound.make_label());
+
+        ProgramBuilder overlapping;
+        overlapping.halt().data(0x800, std::vector<uint8_t>(0x10)).reserve(0x808, 0x10);
+
+        ProgramBuilder outside;
+        outside.halt().memory_size(0x1000).reserve(0xF00, 0x200);
+
+        std::vector<uint8_t> bytes;
+        return unbound.resolve() != UnboundLabel || overlapping.image(bytes) != InvalidRegion || outside.resolve() != InvalidRegion;
+    }
+} // namespace
+
+int builder(int, char **)
+{
+    return memory_case() | image_case(LoadCopy) | image_case(LoadMapped) | error_case();
+}
@@ -0,0 +1,50 @@
+#include "../supernova.h"
+#include <iostream>
+/// this test builds min, max and abs out of group 5 conditional moves, with and without `ProgramBuilder::select`
+
+using namespace supernova;
+using namespace supernova::headers;
+
+int condmove(int, char **)
+{
+    ProgramBuilder program{0x100};
+    program.constant(3, 5)
+        .constant(4, 9)
+        .emit(RInstruction(setgur_instrc, 4, 3, 5))
+        // r6 = max, r7 = min, r8 and r9 already hold what they select
+        .select(6, 5, 4, 3)
+        .select(7, 5, 3, 4)
+        .constant(8, 100)
+        .select(8, 5, 8, 3)
+        .select(9, 0, 4, 9)
+        // r11 = |r10|
+        .emit(SInstruction(subi_instrc, 0, 10, 3))
+        .emit(RInstruction(orr_instrc, 10, 0, 11))
+        .emit(RInstruction(subr_instrc, 0, 10, 12))
+        .emit(RInstruction(cmovles_instrc, 12, 10, 11))
+        .emit(RInstruction(cmovgs_instrc, 10, 10, 12))
+        // r0 stays zero, immediates are sign extended
+        .emit(RInstruction(cmovnz_instrc, 4, 5, 0))
+        .emit(SInstruction(cmovzi_instrc, 0, 10, static_cast<uint64_t>(-7)))
+        .emit(SInstruction(cmovnzi_instrc, 0, 4, 1))
+        .halt();
+
+    auto image = program.load();
+    if (image.status != ReadOk)
+    {
+        std::cerr << "== program did not resolve\n";
+        return 1;
+    }
+
+    auto thread = Thread{std::move(image.memory_pointer), image.memory_size, nullptr, image.entry_point};
+    const auto ran = run_for(thread, ~0ULL);
+
+    const auto failed = ran.status != ProgramEnded || thread.registers(0) != 0 || thread.registers(6) != 9 || thread.registers(7) != 5 ||
+                        thread.registers(8) != 100 || thread.registers(9) != 0 || thread.registers(11) != 3 || thread.registers(12) != 3 ||
+                        static_cast<int64_t>(thread.registers(10)) != -7 || thread.registers(4) != 9 ||
+                        (config_value & confflags_condmove) == 0;
+
+    std::cerr << "== conditional moves: max = " << thread.registers(6) << ", min = " << thread.registers(7) << ", abs = "
+              << thread.registers(11) << ", " << (failed ? "in" : "") << "correct\n";
+    return failed ? 1 : 0;
+}
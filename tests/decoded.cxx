@@ -0,0 +1,59 @@
+#include "../supernova.h"
+#include <iostream>
+#include <memory>
+#include <iomanip>
+/// this test checks the decoded instruction cache, both decoding and invalidation on self modifying code
+
+using namespace supernova;
+
+int check_decoding()
+{
+    auto result = 0;
+
+    const auto rinstr = RInstruction(addr_instrc, 1, 2, 3);
+    const auto rdec = decode(static_cast<uint64_t>(rinstr));
+    result += rdec.opcode != addr_instrc || rdec.r1 != rinstr.r1() || rdec.r2 != rinstr.r2() || rdec.rd != rinstr.rd();
+
+    const auto sinstr = SInstruction(addi_instrc, 4, 5, -3LLU);
+    const auto sdec = decode(static_cast<uint64_t>(sinstr));
+    result += sdec.opcode != addi_instrc || sdec.r1 != sinstr.r1() || sdec.rd != sinstr.rd() || sdec.imm != -3 || sdec.uimm != sinstr.uimm();
+
+    auto linstr = LInstruction(jal_instrc, 6, -16LLU);
+    const auto ldec = decode(static_cast<uint64_t>(linstr));
+    result += ldec.opcode != jal_instrc || ldec.r1 != linstr.r1() || ldec.imm != linstr.imm() || ldec.uimm != linstr.uimm();
+
+    std::cerr << "== decoding R/S/L instructions: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_self_modifying()
+{
+    constexpr auto memory_size = 64;
+    auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[memory_size]{});
+    auto *code = reinterpret_cast<uint64_t *>(memory.get());
+
+    const auto patched = SInstruction(addi_instrc, 3, 3, 16);
+
+    // first pass runs the original `addi`, second pass needs to see the patched one
+    code[0] = static_cast<uint64_t>(SInstruction(addi_instrc, 3, 3, 1));
+    code[1] = static_cast<uint64_t>(SInstruction(addi_instrc, 4, 4, 1));
+    code[2] = static_cast<uint64_t>(SInstruction(st_dwrd_instrc, 5, 0, 0));
+    code[3] = static_cast<uint64_t>(SInstruction(jne_instrc, 6, 4, -4 * sizeof(uint64_t)));
+    code[4] = static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+
+    Thread thread{std::move(memory), memory_size, nullptr};
+    thread.registers(5) = static_cast<uint64_t>(patched);
+    thread.registers(6) = 2;
+
+    auto [ended, code_ret] = run(0, nullptr, thread);
+    static_cast<void>(code_ret);
+
+    std::cerr << "== self modifying loop: expected r3 = `17`, got `" << std::dec << thread.registers(3) << "`\n";
+
+    return !ended || thread.registers(3) != 17;
+}
+
+int decoded(int, char **)
+{
+    return check_decoding() + check_self_modifying();
+}
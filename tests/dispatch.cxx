@@ -0,0 +1,57 @@
+#include "../supernova.h"
+#include <iostream>
+#include <memory>
+/// this test runs the same program through every dispatch engine and compares the results
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x200;
+
+    auto make_thread() -> Thread
+    {
+        auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[memory_size]{});
+        auto *code = reinterpret_cast<uint64_t *>(memory.get());
+
+        // sums 1..10 into r5, keeping a running copy in memory
+        code[0] = static_cast<uint64_t>(SInstruction(addi_instrc, 0, 6, 10));
+        code[1] = static_cast<uint64_t>(SInstruction(addi_instrc, 3, 3, 1));
+        code[2] = static_cast<uint64_t>(RInstruction(addr_instrc, 5, 3, 5));
+        code[3] = static_cast<uint64_t>(SInstruction(st_dwrd_instrc, 5, 0, 0x100));
+        code[4] = static_cast<uint64_t>(SInstruction(jne_instrc, 6, 3, -4 * sizeof(uint64_t)));
+        code[5] = static_cast<uint64_t>(SInstruction(ld_dwrd_instrc, 0, 7, 0x100));
+        code[6] = static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+
+        return Thread{std::move(memory), memory_size, nullptr};
+    }
+} // namespace
+
+int dispatch(int, char **)
+{
+    auto result = 0;
+
+    for (auto engine : {SwitchDispatch, TailCallDispatch, GotoDispatch, BlockDispatch})
+    {
+        auto thread = make_thread();
+
+        // a budget needs to stop the engine on the exact instruction
+        const auto partial = supernova::dispatch(thread, engine, 3);
+        result += partial != 3 || thread.progc() != 3 * sizeof(uint64_t);
+
+        auto executed = partial;
+        while (thread.signal() == DoNotDestroy)
+        {
+            executed += supernova::dispatch(thread, engine, ~0LLU);
+        }
+
+        const auto failed = thread.signal() != ProgramEnd || thread.registers(5) != 55 || thread.registers(7) != 55 || executed != 43;
+        std::cerr << "== engine " << static_cast<int>(engine) << (dispatch_available(engine) ? "" : " (fallback)")
+                  << ": r5 = " << thread.registers(5) << ", r7 = " << thread.registers(7) << ", " << executed
+                  << " instructions, " << (failed ? "in" : "") << "correct\n";
+
+        result += failed;
+    }
+
+    return result;
+}
@@ -0,0 +1,95 @@
+#include "../supernova.h"
+#include <cmath>
+#include <iostream>
+/// this test runs group 4 through conversions, arithmetic, compares and rounding, then forks the float registers
+
+using namespace supernova;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x1000;
+
+    auto make_thread(ProgramBuilder &program) -> Thread
+    {
+        program.memory_size(memory_size);
+        auto image = program.load();
+        auto thread = Thread{std::move(image.memory_pointer), memory_size, nullptr, image.entry_point};
+        thread.registers(1) = 0xC00;
+        return thread;
+    }
+} // namespace
+
+int check_float_program()
+{
+    ProgramBuilder program{};
+    program.emit(SInstruction(addi_instrc, 0, 3, 7))
+        .emit(SInstruction(subi_instrc, 0, 4, 2))
+        .emit(RInstruction(flt_ldu_instrc, 3, 0, 1))
+        .emit(RInstruction(flt_lds_instrc, 4, 0, 2))
+        .emit(RInstruction(flt_div_instrc, 1, 2, 3))
+        .emit(RInstruction(flt_mul_instrc, 3, 2, 4))
+        .emit(RInstruction(flt_add_instrc, 3, 1, 5))
+        .emit(RInstruction(flt_sub_instrc, 2, 1, 6))
+        .emit(SInstruction(flt_rou_instrc, 3, 7, 0))
+        .emit(SInstruction(flt_flr_instrc, 5, 8, 0))
+        .emit(SInstruction(flt_cei_instrc, 3, 9, 0))
+        .emit(SInstruction(flt_trn_instrc, 3, 10, 0))
+        .emit(RInstruction(flt_sts_instrc, 7, 0, 5))
+        .emit(RInstruction(flt_stu_instrc, 8, 0, 6))
+        .emit(RInstruction(flt_stu_instrc, 2, 0, 7))
+        .emit(RInstruction(flt_ceq_instrc, 4, 1, 8))
+        .emit(RInstruction(flt_cgt_instrc, 3, 2, 9))
+        .emit(RInstruction(flt_cle_instrc, 3, 2, 10))
+        // 0 / 0 is NaN, unordered with everything including itself
+        .emit(RInstruction(flt_div_instrc, 0, 0, 11))
+        .emit(RInstruction(flt_cne_instrc, 11, 11, 11))
+        .emit(RInstruction(flt_ceq_instrc, 11, 11, 12))
+        .emit(RInstruction(flt_sts_instrc, 11, 0, 13))
+        .halt();
+    auto thread = make_thread(program);
+
+    run(0, nullptr, thread);
+
+    const auto result = thread.signal() != ProgramEnd || thread.pcall() != ProcessorCall::NormalExecution ||
+                        thread.floats(3) != -3.5 || thread.floats(4) != 7.0 || thread.floats(5) != 3.5 || thread.floats(6) != -9.0 ||
+                        thread.floats(7) != -4.0 || thread.floats(8) != 3.0 || thread.floats(9) != -3.0 || thread.floats(10) != -3.0 ||
+                        !std::isnan(thread.floats(11)) || static_cast<int64_t>(thread.registers(5)) != -4 || thread.registers(6) != 3 ||
+                        thread.registers(7) != 0 || thread.registers(8) != 1 || thread.registers(9) != 0 || thread.registers(10) != 1 ||
+                        thread.registers(11) != 1 || thread.registers(12) != 0 || thread.registers(13) != 0;
+
+    std::cerr << "== float program: fr3 = `" << thread.floats(3) << "`, r5 = `" << static_cast<int64_t>(thread.registers(5)) << "`, "
+              << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_float_saturation()
+{
+    ProgramBuilder program{};
+    // ~0 converts to 2^64, which no signed nor unsigned double word holds
+    program.emit(SInstruction(subi_instrc, 0, 3, 1))
+        .emit(RInstruction(flt_ldu_instrc, 3, 0, 1))
+        .emit(RInstruction(flt_stu_instrc, 1, 0, 4))
+        .emit(RInstruction(flt_sts_instrc, 1, 0, 5))
+        .emit(RInstruction(flt_sub_instrc, 0, 1, 2))
+        .emit(RInstruction(flt_sts_instrc, 2, 0, 6))
+        .halt();
+    auto thread = make_thread(program);
+
+    run(0, nullptr, thread);
+
+    const auto forked = Thread::fork_from(thread.snapshot());
+    auto copy = forked.snapshot();
+    auto again = Thread::fork_from(copy);
+
+    const auto result = thread.registers(4) != ~0ULL || thread.registers(5) != static_cast<uint64_t>(INT64_MAX) ||
+                        thread.registers(6) != static_cast<uint64_t>(INT64_MIN) || again.floats(1) != thread.floats(1) ||
+                        again.floats(2) != thread.floats(2);
+
+    std::cerr << "== float saturation: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int floats(int, char **)
+{
+    return check_float_program() + check_float_saturation();
+}
@@ -0,0 +1,170 @@
+#include "../supernova.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+/// this test runs fused instruction pairs against the same code without fusion, stepping, faulting and rewriting them
+
+using namespace supernova;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x1000;
+    constexpr uint64_t handler = 0x800;
+
+    /** every fused pair, in a loop, with a data walk and a call */
+    auto build() -> ProgramBuilder
+    {
+        ProgramBuilder program;
+        auto loop = program.make_label();
+        auto done = program.make_label();
+        auto function = program.make_label();
+
+        program.constant(2, 0x400)
+            .constant(7, 0xFEDCBA9876543210)
+            .emit(LInstruction(lui_instrc, 8, 0x12))
+            .emit(SInstruction(addi_instrc, 8, 8, 0x34))
+            .constant(10, 0x600)
+            .emit(SInstruction(addi_instrc, 0, 6, 20));
+
+        program.bind(loop)
+            .emit(SInstruction(setleui_instrc, 6, 9, 0))
+            .branch(jne_instrc, 0, 9, done)
+            .emit(SInstruction(push_instrc, 2, 6, 0))
+            .emit(SInstruction(push_instrc, 2, 7, 1))
+            .emit(SInstruction(push_instrc, 2, 8, 0))
+            .call(function, 5)
+            .emit(SInstruction(pull_instrc, 2, 11, 0))
+            .emit(SInstruction(pull_instrc, 2, 12, 0))
+            .emit(SInstruction(pull_instrc, 2, 13, 0))
+            .emit(SInstruction(ld_dwrd_instrc, 10, 4, 0))
+            .emit(SInstruction(addi_instrc, 10, 10, sizeof(uint64_t)))
+            .emit(RInstruction(addr_instrc, 1, 4, 1))
+            .emit(RInstruction(addr_instrc, 1, 13, 1))
+            .emit(RInstruction(setgur_instrc, 13, 0, 9))
+            .branch(je_instrc, 0, 9, done)
+            .emit(SInstruction(subi_instrc, 6, 6, 1))
+            .jump(0, loop);
+
+        program.bind(done).halt();
+
+        program.bind(function)
+            .emit(SInstruction(addi_instrc, 14, 14, 1))
+            .emit(RInstruction(retn_instrc, 2, 3, 0));
+
+        std::vector<uint8_t> data(20 * sizeof(uint64_t));
+        for (size_t i = 0; i < data.size(); i += sizeof(uint64_t))
+        {
+            data[i] = static_cast<uint8_t>(i);
+        }
+        program.data(0x600, data).memory_size(memory_size);
+        return program;
+    }
+
+    auto make_thread(ProgramBuilder &program, bool fusion) -> Thread
+    {
+        auto image = program.load();
+        auto thread = Thread{std::move(image.memory_pointer), image.memory_size, nullptr, image.entry_point};
+        thread.use_fusion(fusion);
+        return thread;
+    }
+
+    auto same(Thread &left, Thread &right) -> bool
+    {
+        return left.allregs() == right.allregs() && left.progc() == right.progc() && left.pcall() == right.pcall() &&
+               left.signal() == right.signal();
+    }
+
+    /** full runs and single steps end up in the same state, fused or not */
+    auto equivalence_case() -> int
+    {
+        auto program = build();
+        auto plain = make_thread(program, false);
+        auto fused = make_thread(program, true);
+        auto stepped = make_thread(program, true);
+
+        const auto expected = run_for(plain, ~0ULL);
+        const auto got = run_for(fused, ~0ULL);
+
+        uint64_t steps = 0;
+        while (run_for(stepped, 1).status == BudgetExhausted)
+        {
+            ++steps;
+        }
+        ++steps;
+
+        auto failed = expected.status != ProgramEnded || got.status != ProgramEnded || got.executed != expected.executed ||
+                      steps != expected.executed || !same(plain, fused) || !same(plain, stepped);
+
+#ifdef SUPERNOVA_STATS
+        // halves count as their own opcodes, pairs are counted on top
+        uint64_t pairs = 0;
+        for (auto count : fused.stats().fused)
+        {
+            pairs += count;
+        }
+        failed = failed || pairs == 0 || plain.stats().fused != execution_stats{}.fused || fused.stats().opcodes != plain.stats().opcodes;
+#endif
+        std::cerr << "== " << expected.executed << " instructions, fused run " << got.executed << ", stepped " << steps
+                  << ", r1 = " << fused.registers(1) << ", " << (failed ? "in" : "") << "correct\n";
+        return failed ? 1 : 0;
+    }
+
+    /** a fault on either half of a pair stops right there */
+    auto fault_case(uint64_t stack) -> int
+    {
+        ProgramBuilder program;
+        program.emit(SInstruction(push_instrc, 2, 4, 0)).emit(SInstruction(push_instrc, 2, 5, 0)).halt();
+
+        // the handler address, then the handler itself
+        const uint64_t vector[] = {handler + sizeof(uint64_t), static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt))};
+        std::vector<uint8_t> data(sizeof(vector));
+        std::memcpy(data.data(), vector, sizeof(vector));
+        program.data(handler, data).memory_size(memory_size);
+
+        Thread threads[] = {make_thread(program, false), make_thread(program, true)};
+        for (auto &thread : threads)
+        {
+            thread.intvec() = handler - ProcessorCall::MemoryLimit * sizeof(uint64_t);
+            thread.registers(1) = 0x400;
+            thread.registers(2) = stack;
+            thread.registers(4) = 4;
+            thread.registers(5) = 5;
+            run_for(thread, ~0ULL);
+        }
+
+        const auto failed = !same(threads[0], threads[1]) || threads[1].pcall() != ProcessorCall::MemoryLimit;
+        std::cerr << "== fault with the stack at " << std::hex << stack << ": pc = " << threads[1].progc() << std::dec << ", "
+                  << (failed ? "in" : "") << "correct\n";
+        return failed ? 1 : 0;
+    }
+
+    /** rewriting the second half of a pair is seen on the next pass */
+    auto rewrite_case() -> int
+    {
+        const auto patched = SInstruction(umuli_instrc, 3, 3, 16);
+
+        ProgramBuilder program;
+        auto loop = program.make_label();
+        program.constant(5, static_cast<uint64_t>(patched)).emit(SInstruction(addi_instrc, 0, 6, 2));
+        program.bind(loop).emit(LInstruction(lui_instrc, 7, 0));
+
+        // first pass adds 1, the second one multiplies by 16
+        const auto target = program.here();
+        program.emit(SInstruction(addi_instrc, 3, 3, 1))
+            .emit(SInstruction(st_dwrd_instrc, 5, 0, target))
+            .emit(SInstruction(addi_instrc, 4, 4, 1))
+            .branch(jne_instrc, 6, 4, loop)
+            .halt();
+
+        auto thread = make_thread(program, true);
+        run_for(thread, ~0ULL);
+
+        std::cerr << "== rewritten second half: r3 = " << thread.registers(3) << '\n';
+        return thread.registers(3) != 16;
+    }
+} // namespace
+
+int fusion(int, char **)
+{
+    return equivalence_case() | fault_case(memory_size) | fault_case(memory_size - sizeof(uint64_t)) | rewrite_case();
+}
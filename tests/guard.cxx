@@ -0,0 +1,121 @@
+#include "../supernova.h"
+#include <iostream>
+#include <memory>
+#include <vector>
+/// this test runs faulting programs on checked and guarded memory with every engine, expecting the same results and instruction counts
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x2000;
+    constexpr auto handler = 0x400;
+    constexpr auto stack = 0x1800;
+
+    /** code at 0, a `MemoryLimit` handler setting r3 = 1 and halting */
+    auto make_thread(std::vector<uint64_t> const &code, uint64_t size) -> Thread
+    {
+        auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[size]{});
+        auto *words = reinterpret_cast<uint64_t *>(memory.get());
+        std::copy(code.begin(), code.end(), words);
+
+        words[ProcessorCall::MemoryLimit] = handler;
+        words[handler / sizeof(uint64_t) + 0] = static_cast<uint64_t>(SInstruction(addi_instrc, 0, 3, 1));
+        words[handler / sizeof(uint64_t) + 1] = static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+
+        auto thread = Thread{std::move(memory), size, nullptr};
+        thread.registers(1) = stack;
+        return thread;
+    }
+
+    auto compare(const char *name, uint64_t entry, std::vector<uint64_t> const &code, uint64_t size = memory_size) -> int
+    {
+        auto result = false;
+        auto has_guard = true;
+        uint64_t executed = 0;
+
+        for (const auto engine : {SwitchDispatch, TailCallDispatch, GotoDispatch, BlockDispatch})
+        {
+            if (!dispatch_available(engine))
+            {
+                continue;
+            }
+
+            auto checked = make_thread(code, size);
+            auto guarded = make_thread(code, size);
+            checked.progc() = entry;
+            guarded.progc() = entry;
+
+            has_guard = guarded.use_guard_pages();
+
+            // a fault ends the guarded run early, the count has to match what ran
+            const auto checked_run = run_for(checked, ~0ULL, engine);
+            const auto guarded_run = run_for(guarded, ~0ULL, engine);
+            executed = guarded_run.executed;
+
+            result = result || checked.signal() != guarded.signal() || checked.progc() != guarded.progc() || checked.registers(3) != 1 ||
+                     checked_run.status != guarded_run.status || checked_run.executed != guarded_run.executed;
+            for (auto i = 0; i < Thread::register_count; ++i)
+            {
+                result = result || checked.registers(i) != guarded.registers(i);
+            }
+        }
+
+        std::cerr << "== " << name << (has_guard ? "" : " (no guard pages)") << ": " << executed << " instructions, " << (result ? "in" : "")
+                  << "correct\n";
+        return result;
+    }
+
+    const auto halt = static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+} // namespace
+
+int guard(int, char **)
+{
+    auto result = 0;
+    constexpr auto entry = 0x100;
+    constexpr auto words = entry / sizeof(uint64_t);
+
+    std::vector<uint64_t> code(words, 0);
+
+    // a load far out of range
+    code.push_back(static_cast<uint64_t>(SInstruction(addi_instrc, 0, 4, 7)));
+    code.push_back(static_cast<uint64_t>(SInstruction(ld_dwrd_instrc, 0, 5, -8LLU)));
+    code.push_back(halt);
+    result += compare("load out of range", entry, code);
+
+    // a store starting inside memory and ending past it
+    code.resize(words);
+    code.push_back(static_cast<uint64_t>(SInstruction(addi_instrc, 0, 4, memory_size - 4)));
+    code.push_back(static_cast<uint64_t>(SInstruction(st_dwrd_instrc, 4, 4, 0)));
+    code.push_back(halt);
+    result += compare("store crossing the end", entry, code);
+
+    // the last bytes are still accessible
+    code.resize(words);
+    code.push_back(static_cast<uint64_t>(SInstruction(addi_instrc, 0, 4, memory_size - 8)));
+    code.push_back(static_cast<uint64_t>(SInstruction(st_dwrd_instrc, 4, 4, 0)));
+    code.push_back(static_cast<uint64_t>(SInstruction(ld_dwrd_instrc, 4, 5, 0)));
+    code.push_back(static_cast<uint64_t>(SInstruction(subr_instrc, 5, 4, 3)));
+    code.push_back(static_cast<uint64_t>(SInstruction(addi_instrc, 3, 3, 1)));
+    code.push_back(halt);
+    result += compare("last bytes", entry, code);
+
+    // memory not ending on a double word still starts aligned for atomics, and still ends where it should
+    constexpr auto odd_size = memory_size - 4;
+    code.resize(words);
+    code.push_back(static_cast<uint64_t>(SInstruction(addi_instrc, 0, 4, odd_size - 12)));
+    code.push_back(static_cast<uint64_t>(SInstruction(addi_instrc, 0, 6, 2)));
+    code.push_back(static_cast<uint64_t>(RInstruction(xadd_instrc, 4, 6, 5)));
+    code.push_back(static_cast<uint64_t>(RInstruction(xadd_instrc, 4, 6, 5)));
+    code.push_back(static_cast<uint64_t>(SInstruction(subi_instrc, 5, 3, 1)));
+    code.push_back(halt);
+    result += compare("atomics on odd sized memory", entry, code, odd_size);
+
+    code.resize(words);
+    code.push_back(static_cast<uint64_t>(SInstruction(addi_instrc, 0, 4, odd_size - 4)));
+    code.push_back(static_cast<uint64_t>(SInstruction(ld_dwrd_instrc, 4, 5, 0)));
+    code.push_back(halt);
+    result += compare("load crossing an odd end", entry, code, odd_size);
+
+    return result;
+}
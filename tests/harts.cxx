@@ -0,0 +1,102 @@
+#include "../supernova.h"
+#include <iostream>
+#include <memory>
+/// this test runs harts over shared memory, counting with atomics and inside a spinlock
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x1000;
+    constexpr auto hart_count = 4;
+    constexpr uint64_t iterations = 500;
+
+    constexpr uint64_t counter_address = 0x800;
+    constexpr uint64_t lock_address = 0x808;
+    constexpr uint64_t plain_address = 0x810;
+
+    /** every iteration adds one to the counter with `xadd` and one to a plain double word under a lock */
+    auto make_memory() -> std::unique_ptr<uint8_t[], memory_deleter>
+    {
+        ProgramBuilder program{};
+        auto loop = program.make_label();
+        auto lock = program.make_label();
+        program.emit(SInstruction(addi_instrc, 0, 4, counter_address))
+            .emit(SInstruction(addi_instrc, 0, 5, 1))
+            .emit(SInstruction(addi_instrc, 0, 6, iterations))
+            .emit(SInstruction(addi_instrc, 0, 7, lock_address))
+            .emit(SInstruction(addi_instrc, 0, 8, plain_address))
+            .bind(loop)
+            .emit(RInstruction(xadd_instrc, 4, 5, 9))
+            .bind(lock)
+            .emit(SInstruction(andi_instrc, 0, 10, 0))
+            .emit(RInstruction(cas_instrc, 7, 5, 10))
+            .branch(jne_instrc, 0, 10, lock)
+            .emit(SInstruction(ld_dwrd_instrc, 8, 11, 0))
+            .emit(SInstruction(addi_instrc, 11, 11, 1))
+            .emit(SInstruction(st_dwrd_instrc, 11, 8, 0))
+            .emit(SInstruction(st_rel_instrc, 0, 7, 0))
+            .emit(SInstruction(addi_instrc, 3, 3, 1))
+            .branch(jne_instrc, 6, 3, loop)
+            .emit(RInstruction(fence_seq_instrc, 0, 0, 0))
+            .emit(SInstruction(ld_acq_instrc, 4, 1, 0))
+            .halt()
+            .memory_size(memory_size);
+        return program.load().memory_pointer;
+    }
+
+    /** atomics on unaligned double words raise `UnalignedAccess` */
+    auto unaligned_case() -> int
+    {
+        ProgramBuilder program{};
+        program.emit(SInstruction(ld_acq_instrc, 0, 1, counter_address + 1)).memory_size(memory_size);
+
+        Thread thread{program.load().memory_pointer, memory_size, nullptr};
+        thread.registers(1) = memory_size - sizeof(uint64_t);
+        dispatch(thread, SwitchDispatch, 1);
+
+        const auto failed = thread.pcall() != ProcessorCall::UnalignedAccess;
+        std::cerr << "== unaligned atomic: " << (failed ? "in" : "") << "correct\n";
+        return failed;
+    }
+} // namespace
+
+int harts(int, char **)
+{
+    auto result = unaligned_case();
+    result += (config_value & confflags_fences) == 0;
+
+    auto main = std::make_unique<Thread>(make_memory(), memory_size, nullptr);
+
+    // a small quantum preempts harts in the middle of the critical section
+    supernova::scheduler pool{hart_count, 5};
+    for (auto i = 0; i < hart_count; ++i)
+    {
+        pool.submit(std::make_unique<Thread>(main->hart(0)));
+    }
+
+    // harts keep memory alive on their own
+    main.reset();
+
+    std::unique_ptr<Thread> last{};
+    for (auto i = 0; i < hart_count; ++i)
+    {
+        auto done = pool.wait();
+        result += !done.result.first;
+        last = std::move(done.thread);
+    }
+
+    // NOLINTNEXTLINE: test memory
+    auto const *words = reinterpret_cast<uint64_t const *>(last->memory().get());
+    const auto expected = hart_count * iterations;
+    if (words[counter_address / 8] != expected || words[plain_address / 8] != expected || words[lock_address / 8] != 0)
+    {
+        std::cerr << "== expected `" << expected << "`, got `" << words[counter_address / 8] << "` and `" << words[plain_address / 8] << "`\n";
+        ++result;
+    }
+
+    result += last->use_guard_pages() && last->backend() != GuardedMemory;
+
+    std::cerr << "== " << hart_count << " harts over shared memory: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
@@ -0,0 +1,239 @@
+#include "../supernova.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+/// this test opens, reads, writes and closes files through a hosted ring, first from a guest and then batched from the host, then reads over paged code memory moved after setup
+
+using namespace supernova;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x2000;
+    constexpr uint64_t ring = 0x1000;
+    constexpr uint64_t entries = 4;
+    constexpr uint64_t input_path = 0x300;
+    constexpr uint64_t output_path = 0x340;
+    constexpr uint64_t buffer = 0x400;
+    constexpr auto input_name = "hosted_input.txt";
+    constexpr auto output_name = "hosted_output.txt";
+
+    /** zero terminated bytes of a string */
+    auto bytes_of(char const *text) -> std::vector<uint8_t> { return {text, text + std::strlen(text) + 1}; }
+
+    /** load a program with both file names in memory */
+    auto make_thread(ProgramBuilder &program) -> Thread
+    {
+        program.data(input_path, bytes_of(input_name)).data(output_path, bytes_of(output_name)).memory_size(memory_size);
+        auto image = program.load();
+        auto thread = Thread{std::move(image.memory_pointer), memory_size, nullptr, image.entry_point};
+        thread.registers(1) = 0xC00;
+        return thread;
+    }
+
+    auto words_at(Thread &thread, uint64_t address) -> uint64_t * { return reinterpret_cast<uint64_t *>(thread.memory().get() + address); }
+
+    /** queue a request the way a guest would, on the submission tail */
+    void submit(Thread &thread, uint64_t address, uint64_t count, hosted_request request)
+    {
+        auto *header = words_at(thread, address);
+        auto *requests = reinterpret_cast<hosted_request *>(header + hosted_ring::header_size / sizeof(uint64_t));
+        requests[header[1] % count] = request;
+        ++header[1];
+    }
+
+    /** move the completion head past reaped completions, with release like a guest `strel` */
+    void reap(Thread &thread, uint64_t address, uint64_t head) { __atomic_store_n(words_at(thread, address) + 2, head, __ATOMIC_RELEASE); }
+
+    /** take the result of the completion with the given user data off the unreaped ones */
+    auto result_of(Thread &thread, uint64_t address, uint64_t count, uint64_t user_data) -> int64_t
+    {
+        auto *header = words_at(thread, address);
+        auto *completions = reinterpret_cast<hosted_completion *>(header + hosted_ring::header_size / sizeof(uint64_t) +
+                                                                  count * sizeof(hosted_request) / sizeof(uint64_t));
+        for (auto index = header[2]; index != header[3]; ++index)
+        {
+            if (completions[index % count].user_data == user_data)
+            {
+                return completions[index % count].result;
+            }
+        }
+        return -1000;
+    }
+
+    /** call a hosted hyper function, `pcall -1` space 3 */
+    auto hosted_call(ProgramBuilder &program, uint64_t function) -> ProgramBuilder &
+    {
+        return program.constant(Thread::pcall_reg, (3ULL << 32U) | function).emit(LInstruction(pcall_instrc, 0, ProcessorCall::Functions));
+    }
+} // namespace
+
+int check_hosted_guest()
+{
+    {
+        auto *file = std::fopen(input_name, "wb");
+        std::fputs("hello world", file);
+        std::fclose(file);
+    }
+
+    ProgramBuilder program{};
+    hosted_call(program, 0).emit(RInstruction(orr_instrc, Thread::pcall_1stret, 0, 3)).emit(RInstruction(orr_instrc, Thread::pcall_2ndret, 0, 4));
+    program.constant(Thread::pcall_1stret, ring).constant(Thread::pcall_2ndret, entries);
+    hosted_call(program, 1)
+        // three requests are already queued, publish them and wait for all of them
+        .constant(5, 3)
+        .emit(SInstruction(st_rel_instrc, 5, 0, ring + 8))
+        .constant(Thread::pcall_1stret, 3);
+    hosted_call(program, 2).emit(RInstruction(orr_instrc, Thread::pcall_1stret, 0, 6)).emit(SInstruction(ld_acq_instrc, 0, 7, ring + 24)).halt();
+
+    auto thread = make_thread(program);
+    auto hosted = hosted_ring{};
+    thread.use_hosted(&hosted);
+
+    auto *requests = reinterpret_cast<hosted_request *>(words_at(thread, ring + hosted_ring::header_size));
+    requests[0] = hosted_request{HostedOpen, 0, input_path, 0x40, HostedReadOnly, 1};
+    requests[1] = hosted_request{HostedNop, 0, 0, 0, 0, 2};
+    requests[2] = hosted_request{HostedOpen, 0, output_path, 0x40, HostedWriteOnly | HostedCreate | HostedTruncate, 3};
+
+    run(0, nullptr, thread);
+
+    const auto input = result_of(thread, ring, entries, 1);
+    const auto output = result_of(thread, ring, entries, 3);
+    auto result = thread.pcall() != NormalExecution || thread.registers(3) != 1 || thread.registers(4) != hosted.functions().version ||
+                  thread.registers(6) != 3 || thread.registers(7) != 3 || words_at(thread, ring)[0] != 3 || input < 0 || output < 0 ||
+                  result_of(thread, ring, entries, 2) != 0;
+    std::cerr << "== hosted guest: opened " << input << " and " << output << ", " << (result ? "in" : "") << "correct\n";
+    if (result)
+    {
+        return 1;
+    }
+
+    // the guest reaped everything, the next batch wraps around the queues
+    std::strcpy(reinterpret_cast<char *>(thread.memory().get() + buffer + 0x20), "abcde");
+    reap(thread, ring, 3);
+    submit(thread, ring, entries, hosted_request{HostedRead, static_cast<uint64_t>(input), buffer, 5, 0, 4});
+    submit(thread, ring, entries, hosted_request{HostedRead, static_cast<uint64_t>(input), buffer + 0x10, 5, 6, 5});
+    submit(thread, ring, entries, hosted_request{HostedWrite, static_cast<uint64_t>(output), buffer + 0x20, 5, ~0ULL, 6});
+    submit(thread, ring, entries, hosted_request{HostedRead, static_cast<uint64_t>(input), memory_size - 2, 5, 0, 7});
+    result = hosted.enter(thread, entries) != entries || result_of(thread, ring, entries, 4) != 5 || result_of(thread, ring, entries, 5) != 5 ||
+             result_of(thread, ring, entries, 6) != 5 || result_of(thread, ring, entries, 7) >= 0 ||
+             std::memcmp(thread.memory().get() + buffer, "hello", 5) != 0 || std::memcmp(thread.memory().get() + buffer + 0x10, "world", 5) != 0;
+
+    reap(thread, ring, 7);
+    submit(thread, ring, entries, hosted_request{HostedClose, static_cast<uint64_t>(input), 0, 0, 0, 8});
+    submit(thread, ring, entries, hosted_request{HostedClose, static_cast<uint64_t>(output), 0, 0, 0, 9});
+    submit(thread, ring, entries, hosted_request{0xFF, 0, 0, 0, 0, 10});
+    result = result || hosted.enter(thread, 3) != 3 || result_of(thread, ring, entries, 8) != 0 || result_of(thread, ring, entries, 9) != 0 ||
+             result_of(thread, ring, entries, 10) >= 0;
+
+    char written[8] = {};
+    auto *file = std::fopen(output_name, "rb");
+    result = result || file == nullptr || std::fread(written, 1, sizeof(written), file) != 5 || std::strcmp(written, "abcde") != 0;
+    if (file != nullptr)
+    {
+        std::fclose(file);
+    }
+    std::remove(input_name);
+    std::remove(output_name);
+
+    std::cerr << "== hosted batches: read `" << std::string(reinterpret_cast<char *>(thread.memory().get() + buffer), 5) << "`, "
+              << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_hosted_overflow()
+{
+    constexpr uint64_t small = 2;
+    ProgramBuilder program{};
+    auto thread = make_thread(program);
+    auto hosted = hosted_ring{default_hosted_functions(), 1};
+
+    // misplaced rings are refused
+    auto result = hosted.setup(thread, ring + 4, small) || hosted.setup(thread, ring, 3) || hosted.setup(thread, memory_size - 8, small) ||
+                  hosted.enter(thread, 1) != 0 || !hosted.setup(thread, ring, small);
+
+    submit(thread, ring, small, hosted_request{HostedNop, 0, 0, 0, 0, 1});
+    submit(thread, ring, small, hosted_request{HostedNop, 0, 0, 0, 0, 2});
+    result = result || hosted.enter(thread, small) != small;
+
+    // with nothing reaped the next completions wait on the host
+    submit(thread, ring, small, hosted_request{HostedNop, 0, 0, 0, 0, 3});
+    submit(thread, ring, small, hosted_request{HostedNop, 0, 0, 0, 0, 4});
+    result = result || hosted.enter(thread, small) != small || words_at(thread, ring)[3] != small;
+
+    reap(thread, ring, small);
+    result = result || hosted.enter(thread, small) != 0 || words_at(thread, ring)[3] != 2 * small || result_of(thread, ring, small, 3) != 0 ||
+             result_of(thread, ring, small, 4) != 0;
+
+    std::cerr << "== hosted overflow: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_hosted_code()
+{
+    constexpr uint64_t paged_size = 0x10000;
+    constexpr uint64_t root = 0x8000;
+    constexpr uint64_t code_frame = 0x3000;
+    constexpr uint64_t ring_page = 0x1000;
+    constexpr uint64_t ring_frame = 0x4000;
+
+    // r8 += 1 twice, unless the read lands over the first instruction after it ran once
+    ProgramBuilder program{code_frame};
+    const auto start = program.make_label();
+    const auto done = program.make_label();
+    program.bind(start)
+        .emit(SInstruction(addi_instrc, 8, 8, 1))
+        .emit(SInstruction(addi_instrc, 10, 10, 1))
+        .branch(je_instrc, 11, 10, done)
+        .constant(5, 1)
+        .emit(SInstruction(st_rel_instrc, 5, 0, ring_page + 8))
+        .constant(Thread::pcall_1stret, 1);
+    hosted_call(program, 2).jump(0, start).bind(done).halt();
+
+    // virtual page 0 holds the code, page 1 the ring
+    const std::vector<uint64_t> tables{
+        (root + 0x1000) | PageRead,
+        (root + 0x2000) | PageRead,
+        code_frame | PageRead | PageWrite | PageExecute,
+        ring_frame | PageRead | PageWrite,
+    };
+    auto bytes = [&tables](std::size_t first, std::size_t count) {
+        auto const *start_byte = reinterpret_cast<uint8_t const *>(tables.data() + first);
+        return std::vector<uint8_t>(start_byte, start_byte + count * sizeof(uint64_t));
+    };
+    program.data(root, bytes(0, 1)).data(root + 0x1000, bytes(1, 1)).data(root + 0x2000, bytes(2, 2)).memory_size(paged_size);
+    auto image = program.load();
+
+    const auto replacement = static_cast<uint64_t>(SInstruction(addi_instrc, 8, 8, 100));
+    auto *file = std::tmpfile();
+    std::fwrite(&replacement, sizeof(replacement), 1, file);
+    std::fflush(file);
+
+    auto thread = Thread{std::move(image.memory_pointer), paged_size, nullptr};
+    thread.registers(1) = ring_page + 0x800;
+    thread.registers(11) = 2;
+    auto hosted = hosted_ring{};
+    thread.use_hosted(&hosted);
+
+    // the ring is placed through the page tables, then memory moves under it
+    auto result = !thread.enable_paging(root) || !hosted.setup(thread, ring_page, entries);
+    const auto moved = thread.use_guard_pages();
+    auto *requests = reinterpret_cast<hosted_request *>(thread.memory().get() + ring_frame + hosted_ring::header_size);
+    requests[0] = hosted_request{HostedRead, static_cast<uint64_t>(fileno(file)), 0, sizeof(replacement), 0, 1};
+
+    run(0, nullptr, thread);
+    std::fclose(file);
+
+    result = result || thread.signal() != ProgramEnd || thread.registers(10) != 2 || thread.registers(8) != 101 ||
+             result_of(thread, ring_frame, entries, 1) != sizeof(replacement);
+    std::cerr << "== hosted read over code" << (moved ? "" : " (no guard pages)") << ": r8 = " << thread.registers(8) << ", "
+              << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int hosted(int, char **)
+{
+    return check_hosted_guest() + check_hosted_overflow() + check_hosted_code();
+}
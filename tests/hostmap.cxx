@@ -0,0 +1,117 @@
+#include "../supernova.h"
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <vector>
+/// this test maps a file over thread memory read only and read write, then faults on the read only range, interpreted and translated, and unmaps it
+
+using namespace supernova;
+using namespace supernova::headers;
+
+namespace
+{
+    constexpr uint64_t handler = 0x400;
+    constexpr uint64_t stack = 0xC00;
+
+    auto make_thread(uint64_t memory_size, std::vector<uint64_t> const &code) -> Thread
+    {
+        auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[memory_size]{});
+        auto *words = reinterpret_cast<uint64_t *>(memory.get());
+        std::copy(code.begin(), code.end(), words);
+
+        words[ProcessorCall::MemoryLimit] = handler;
+        words[handler / sizeof(uint64_t) + 0] = static_cast<uint64_t>(SInstruction(addi_instrc, 0, 5, 1));
+        words[handler / sizeof(uint64_t) + 1] = static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+
+        auto thread = Thread{std::move(memory), memory_size, nullptr};
+        thread.registers(1) = stack;
+        return thread;
+    }
+
+    using runner = thread_return (*)(int, char **, Thread &, bool);
+
+    auto run_jit(int argc, char **argv, Thread &thread, bool) -> thread_return { return jit::run(argc, argv, thread); }
+
+    /**
+     * @brief map a file over memory, then run a guest loading and storing through both mappings
+     * @return 0 if every check passed
+     */
+    auto check_mapping(runner run_guest, char const *name) -> int
+    {
+        const auto page = host_page_size();
+
+        // two pages of code and stack, a read only page and a read write one
+        const auto memory_size = 4 * page;
+        const auto shared = 2 * page;
+        const auto writable = 3 * page;
+
+        std::vector<uint64_t> contents(2 * page / sizeof(uint64_t));
+        for (std::size_t i = 0; i < contents.size(); ++i)
+        {
+            contents[i] = 0x1000 + i;
+        }
+        auto *file = std::tmpfile();
+        std::fwrite(contents.data(), sizeof(uint64_t), contents.size(), file);
+        std::fflush(file);
+        const auto descriptor = fileno(file);
+
+        auto thread = make_thread(memory_size, {
+            static_cast<uint64_t>(SInstruction(ld_dwrd_instrc, 0, 3, shared + 8)),
+            static_cast<uint64_t>(SInstruction(ld_dwrd_instrc, 0, 4, writable)),
+            static_cast<uint64_t>(SInstruction(addi_instrc, 0, 6, 0x55)),
+            static_cast<uint64_t>(SInstruction(st_dwrd_instrc, 6, 0, writable + 16)),
+            static_cast<uint64_t>(SInstruction(st_dwrd_instrc, 6, 0, shared)),
+            static_cast<uint64_t>(SInstruction(addi_instrc, 0, 7, 1)),
+            static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt)),
+        });
+
+        // memory has to be guarded before anything keeps a pointer to it
+        auto result = thread.map_host(shared, descriptor, 0, page, mem_read) || thread.unmap_host(shared, page) || !thread.use_guard_pages();
+
+        // misplaced ranges, bad descriptors and unreadable ranges leave memory alone
+        result = result || thread.map_host(shared + 8, descriptor, 0, page, mem_read) || thread.map_host(shared, descriptor, 8, page, mem_read) ||
+                 thread.map_host(shared, descriptor, 0, page / 2, mem_read) || thread.map_host(writable, descriptor, 0, 2 * page, mem_read) ||
+                 thread.map_host(shared, -1, 0, page, mem_read) || thread.map_host(shared, descriptor, 0, page, mem_write);
+
+        // translated code and the ring write memory directly, they only get writable ranges
+        std::vector<uint8_t> pages((memory_size >> Thread::code_page_bits) + 1, 0);
+        auto ring = hosted_ring{};
+        thread.watch_code(pages.data());
+        result = result || thread.map_host(shared, descriptor, 0, page, mem_read);
+        thread.watch_code(nullptr);
+        thread.use_hosted(&ring);
+        result = result || thread.map_host(shared, descriptor, 0, page, mem_read);
+        thread.use_hosted(nullptr);
+
+        result = result || !thread.map_host(shared, descriptor, 0, page, mem_read) ||
+                 !thread.map_host(writable, descriptor, page, page, mem_read | mem_write) || thread.read_only().size() != 1;
+        run_guest(0, nullptr, thread, false);
+
+        // the guest store went straight to the file
+        uint64_t stored = 0;
+        std::fseek(file, static_cast<long>(page + 16), SEEK_SET);
+        result = result || std::fread(&stored, sizeof(stored), 1, file) != 1 || stored != 0x55;
+        result = result || thread.pcall() != ProcessorCall::MemoryLimit || thread.registers(3) != contents[1] ||
+                 thread.registers(4) != contents[page / sizeof(uint64_t)] || thread.registers(5) != 1 || thread.registers(7) != 0;
+
+        // unmapped ranges are zeroed and writable again
+        result = result || !thread.unmap_host(shared, page) || thread.memory()[shared + 8] != 0 || !thread.read_only().empty();
+        thread.memory()[shared] = 1;
+        std::fclose(file);
+
+        std::cerr << "== host mapping, " << name << ": read 0x" << std::hex << thread.registers(3) << std::dec << " in place, "
+                  << (result ? "in" : "") << "correct\n";
+        return result;
+    }
+} // namespace
+
+int hostmap(int, char **)
+{
+    if (host_page_size() == 0)
+    {
+        std::cerr << "== host mapping: not supported by the host\n";
+        return 0;
+    }
+
+    return check_mapping(run, "interpreted") + check_mapping(run_jit, jit::available() ? "translated" : "translated (interpreted)");
+}
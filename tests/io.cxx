@@ -0,0 +1,176 @@
+#include "../supernova.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+/// this test drives the console, block and timer devices through group 3 i/o instructions
+
+using namespace supernova;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x1000;
+    constexpr uint64_t console_port = 0x00;
+    constexpr uint64_t timer_port = 0x08;
+    constexpr uint64_t disk_port = 0x10;
+    constexpr uint64_t interrupts = 0xA00;
+    constexpr auto disk_name = "io_disk.bin";
+
+    /** load a program, followed by the `InvalidInstruction` handler halting */
+    auto make_thread(ProgramBuilder &program, thread_model_t *model = nullptr) -> Thread
+    {
+        const auto handler = program.here();
+        program.halt();
+        std::vector<uint8_t> entry(sizeof(handler));
+        std::memcpy(entry.data(), &handler, sizeof(handler));
+        program.data(interrupts + ProcessorCall::InvalidInstruction * sizeof(uint64_t), entry).memory_size(memory_size);
+
+        auto image = program.load();
+        auto thread = Thread{std::move(image.memory_pointer), memory_size, model, image.entry_point};
+        thread.intvec() = interrupts;
+        thread.registers(1) = 0xC00;
+        return thread;
+    }
+} // namespace
+
+int check_console()
+{
+    auto *input = std::tmpfile();
+    auto *output = std::tmpfile();
+    std::fputs("hi", input);
+    std::rewind(input);
+
+    auto console = console_device{input, output};
+    auto bus = io_bus{};
+    auto result = !bus.attach(console_port, console);
+
+    ProgramBuilder program{};
+    program.constant(3, console_port + 1)
+        .emit(RInstruction(bin_instrc, 0, 0, 4))
+        .emit(RInstruction(bin_instrc, 0, 0, 5))
+        .emit(RInstruction(bin_instrc, 0, 0, 6))
+        .emit(RInstruction(bin_instrc, 3, 0, 7))
+        .emit(RInstruction(bout_instrc, 5, 0, 0))
+        .emit(SInstruction(out_instrc, 4, 0, console_port))
+        .emit(RInstruction(bout_instrc, 0, 0, 3))
+        .halt();
+    auto thread = make_thread(program);
+    thread.use_io(&bus);
+    run(0, nullptr, thread);
+
+    char echoed[3] = {};
+    std::rewind(output);
+    result = result || std::fread(echoed, 1, 2, output) != 2 || echoed[0] != 'i' || echoed[1] != 'h';
+    result = result || thread.pcall() != NormalExecution || thread.registers(4) != 'h' || thread.registers(5) != 'i' ||
+             thread.registers(6) != 0xFF || thread.registers(7) != 1;
+
+    std::fclose(input);
+    std::fclose(output);
+    std::cerr << "== console: echoed `" << echoed << "`, " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_disk()
+{
+    {
+        std::vector<uint8_t> contents(2 * block_device::sector_size);
+        for (std::size_t i = 0; i < contents.size(); ++i)
+        {
+            contents[i] = static_cast<uint8_t>(i);
+        }
+        auto *file = std::fopen(disk_name, "wb");
+        std::fwrite(contents.data(), 1, contents.size(), file);
+        std::fclose(file);
+    }
+
+    auto result = false;
+    {
+        auto disk = block_device{disk_name};
+        auto bus = io_bus{};
+        result = !disk.is_open() || !bus.attach(disk_port, disk) || bus.attach(disk_port + 2, disk);
+
+        ProgramBuilder program{};
+        // read sector 1 and its first double word
+        program.constant(3, 1)
+            .emit(SInstruction(out_instrc, 3, 0, disk_port + 0))
+            .emit(SInstruction(out_instrc, 3, 0, disk_port + 3))
+            .emit(SInstruction(in_instrc, 0, 8, disk_port + 2))
+            .emit(SInstruction(in_instrc, 0, 9, disk_port + 3))
+            .emit(SInstruction(in_instrc, 0, 10, disk_port + 4))
+            // write the buffer, with a new first double word, over sector 0
+            .emit(SInstruction(out_instrc, 0, 0, disk_port + 0))
+            .emit(SInstruction(out_instrc, 0, 0, disk_port + 1))
+            .constant(4, 0x1122)
+            .emit(SInstruction(out_instrc, 4, 0, disk_port + 2))
+            .constant(5, block_device::command_write)
+            .emit(SInstruction(out_instrc, 5, 0, disk_port + 3))
+            .emit(SInstruction(in_instrc, 0, 11, disk_port + 3))
+            // sectors past the end fail
+            .constant(6, 5)
+            .emit(SInstruction(out_instrc, 6, 0, disk_port + 0))
+            .emit(SInstruction(out_instrc, 3, 0, disk_port + 3))
+            .emit(SInstruction(in_instrc, 0, 12, disk_port + 3))
+            .halt();
+        auto thread = make_thread(program);
+        thread.use_io(&bus);
+        run(0, nullptr, thread);
+
+        result = result || thread.pcall() != NormalExecution || thread.registers(8) != 0x0706050403020100 || thread.registers(9) != 0 ||
+                 thread.registers(10) != 2 || thread.registers(11) != 0 || thread.registers(12) != 1;
+    }
+
+    uint8_t first[block_device::sector_size] = {};
+    auto *file = std::fopen(disk_name, "rb");
+    result = result || file == nullptr || std::fread(first, 1, sizeof(first), file) != sizeof(first);
+    if (file != nullptr)
+    {
+        std::fclose(file);
+    }
+    std::remove(disk_name);
+
+    result = result || first[0] != 0x22 || first[1] != 0x11 || first[2] != 0 || first[8] != 8 || first[511] != 0xFF;
+    std::cerr << "== block device: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_bus()
+{
+    auto timer = timer_device{};
+    auto bus = io_bus{};
+    auto result = !bus.attach(timer_port, timer);
+
+    thread_model_t model{};
+    ProgramBuilder program{};
+    program.emit(SInstruction(in_instrc, 0, 3, timer_port))
+        .emit(SInstruction(in_instrc, 0, 4, timer_port))
+        .emit(SInstruction(in_instrc, 0, 5, timer_port + 1))
+        .emit(SInstruction(in_instrc, 0, 6, 0x80))
+        .emit(RInstruction(bin_instrc, 0, 0, 7))
+        .emit(SInstruction(out_instrc, 3, 0, 0x80))
+        .halt();
+    auto thread = make_thread(program, &model);
+    thread.use_io(&bus);
+    run(0, nullptr, thread);
+
+    // ports past the timer and past the bus read all ones
+    result = result || model.io_address_space != io_bus::default_port_count - 1 || thread.pcall() != NormalExecution ||
+             thread.registers(4) < thread.registers(3) || thread.registers(5) == 0 || thread.registers(6) != ~0ULL || thread.registers(7) != 0xFF;
+
+    bus.detach(timer_port + 1);
+    result = result || bus.read(timer_port, sizeof(uint64_t)) != ~0ULL || !bus.attach(timer_port, timer);
+
+    // without a bus i/o instructions do not exist
+    ProgramBuilder invalid{};
+    invalid.emit(SInstruction(in_instrc, 0, 3, timer_port));
+    auto plain = make_thread(invalid);
+    run(0, nullptr, plain);
+    result = result || plain.pcall() != InvalidInstruction || plain.registers(Thread::pcall_invopc) != in_instrc;
+
+    std::cerr << "== i/o bus: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int io(int, char **)
+{
+    return check_console() + check_disk() + check_bus();
+}
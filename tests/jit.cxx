@@ -0,0 +1,207 @@
+#include "../supernova.h"
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <vector>
+/// this test runs programs through the translator and the interpreter, expecting the same results
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x2000;
+
+    auto make_thread(ProgramBuilder &program) -> Thread
+    {
+        auto image = program.memory_size(memory_size).load();
+        return Thread{std::move(image.memory_pointer), memory_size, nullptr, image.entry_point};
+    }
+
+    /** translate blocks on their first entry, so every jump to a fixed address gets linked */
+    auto run_eager(int argc, char **argv, Thread &thread) -> thread_return { return jit::run(argc, argv, thread, 1); }
+
+    /** run once with hot blocks translated, and once with every block translated */
+    auto compare(const char *name, ProgramBuilder &program) -> int
+    {
+        auto interpreted = make_thread(program);
+        auto translated = make_thread(program);
+        auto eager = make_thread(program);
+
+        run(0, nullptr, interpreted);
+        jit::run(0, nullptr, translated);
+        run_eager(0, nullptr, eager);
+
+        auto result = false;
+        for (auto *thread : {&translated, &eager})
+        {
+            result = result || interpreted.signal() != thread->signal() || interpreted.progc() != thread->progc();
+            for (auto i = 0; i < Thread::register_count; ++i)
+            {
+                result = result || interpreted.registers(i) != thread->registers(i);
+            }
+
+            result = result || !std::equal(interpreted.memory().get(), interpreted.memory().get() + memory_size, thread->memory().get());
+        }
+
+        std::cerr << "== " << name << (jit::available() ? "" : " (interpreted)") << ": " << (result ? "in" : "") << "correct\n";
+        return result;
+    }
+
+    /**
+     * raise a processor call, rewrite its vector entry with a translated store,
+     * then raise it again, each handler adds to r3 and halts
+     */
+    auto check_vector_rewrite() -> int
+    {
+        constexpr uint64_t vector = 0x1000;
+        constexpr uint64_t syscall = 20;
+
+        ProgramBuilder program{};
+        auto second_handler = program.make_label();
+        program.emit(LInstruction(pcall_instrc, 0, syscall))
+            .address(4, second_handler)
+            .emit(SInstruction(st_dwrd_instrc, 4, 0, vector + syscall * sizeof(uint64_t)))
+            .emit(LInstruction(pcall_instrc, 0, syscall));
+        const auto first_handler = program.here();
+        program.emit(SInstruction(addi_instrc, 3, 3, 1)).halt().bind(second_handler).emit(SInstruction(addi_instrc, 3, 3, 10)).halt();
+
+        std::vector<uint8_t> entry(sizeof(first_handler));
+        std::memcpy(entry.data(), &first_handler, sizeof(first_handler));
+        program.data(vector + syscall * sizeof(uint64_t), entry);
+
+        auto make = [&program]() {
+            auto thread = make_thread(program);
+            thread.intvec() = vector;
+            return thread;
+        };
+
+        // the second run starts past the first call, as if its handler returned
+        auto twice = [](Thread &thread, auto runner) {
+            thread.registers(1) = 0x1800;
+            runner(0, nullptr, thread);
+            thread.pcall() = NormalExecution;
+            thread.signal() = DoNotDestroy;
+            thread.registers(1) = 0x1800;
+            thread.progc() = sizeof(uint64_t);
+            runner(0, nullptr, thread);
+        };
+
+        auto interpreted = make();
+        auto translated = make();
+        twice(interpreted, [](int argc, char **argv, Thread &thread) { return run(argc, argv, thread); });
+        twice(translated, run_eager);
+
+        const auto result = interpreted.registers(3) != 11 || translated.registers(3) != interpreted.registers(3);
+        std::cerr << "== rewritten vector entry" << (jit::available() ? "" : " (interpreted)") << ": r3 = " << translated.registers(3) << ", "
+                  << (result ? "in" : "") << "correct\n";
+        return result;
+    }
+
+    /** native handler moving memory into guard pages halfway through a run */
+    void guard_memory(Thread &thread, void *) noexcept { static_cast<void>(thread.use_guard_pages()); }
+
+    /**
+     * store, let a native handler move memory, then load and store again,
+     * translated code has to follow memory to where it went
+     */
+    auto check_moved_memory() -> int
+    {
+        constexpr uint64_t syscall = 20;
+        ProgramBuilder program{};
+        program.emit(SInstruction(addi_instrc, 0, 3, 0x77))
+            .emit(SInstruction(st_dwrd_instrc, 3, 0, 0x1800))
+            .emit(LInstruction(pcall_instrc, 0, syscall))
+            .emit(SInstruction(ld_dwrd_instrc, 0, 4, 0x1800))
+            .emit(SInstruction(addi_instrc, 4, 5, 1))
+            .emit(SInstruction(st_dwrd_instrc, 5, 0, 0x1808))
+            .halt();
+
+        auto interpreted = make_thread(program);
+        auto translated = make_thread(program);
+        auto result = !interpreted.bind_pcall(syscall, guard_memory) || !translated.bind_pcall(syscall, guard_memory);
+
+        run(0, nullptr, interpreted);
+        run_eager(0, nullptr, translated);
+
+        const auto *words = reinterpret_cast<uint64_t const *>(translated.memory().get());
+        result = result || translated.registers(4) != 0x77 || words[0x1808 / sizeof(uint64_t)] != 0x78 ||
+                 !std::equal(interpreted.memory().get(), interpreted.memory().get() + memory_size, translated.memory().get());
+        std::cerr << "== memory moved while running" << (jit::available() ? "" : " (interpreted)") << ": " << (result ? "in" : "")
+                  << "correct\n";
+        return result;
+    }
+} // namespace
+
+int jit(int, char **)
+{
+    auto result = 0;
+
+    ProgramBuilder arithmetic{};
+    auto arithmetic_loop = arithmetic.make_label();
+    arithmetic.emit(SInstruction(addi_instrc, 0, 6, 100))
+        .bind(arithmetic_loop)
+        .emit(SInstruction(addi_instrc, 3, 3, 1))
+        .emit(RInstruction(umulr_instrc, 3, 3, 4))
+        .emit(RInstruction(xorr_instrc, 5, 4, 5))
+        .emit(SInstruction(llsi_instrc, 5, 7, 3))
+        .emit(RInstruction(lrsr_instrc, 7, 3, 8))
+        .emit(SInstruction(smuli_instrc, 8, 9, -5LLU))
+        .emit(RInstruction(subr_instrc, 9, 5, 10))
+        .emit(RInstruction(setgsr_instrc, 10, 0, 11))
+        .emit(SInstruction(setleui_instrc, 3, 12, 50))
+        .emit(RInstruction(not_instrc, 12, 0, 12))
+        .branch(jne_instrc, 6, 3, arithmetic_loop)
+        .emit(LInstruction(lui_instrc, 13, 0x1234))
+        .emit(LInstruction(auipc_instrc, 14, 2))
+        .halt();
+    result += compare("arithmetic loop", arithmetic);
+
+    ProgramBuilder memory{};
+    auto memory_loop = memory.make_label();
+    memory.emit(SInstruction(addi_instrc, 0, 1, 0x1000))
+        .emit(SInstruction(addi_instrc, 0, 3, 0x1800))
+        .emit(SInstruction(addi_instrc, 0, 6, 40))
+        .bind(memory_loop)
+        .emit(SInstruction(st_word_instrc, 6, 3, 4))
+        .emit(SInstruction(ld_half_instrc, 3, 4, 4))
+        .emit(SInstruction(st_byte_instrc, 4, 3, 7))
+        .emit(SInstruction(ld_dwrd_instrc, 3, 5, 0))
+        .emit(SInstruction(push_instrc, 1, 5, 1))
+        .emit(SInstruction(pull_instrc, 1, 7, 0))
+        .emit(SInstruction(subi_instrc, 6, 6, 1))
+        .branch(jgu_instrc, 0, 6, memory_loop)
+        .emit(SInstruction(udivi_instrc, 5, 8, 3))
+        .halt();
+    result += compare("memory and calls", memory);
+
+    // the loop rewrites its own first instruction, translated code has to notice
+    ProgramBuilder rewriting{};
+    auto rewriting_loop = rewriting.make_label();
+    rewriting.bind(rewriting_loop)
+        .emit(SInstruction(addi_instrc, 3, 3, 1))
+        .emit(SInstruction(addi_instrc, 4, 4, 1))
+        .emit(SInstruction(addi_instrc, 0, 5, 0x1000))
+        .emit(SInstruction(ld_dwrd_instrc, 5, 6, 0))
+        .emit(SInstruction(st_dwrd_instrc, 6, 0, 0))
+        .emit(SInstruction(addi_instrc, 0, 7, 40))
+        .branch(jne_instrc, 7, 4, rewriting_loop)
+        .halt();
+    result += compare("self modifying", rewriting);
+
+    // the link is written before the target is read, with rd == r1 the jump is relative to it
+    ProgramBuilder linking{};
+    linking.emit(SInstruction(addi_instrc, 0, 4, 8))
+        .emit(SInstruction(jalr_instrc, 4, 4, 0))
+        .emit(SInstruction(addi_instrc, 0, 5, 1))
+        .halt()
+        .halt()
+        .emit(SInstruction(addi_instrc, 0, 5, 2))
+        .emit(SInstruction(jalr_instrc, 0, 0, 0))
+        .emit(SInstruction(addi_instrc, 0, 6, 1))
+        .halt()
+        .emit(SInstruction(addi_instrc, 0, 6, 2))
+        .halt();
+    result += compare("jalr linking over its base", linking);
+
+    return result + check_vector_rewrite() + check_moved_memory();
+}
@@ -0,0 +1,136 @@
+#include "../supernova.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+/// this test maps pages through 3 level tables, enables paging from the guest and checks translations and faults
+
+using namespace supernova;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x10000;
+    constexpr uint64_t root = 0x8000;
+    constexpr uint64_t vector = 0x800;
+
+    /** maps virtual `page` to `frame` with `access`, tables at `root`, `root + 0x1000` and `root + 0x2000` */
+    void map(uint64_t *words, uint64_t page, uint64_t frame, uint8_t access)
+    {
+        words[root / sizeof(uint64_t)] = (root + 0x1000) | PageRead;
+        words[(root + 0x1000) / sizeof(uint64_t)] = (root + 0x2000) | PageRead;
+        words[(root + 0x2000) / sizeof(uint64_t) + (page >> 12U)] = frame | access;
+    }
+
+    /** bytes of double words, for data regions */
+    auto bytes_of(std::vector<uint64_t> const &words) -> std::vector<uint8_t>
+    {
+        std::vector<uint8_t> bytes(words.size() * sizeof(uint64_t));
+        std::memcpy(bytes.data(), words.data(), bytes.size());
+        return bytes;
+    }
+
+    /** load a program followed by the `PageFault` handler halting, with the tables `map` writes */
+    auto make_thread(ProgramBuilder &program, struct thread_model_t *model = nullptr) -> Thread
+    {
+        const auto handler = program.here();
+        program.halt()
+            .data(root, bytes_of({(root + 0x1000) | PageRead}))
+            .data(root + 0x1000, bytes_of({(root + 0x2000) | PageRead}))
+            // code at 0x0000, data at 0x1000 and read only data at 0x2000
+            .data(root + 0x2000, bytes_of({0x0000 | PageRead | PageExecute, 0x5000 | PageRead | PageWrite, 0x6000 | PageRead}))
+            .data(0x5008, bytes_of({0x1234}))
+            .data(0x6000, bytes_of({0x5678}))
+            .data(vector + ProcessorCall::PageFault * sizeof(uint64_t), bytes_of({handler}))
+            .memory_size(memory_size);
+
+        auto image = program.load();
+        auto thread = Thread{std::move(image.memory_pointer), memory_size, model, image.entry_point};
+        thread.intvec() = vector;
+        thread.registers(1) = 0x1800;
+        return thread;
+    }
+
+    auto make_thread(struct thread_model_t *model = nullptr) -> Thread
+    {
+        ProgramBuilder program{};
+        return make_thread(program, model);
+    }
+} // namespace
+
+int check_guest_paging()
+{
+    // `pcall -1` 1:1 with the root table on r14, then a load through the map and a store to a read only page
+    ProgramBuilder program{};
+    program.constant(Thread::pcall_reg, (1ULL << 32U) | 1U)
+        .constant(Thread::pcall_1stret, root)
+        .constant(Thread::pcall_2ndret, 1)
+        .emit(LInstruction(pcall_instrc, 0, ProcessorCall::Functions))
+        .emit(SInstruction(ld_dwrd_instrc, 0, 7, 0x1008))
+        .emit(SInstruction(ld_dwrd_instrc, 0, 8, 0x2000))
+        .emit(SInstruction(st_dwrd_instrc, 7, 0, 0x2000))
+        .constant(9, 1);
+    auto thread = make_thread(program);
+
+    run(0, nullptr, thread);
+
+    const auto *words = reinterpret_cast<uint64_t const *>(thread.memory().get());
+    const auto result = !thread.paging() || thread.signal() != ProgramEnd || thread.pcall() != ProcessorCall::PageFault ||
+                        thread.registers(7) != 0x1234 || thread.registers(8) != 0x5678 || thread.registers(9) != 0 ||
+                        thread.registers(Thread::pcall_pfaddr) != 0x2000 || words[0x6000 / sizeof(uint64_t)] != 0x5678;
+
+    std::cerr << "== guest paging: r7 = `0x" << std::hex << thread.registers(7) << "`, r8 = `0x" << thread.registers(8)
+              << "`, faulted on `0x" << thread.registers(Thread::pcall_pfaddr) << std::dec << "`, " << (result ? "in" : "")
+              << "correct\n";
+    return result;
+}
+
+int check_tlb_flush()
+{
+    auto thread = make_thread();
+    auto *words = reinterpret_cast<uint64_t *>(thread.memory().get());
+
+    auto result = !thread.enable_paging(root) || thread.translate(0x1010, PageRead) != 0x5010;
+
+    // the TLB keeps the old frame until the page gets flushed
+    map(words, 0x1000, 0x7000, PageRead);
+    result = result || thread.translate(0x1010, PageRead) != 0x5010;
+    thread.flush_tlb(0x1000);
+    result = result || thread.translate(0x1010, PageRead) != 0x7010 || thread.translate(0x1010, PageWrite) != Thread::untranslated;
+
+    // unmapped pages and addresses past the tables never translate
+    result = result || thread.translate(0x3000, PageRead) != Thread::untranslated || thread.translate(1ULL << 40U, PageRead) != Thread::untranslated;
+
+    std::cerr << "== tlb flush: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_models()
+{
+    thread_model_t flat{};
+    flat.page_level = 0;
+    flat.page_size = 0x1000;
+
+    thread_model_t odd{};
+    odd.page_level = 2;
+    odd.page_size = 0x1800;
+
+    thread_model_t linear{};
+    linear.page_level = 1;
+    linear.page_size = 0x400;
+
+    auto none = make_thread(&flat);
+    auto invalid = make_thread(&odd);
+    auto single = make_thread(&linear);
+    auto standard = make_thread();
+
+    const auto result = none.enable_paging(root) || none.page_levels() != 0 || invalid.enable_paging(root) ||
+                        single.page_levels() != 1 || single.page_size() != 0x400 ||
+                        standard.page_levels() != default_page_levels || standard.page_size() != default_page_size;
+
+    std::cerr << "== thread models: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int paging(int, char **)
+{
+    return check_guest_paging() + check_tlb_flush() + check_models();
+}
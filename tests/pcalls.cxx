@@ -0,0 +1,182 @@
+#include "../supernova.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+/// this test enters guest handlers through the cached interrupt vector, rewrites the vector, then binds native handlers directly and through a registry
+
+using namespace supernova;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x1000;
+    constexpr uint64_t first_handler = 0x400;
+    constexpr uint64_t second_handler = 0x410;
+    constexpr uint64_t start = 0x420;
+    constexpr uint64_t interrupts = 0x800;
+    constexpr uint64_t moved = 0x900;
+    constexpr uint64_t stack = 0xC00;
+    constexpr uint64_t syscall = 20;
+
+    /** both handlers, the code goes after them from `start` */
+    auto make_program() -> ProgramBuilder
+    {
+        ProgramBuilder program{first_handler};
+        program.emit(SInstruction(addi_instrc, 3, 3, 1)).halt().emit(SInstruction(addi_instrc, 3, 3, 10)).halt();
+        const auto code = program.make_label();
+        program.bind(code).entry(code);
+        return program;
+    }
+
+    /** load a program, the vector and its moved copy pointing at the first handler */
+    auto make_thread(ProgramBuilder &program) -> Thread
+    {
+        std::vector<uint8_t> entry(sizeof(first_handler));
+        std::memcpy(entry.data(), &first_handler, sizeof(first_handler));
+        program.data(interrupts + syscall * sizeof(uint64_t), entry).data(moved + syscall * sizeof(uint64_t), entry).memory_size(memory_size);
+
+        auto image = program.load();
+        auto thread = Thread{std::move(image.memory_pointer), memory_size, nullptr, image.entry_point};
+        thread.intvec() = interrupts;
+        thread.registers(1) = stack;
+        return thread;
+    }
+
+    /** start over from an address, as if the guest handler had returned */
+    void restart(Thread &thread, uint64_t address)
+    {
+        thread.pcall() = NormalExecution;
+        thread.signal() = DoNotDestroy;
+        thread.registers(1) = stack;
+        thread.progc() = address;
+        run(0, nullptr, thread);
+    }
+
+    /** r14 = r13 + r14, counting calls on the context */
+    void add_natively(Thread &thread, void *context) noexcept
+    {
+        thread.registers(Thread::pcall_1stret) += thread.registers(Thread::pcall_2ndret);
+        ++*static_cast<uint64_t *>(context);
+    }
+} // namespace
+
+int check_vector_cache()
+{
+    auto program = make_program();
+    program.emit(LInstruction(pcall_instrc, 0, syscall));
+    const auto rewrite = program.here();
+    program.constant(4, second_handler)
+        .emit(SInstruction(st_dwrd_instrc, 4, 0, interrupts + syscall * sizeof(uint64_t)))
+        .emit(LInstruction(pcall_instrc, 0, syscall));
+    auto thread = make_thread(program);
+
+    run(0, nullptr, thread);
+    const auto *words = reinterpret_cast<uint64_t const *>(thread.memory().get());
+    auto result = thread.registers(3) != 1 || thread.cached_handler(syscall) != first_handler || thread.registers(1) != stack - 24 ||
+                  words[stack / sizeof(uint64_t)] != start + sizeof(uint64_t) || words[stack / sizeof(uint64_t) - 1] != stack - 8 ||
+                  words[stack / sizeof(uint64_t) - 2] != 0;
+
+    // the second time comes from the cache, a guest store to the vector drops it
+    restart(thread, start);
+    result = result || thread.registers(3) != 2;
+    restart(thread, rewrite);
+    result = result || thread.registers(3) != 12 || thread.cached_handler(syscall) != second_handler;
+
+    // moving the vector does too
+    thread.intvec() = moved;
+    result = result || thread.cached_handler(syscall) != Thread::untranslated;
+    restart(thread, start);
+    result = result || thread.registers(3) != 13 || thread.cached_handler(syscall) != first_handler;
+
+    // once memory is shared, a hart rewriting the vector is seen by every other hart
+    reinterpret_cast<uint64_t *>(thread.memory().get())[interrupts / sizeof(uint64_t) + syscall] = first_handler;
+    thread.intvec() = interrupts;
+    restart(thread, start);
+    auto hart = thread.hart(rewrite);
+    hart.registers(1) = stack - 0x100;
+    result = result || thread.registers(3) != 14 || thread.cached_handler(syscall) != Thread::untranslated;
+    run(0, nullptr, hart);
+    restart(thread, start);
+    result = result || hart.registers(3) != 10 || thread.registers(3) != 24 || thread.cached_handler(syscall) != Thread::untranslated;
+
+    std::cerr << "== interrupt vector cache: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_native_pcalls()
+{
+    auto program = make_program();
+    program.constant(Thread::pcall_1stret, 2)
+        .constant(Thread::pcall_2ndret, 3)
+        .emit(LInstruction(pcall_instrc, 0, syscall))
+        .emit(RInstruction(orr_instrc, Thread::pcall_1stret, 0, 5))
+        .halt();
+    auto thread = make_thread(program);
+
+    uint64_t calls = 0;
+    auto result = thread.bind_pcall(ProcessorCall::Halt, add_natively, &calls) ||
+                  thread.bind_pcall(Thread::vector_cache_size, add_natively, &calls) || !thread.bind_pcall(syscall, add_natively, &calls);
+
+    // no state is pushed and the guest goes on right after the pcall
+    run(0, nullptr, thread);
+    result = result || calls != 1 || thread.registers(5) != 5 || thread.registers(1) != stack || thread.pcall() != NormalExecution ||
+             thread.registers(3) != 0;
+
+    auto hart = thread.hart(start);
+    result = result || hart.bound_pcall(static_cast<ProcessorCall>(syscall)) == nullptr;
+
+    // unbound, the guest handler takes it again
+    result = result || !thread.bind_pcall(syscall, nullptr);
+    restart(thread, start);
+    result = result || calls != 1 || thread.registers(3) != 1 || thread.bound_pcall(static_cast<ProcessorCall>(syscall)) != nullptr;
+
+    std::cerr << "== native pcalls: " << calls << " call, " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int check_registry()
+{
+    constexpr uint64_t data = 0x600;
+    auto program = make_program();
+    program.constant(Thread::pcall_1stret, data)
+        .constant(Thread::pcall_2ndret, 4)
+        .emit(LInstruction(pcall_instrc, 0, syscall))
+        .constant(Thread::pcall_2ndret, 100)
+        .emit(LInstruction(pcall_instrc, 0, syscall + 1))
+        .halt()
+        .data(data, {1, 2, 3, 4});
+    auto thread = make_thread(program);
+
+    // r14 = sum of the r13 bytes at r14, read straight from guest memory
+    uint64_t summed = 0;
+    uint64_t calls = 0;
+    auto registry = pcall_registry{};
+    auto result = registry.bind(ProcessorCall::Halt, add_natively) ||
+                  !registry.bind(syscall, [&summed](Thread &guest) {
+                      auto const *bytes = guest.memory().get() + guest.registers(Thread::pcall_1stret);
+                      uint64_t sum = 0;
+                      for (uint64_t i = 0; i < guest.registers(Thread::pcall_2ndret); ++i)
+                      {
+                          sum += bytes[i];
+                      }
+                      guest.registers(Thread::pcall_1stret) = sum;
+                      summed += sum;
+                  }) ||
+                  !registry.bind(syscall + 1, add_natively, &calls) || registry.bound(syscall) == nullptr || registry.bound(syscall + 2) != nullptr;
+
+    result = result || !registry.install(thread);
+    run(0, nullptr, thread);
+    result = result || summed != 10 || calls != 1 || thread.registers(Thread::pcall_1stret) != 110 || thread.registers(1) != stack;
+
+    // rebinding keeps the old callable alive for threads installed before
+    result = result || !registry.bind(syscall, pcall_registry::function{});
+    restart(thread, start);
+    result = result || summed != 20 || calls != 2 || registry.bound(syscall) != nullptr;
+
+    std::cerr << "== pcall registry: summed " << summed << ", " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
+int pcalls(int, char **)
+{
+    return check_vector_cache() + check_native_pcalls() + check_registry();
+}
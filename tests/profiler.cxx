@@ -0,0 +1,114 @@
+#include "../supernova.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+/// this test profiles nested calls from an image carrying symbols in a debug region, then again with paging on
+
+using namespace supernova;
+using namespace supernova::headers;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x1000;
+    constexpr uint64_t iterations = 1000;
+
+    /** main calls f, f calls g, g loops, `call` returns two instructions past itself */
+    auto build(uint64_t stack) -> ProgramBuilder
+    {
+        ProgramBuilder program{};
+        auto main = program.make_label();
+        auto f = program.make_label();
+        auto g = program.make_label();
+        auto loop = program.make_label();
+
+        program.bind(main).constant(2, stack).call(f, 5).halt();
+        program.bind(f).call(g, 5).emit(RInstruction(retn_instrc, 2, 3, 0));
+        program.bind(g)
+            .constant(6, iterations)
+            .bind(loop)
+            .emit(SInstruction(addi_instrc, 7, 7, 1))
+            .branch(jne_instrc, 6, 7, loop)
+            .emit(RInstruction(retn_instrc, 2, 3, 0));
+        program.symbol(main, "main").symbol(f, "f").symbol(g, "g").memory_size(memory_size);
+        return program;
+    }
+
+    /** every line ends with its count, and g is where the time goes */
+    auto mostly_in_g(supernova::profiler const &profile) -> bool
+    {
+        std::ostringstream folded;
+        profile.write_folded(folded);
+
+        std::istringstream lines(folded.str());
+        std::string stack;
+        uint64_t count = 0;
+        uint64_t total = 0;
+        uint64_t in_g = 0;
+        while (lines >> stack >> count)
+        {
+            total += count;
+            in_g += stack == "main;f;g" ? count : 0;
+        }
+
+        std::cerr << folded.str();
+        return total == profile.samples() && in_g * 10 >= total * 9;
+    }
+
+    /** the same calls with paging on, frames sit on a page mapped somewhere else */
+    auto check_paged() -> int
+    {
+        constexpr uint64_t paged_size = 0x10000;
+        constexpr uint64_t root = 0x8000;
+        constexpr uint64_t tables_at = root + 0x2000;
+
+        auto program = build(0x1400);
+        // virtual page 0 holds the code, page 1 the stack
+        const uint64_t tables[] = {(root + 0x1000) | PageRead, tables_at | PageRead, 0x0000 | PageRead | PageExecute,
+                                   0x5000 | PageRead | PageWrite};
+        auto bytes = [&tables](std::size_t first, std::size_t count) {
+            auto const *start = reinterpret_cast<uint8_t const *>(tables + first);
+            return std::vector<uint8_t>(start, start + count * sizeof(uint64_t));
+        };
+        program.data(root, bytes(0, 1)).data(root + 0x1000, bytes(1, 1)).data(tables_at, bytes(2, 2)).memory_size(paged_size);
+        auto loaded = program.load();
+
+        // the same functions as in the image
+        auto image = read_file("profile.spn");
+        auto thread = Thread{std::move(loaded.memory_pointer), paged_size, nullptr, loaded.entry_point};
+        auto profile = supernova::profiler{7};
+
+        auto result = profile.load_symbols("profile.spn", image) != 3;
+        result = result || !thread.enable_paging(root) || profile.run(thread).status != ProgramEnded;
+        result = result || !mostly_in_g(profile);
+        std::cerr << "== " << profile.samples() << " paged samples: " << (result ? "in" : "") << "correct\n";
+        return result;
+    }
+} // namespace
+
+int profiler(int, char **)
+{
+    if (build(0x400).write("profile.spn") != BuildOk)
+    {
+        std::cerr << "== could not write \"profile.spn\"\n";
+        return 1;
+    }
+
+    auto image = read_file("profile.spn");
+    if (image.status != ReadOk)
+    {
+        std::cerr << "== could not read \"profile.spn\"\n";
+        return 1;
+    }
+
+    auto profile = supernova::profiler{7};
+    auto result = profile.load_symbols("profile.spn", image) != 3;
+
+    auto thread = Thread{std::move(image.memory_pointer), image.memory_size, nullptr, image.entry_point};
+    const auto ran = profile.run(thread);
+    result += ran.status != ProgramEnded || ran.executed != 4 + 3 + 1 + iterations * 2 + 1 + 1 + 1;
+
+    result += !mostly_in_g(profile);
+    std::cerr << "== " << profile.samples() << " samples: " << (result ? "in" : "") << "correct\n";
+    return result + check_paged();
+}
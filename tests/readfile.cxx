@@ -1,6 +1,8 @@
 #include "../supernova.h"
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <vector>
 using namespace supernova::headers;
 
 void print_read_return(read_return const &rret)
@@ -29,6 +31,62 @@ auto test_case(char const *fname, read_return expected)
     return false;
 }
 
+/// mapped and copied images need to hold the same bytes, whatever the region alignments
+auto mapped_case()
+{
+    constexpr uint64_t memory_size = 0x5000;
+    constexpr uint64_t data_start = 0x1000;
+    constexpr auto loaded = static_cast<memory_flags>(mem_exists | mem_read | mem_write);
+    constexpr auto cleared = static_cast<memory_flags>(mem_exists | mem_clear);
+
+    const memory_map regions[] = {
+        // page aligned in the file and in memory, with a partial page at the end
+        {memmap_magic, data_start, 0x2100, 0x1000, loaded},
+        // not aligned at all
+        {memmap_magic, data_start + 0x2100, 0x20, 0x3010, loaded},
+        // clears inside a page, then a whole page of what was loaded
+        {memmap_magic, 0, 0x10, 0x1800, cleared},
+        {memmap_magic, 0, 0x1000, 0x2000, cleared},
+    };
+    const main_header main{master_magic, snvm_version, memory_size, 0, std::size(regions)};
+
+    std::vector<uint8_t> data(0x2120);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+
+    {
+        auto file = std::ofstream("mapped.spn", std::ios::binary);
+        std::vector<char> padding(data_start - sizeof(main) - sizeof(regions));
+        file.write(reinterpret_cast<char const *>(&main), sizeof(main));
+        file.write(reinterpret_cast<char const *>(regions), sizeof(regions));
+        file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        file.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    const auto copied = read_file("mapped.spn", LoadCopy);
+    const auto mapped = read_file("mapped.spn", LoadMapped);
+
+    if (copied.status != ReadOk || mapped.status != ReadOk || mapped.region_count != std::size(regions))
+    {
+        std::cerr << "== mapped image: could not read \"mapped.spn\"\n";
+        return true;
+    }
+
+    // only bytes inside regions are defined on copied images
+    auto result = false;
+    for (auto const &[start, end] : {std::pair{0x1000, 0x3100}, std::pair{0x3010, 0x3030}})
+    {
+        result = result || !std::equal(copied.memory_pointer.get() + start, copied.memory_pointer.get() + end, mapped.memory_pointer.get() + start);
+    }
+    result = result || mapped.memory_pointer[0x1800] != 0 || mapped.memory_pointer[0x2800] != 0 || mapped.memory_pointer[0x4fff] != 0;
+    result = result || mapped.memory_pointer[0x1810] != data[0x810] || mapped.memory_pointer[0x3010] != data[0x2100];
+
+    std::cerr << "== mapped image: " << (result ? "in" : "") << "correct\n";
+    return result;
+}
+
 auto readfile(int, char **)
 {
     read_return read_ret;
@@ -36,5 +94,6 @@ auto readfile(int, char **)
     result += test_case("01234567.89a", read_return{FileNotFound});
     result += test_case("smaller.spn", read_return{InvalidHeader});
     result += test_case("invalid_magic.spn", read_return{MagicMismatch});
+    result += mapped_case();
     return result;
 }
\ No newline at end of file
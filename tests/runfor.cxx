@@ -0,0 +1,85 @@
+#include "../supernova.h"
+#include <iostream>
+/// this test runs threads in slices, checking budgets and statuses on the way
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x100;
+    constexpr uint64_t count = 100;
+
+    /** sums 1 to `count` into r1, running `1 + count * 3 + 1` instructions */
+    auto make_thread() -> Thread
+    {
+        ProgramBuilder program{};
+        auto loop = program.make_label();
+        program.emit(SInstruction(addi_instrc, 0, 6, count))
+            .bind(loop)
+            .emit(SInstruction(addi_instrc, 3, 3, 1))
+            .emit(RInstruction(addr_instrc, 1, 3, 1))
+            .branch(jne_instrc, 6, 3, loop)
+            .halt()
+            .memory_size(memory_size);
+
+        auto image = program.load();
+        return Thread{std::move(image.memory_pointer), memory_size, nullptr, image.entry_point};
+    }
+
+    /** slices of a few instructions add up to a full run */
+    auto sliced_case(uint64_t slice) -> int
+    {
+        auto thread = make_thread();
+        const auto expected = 1 + count * 3 + 1;
+
+        uint64_t total = 0;
+        auto slices = 0;
+        auto result = run_for(thread, slice);
+        while (result.status == BudgetExhausted)
+        {
+            ++slices;
+            total += result.executed;
+            if (result.executed != slice || result.exit_code != 0)
+            {
+                std::cerr << "== slice " << slices << " ran " << result.executed << " instructions\n";
+                return 1;
+            }
+            result = run_for(thread, slice);
+        }
+        total += result.executed;
+
+        const auto failed = result.status != ProgramEnded || result.exit_code != count * (count + 1) / 2 || total != expected;
+        std::cerr << "== slices of " << slice << ": " << total << " instructions, exit code " << result.exit_code << ", "
+                  << (failed ? "in" : "") << "correct\n";
+
+        // a stopped thread does not run anymore
+        const auto again = run_for(thread, slice);
+        return failed || again.status != ProgramEnded || again.executed != 0;
+    }
+
+    /** faulting while raising a fault destroys the thread */
+    auto fault_case() -> int
+    {
+        ProgramBuilder program{};
+        program.emit(SInstruction(ld_dwrd_instrc, 0, 4, memory_size)).memory_size(memory_size);
+
+        Thread thread{program.load().memory_pointer, memory_size, nullptr};
+        thread.registers(1) = memory_size; // stack out of range, the processor state can not be pushed
+
+        const auto result = run_for(thread, 10);
+        const auto failed = result.status != ProgramFaulted || result.exit_code != InterruptCrashLoop;
+        std::cerr << "== fault: " << (failed ? "in" : "") << "correct\n";
+        return failed;
+    }
+} // namespace
+
+int runfor(int, char **)
+{
+    auto result = 0;
+    for (uint64_t slice : {1, 7, 64, 1000})
+    {
+        result += sliced_case(slice);
+    }
+    result += fault_case();
+    return result;
+}
@@ -0,0 +1,62 @@
+#include "../supernova.h"
+#include <iostream>
+#include <memory>
+#include <vector>
+/// this test runs many threads on a few workers, with a quantum small enough to preempt all of them
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x100;
+    constexpr auto thread_count = 64;
+
+    /** sums 1 to `count` into r1, the exit code */
+    auto make_thread(uint64_t count) -> std::unique_ptr<Thread>
+    {
+        ProgramBuilder program{};
+        auto loop = program.make_label();
+        program.emit(SInstruction(addi_instrc, 0, 6, count))
+            .bind(loop)
+            .emit(SInstruction(addi_instrc, 3, 3, 1))
+            .emit(RInstruction(addr_instrc, 1, 3, 1))
+            .branch(jne_instrc, 6, 3, loop)
+            .halt()
+            .memory_size(memory_size);
+
+        auto image = program.load();
+        return std::make_unique<Thread>(std::move(image.memory_pointer), memory_size, nullptr, image.entry_point);
+    }
+} // namespace
+
+int scheduler(int, char **)
+{
+    auto result = 0;
+    supernova::scheduler pool{4, 7};
+
+    std::vector<uint64_t> counts(thread_count);
+    for (auto i = 0; i < thread_count; ++i)
+    {
+        counts[i] = 10 + i * 3;
+        const auto id = pool.submit(make_thread(counts[i]));
+        result += id != static_cast<uint64_t>(i);
+    }
+
+    std::vector<bool> seen(thread_count, false);
+    for (auto i = 0; i < thread_count; ++i)
+    {
+        auto done = pool.wait();
+        const auto expected = static_cast<int>(counts[done.id] * (counts[done.id] + 1) / 2);
+        if (!done.result.first || done.result.second != expected || seen[done.id] || done.thread == nullptr)
+        {
+            std::cerr << "== thread " << done.id << ": expected `" << expected << "`, got `" << done.result.second << "`\n";
+            ++result;
+        }
+        seen[done.id] = true;
+    }
+
+    result += pool.pending() != 0 || pool.wait().thread != nullptr;
+    std::cerr << "== " << thread_count << " threads on " << pool.workers() << " workers: " << (result ? "in" : "") << "correct\n";
+
+    return result;
+}
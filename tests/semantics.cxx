@@ -0,0 +1,66 @@
+#include "../supernova.h"
+#include <iostream>
+#include <memory>
+#include <vector>
+/// this test checks operands the interpreter reads for shifts, immediate divisions and pushes, and that a run goes until halt
+
+using namespace supernova;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x1000;
+    constexpr uint64_t handler = 0x400;
+    constexpr uint64_t vector = 0x800;
+    constexpr uint64_t stack = 0xC00;
+
+    /** code at 0, a `DivisionByZero` handler setting r10 = 1 and halting */
+    auto make_thread(std::vector<uint64_t> const &code) -> Thread
+    {
+        auto memory = std::unique_ptr<uint8_t[]>(new uint8_t[memory_size]{});
+        auto *words = reinterpret_cast<uint64_t *>(memory.get());
+        std::copy(code.begin(), code.end(), words);
+
+        words[vector / sizeof(uint64_t) + ProcessorCall::DivisionByZero] = handler;
+        words[handler / sizeof(uint64_t) + 0] = static_cast<uint64_t>(SInstruction(addi_instrc, 0, 10, 1));
+        words[handler / sizeof(uint64_t) + 1] = static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt));
+
+        auto thread = Thread{std::move(memory), memory_size, nullptr};
+        thread.intvec() = vector;
+        thread.registers(1) = stack;
+        return thread;
+    }
+} // namespace
+
+int semantics(int, char **)
+{
+    // r6 = r4 >> r5, r7 = r4 / 8, r8 = -64 / -8, then push r4 + 3
+    auto thread = make_thread({
+        static_cast<uint64_t>(SInstruction(addi_instrc, 0, 4, 0x100)),
+        static_cast<uint64_t>(SInstruction(addi_instrc, 0, 5, 4)),
+        static_cast<uint64_t>(RInstruction(lrsr_instrc, 4, 5, 6)),
+        static_cast<uint64_t>(SInstruction(udivi_instrc, 4, 7, 8)),
+        static_cast<uint64_t>(SInstruction(subi_instrc, 0, 9, 64)),
+        static_cast<uint64_t>(SInstruction(sdivi_instrc, 9, 8, -8LLU)),
+        static_cast<uint64_t>(SInstruction(push_instrc, 1, 4, 3)),
+        static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt)),
+    });
+
+    const auto ran = run(0, nullptr, thread);
+    const auto *words = reinterpret_cast<uint64_t const *>(thread.memory().get());
+    auto result = !ran.first || thread.signal() != ProgramEnd || thread.registers(6) != 0x10 || thread.registers(7) != 0x20 ||
+                  thread.registers(8) != 8 || words[stack / sizeof(uint64_t)] != 0x103 || thread.registers(1) != stack + sizeof(uint64_t) ||
+                  thread.registers(10) != 0;
+
+    // only a zero immediate divides by zero, whatever the register it used to name holds
+    auto zero = make_thread({
+        static_cast<uint64_t>(SInstruction(addi_instrc, 0, 4, 0x100)),
+        static_cast<uint64_t>(SInstruction(udivi_instrc, 4, 7, 0)),
+        static_cast<uint64_t>(LInstruction(pcall_instrc, 0, ProcessorCall::Halt)),
+    });
+    run(0, nullptr, zero);
+    result = result || zero.pcall() != ProcessorCall::DivisionByZero || zero.registers(10) != 1 || zero.registers(7) != 0;
+
+    std::cerr << "== operands: r6 = `0x" << std::hex << thread.registers(6) << "`, r7 = `0x" << thread.registers(7) << std::dec << "`, r8 = `"
+              << thread.registers(8) << "`, " << (result ? "in" : "") << "correct\n";
+    return result;
+}
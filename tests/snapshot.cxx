@@ -0,0 +1,84 @@
+#include "../supernova.h"
+#include <iostream>
+/// this test forks threads from a snapshot taken halfway through a program
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x3000;
+    constexpr auto counter = 0x2000;
+
+    /** counts up to ten, keeping the counter both in memory and on r3 */
+    auto make_thread(uint64_t size = memory_size) -> Thread
+    {
+        ProgramBuilder program{};
+        auto loop = program.make_label();
+        program.emit(SInstruction(addi_instrc, 0, 7, 10))
+            .emit(SInstruction(ld_dwrd_instrc, 0, 3, counter))
+            .bind(loop)
+            .emit(SInstruction(addi_instrc, 3, 3, 1))
+            .emit(SInstruction(st_dwrd_instrc, 3, 0, counter))
+            .emit(SInstruction(subi_instrc, 7, 7, 1))
+            .branch(jne_instrc, 0, 7, loop)
+            .halt()
+            .memory_size(size);
+
+        auto image = program.load();
+        return Thread{std::move(image.memory_pointer), size, nullptr, image.entry_point};
+    }
+
+    auto read_counter(Thread &thread) -> uint64_t
+    {
+        return *reinterpret_cast<uint64_t *>(thread.memory().get() + counter);
+    }
+} // namespace
+
+int snapshot(int, char **)
+{
+    auto result = 0;
+    auto original = make_thread();
+
+    // stop in the middle of the loop
+    dispatch(original, SwitchDispatch, 2 + 5 * 4);
+    const auto saved = original.snapshot();
+    const auto halfway = read_counter(original);
+
+    run(0, nullptr, original);
+
+    auto first = Thread::fork_from(saved);
+    auto second = Thread::fork_from(saved);
+
+    result += first.progc() != 2 * sizeof(uint64_t) || first.registers(7) != 5 || read_counter(first) != halfway;
+    std::cerr << "== forked state" << (saved.shared() ? "" : " (copied)") << ": expected counter `" << halfway << "`, got `" << read_counter(first) << "`\n";
+
+    run(0, nullptr, first);
+    result += first.registers(3) != original.registers(3) || read_counter(first) != read_counter(original);
+    std::cerr << "== forked thread: expected `" << original.registers(3) << "`, got `" << first.registers(3) << "`\n";
+
+    // writes from the first fork are not seen by the second one
+    result += read_counter(second) != halfway;
+    run(0, nullptr, second);
+    result += second.registers(3) != original.registers(3);
+    std::cerr << "== second fork: expected `" << original.registers(3) << "`, got `" << second.registers(3) << "`\n";
+
+    // forks keep guard pages without copying memory again
+    auto guarded = make_thread();
+    if (guarded.use_guard_pages())
+    {
+        auto fork = Thread::fork_from(guarded.snapshot());
+        run(0, nullptr, fork);
+        result += fork.backend() != GuardedMemory || fork.registers(3) != 10;
+        std::cerr << "== guarded fork: " << (fork.backend() == GuardedMemory ? "guarded" : "checked") << ", r3 = `" << fork.registers(3) << "`\n";
+    }
+
+    // memory not ending on a double word still gets mapped aligned
+    auto odd = make_thread(memory_size - 4);
+    auto odd_fork = Thread::fork_from(odd.snapshot());
+    run(0, nullptr, odd_fork);
+    const auto aligned = reinterpret_cast<uintptr_t>(odd_fork.memory().get()) % sizeof(uint64_t) == 0;
+    result += !aligned || odd_fork.registers(3) != 10 || read_counter(odd_fork) != 10;
+    std::cerr << "== odd sized fork: " << (aligned ? "aligned" : "misaligned") << ", r3 = `" << odd_fork.registers(3) << "`\n";
+
+    return result;
+}
@@ -0,0 +1,88 @@
+#include "../supernova.h"
+#include <iostream>
+#include <sstream>
+/// this test checks the interpreter counters, and how they are written
+
+using namespace supernova;
+
+namespace
+{
+    constexpr auto memory_size = 0x100;
+    constexpr uint64_t count = 10;
+    constexpr uint64_t syscall = 20;
+
+    void ignore(Thread &, void *) noexcept {}
+
+    /** stores and loads `count` double words, looping on `jne`, then takes a bound processor call */
+    auto make_thread() -> Thread
+    {
+        ProgramBuilder program{};
+        auto loop = program.make_label();
+        program.emit(SInstruction(addi_instrc, 0, 6, count))
+            .bind(loop)
+            .emit(SInstruction(addi_instrc, 3, 3, 1))
+            .emit(SInstruction(st_dwrd_instrc, 3, 0, 0x80))
+            .emit(SInstruction(ld_byte_instrc, 0, 4, 0x80))
+            .branch(jne_instrc, 6, 3, loop)
+            .emit(LInstruction(pcall_instrc, 0, syscall))
+            .halt()
+            .memory_size(memory_size);
+
+        auto image = program.load();
+        auto thread = Thread{std::move(image.memory_pointer), memory_size, nullptr, image.entry_point};
+        static_cast<void>(thread.bind_pcall(syscall, ignore));
+        return thread;
+    }
+
+    /** the written counters leave zeroes out */
+    auto format_case() -> int
+    {
+        execution_stats stats{};
+        stats.opcodes[addi_instrc] = 3;
+        stats.opcodes[jne_instrc] = 2;
+        stats.taken[jne_instrc - je_instrc] = 1;
+        stats.not_taken[jne_instrc - je_instrc] = 1;
+        stats.stores[3] = 4;
+        stats.pcalls[ProcessorCall::Halt + 1] = 1;
+        stats.pcalls[syscall + 1] = 2;
+
+        std::ostringstream json;
+        write_stats(json, stats, StatsJson);
+        const auto expected = std::string{
+            "{\"opcodes\":{\"addi\":3,\"jne\":2},\"branches\":{\"jne\":{\"taken\":1,\"not_taken\":1}},"
+            "\"memory\":{\"dwrd\":{\"loads\":0,\"stores\":4}},\"pcalls\":{\"Halt\":1,\"pcall 20\":2},\"fused\":{}}\n"};
+
+        std::ostringstream table;
+        write_stats(table, stats, StatsTable);
+
+        const auto failed = json.str() != expected || table.str().find("addi") == std::string::npos;
+        std::cerr << "== json: " << json.str();
+        return failed;
+    }
+} // namespace
+
+int stats(int, char **)
+{
+    auto result = format_case();
+
+#ifdef SUPERNOVA_STATS
+    auto thread = make_thread();
+    run_for(thread, ~0LLU);
+
+    auto const &counted = thread.stats();
+    result += counted.opcodes[addi_instrc] != 1 + count;
+    result += counted.opcodes[jne_instrc] != count;
+    result += counted.taken[jne_instrc - je_instrc] != count - 1;
+    result += counted.not_taken[jne_instrc - je_instrc] != 1;
+    result += counted.loads[0] != count || counted.stores[3] != count;
+    result += counted.pcalls[ProcessorCall::Halt + 1] != 1 || counted.pcalls[syscall + 1] != 1;
+    write_stats(std::cerr, counted, StatsTable);
+#else
+    // nothing gets counted, the thread only needs to run the same
+    auto thread = make_thread();
+    result += run_for(thread, ~0LLU).status != ProgramEnded;
+#endif
+
+    std::cerr << "== stats " << (stats_enabled ? "" : "(not built in) ") << (result ? "in" : "") << "correct\n";
+    return result;
+}
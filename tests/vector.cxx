@@ -0,0 +1,119 @@
+#include "../supernova.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+/// this test runs group 7 on every vector width the host supports and checks lanes past the width stay untouched
+
+using namespace supernova;
+
+namespace
+{
+    constexpr uint64_t memory_size = 0x1000;
+    constexpr uint64_t left = 0x200;
+    constexpr uint64_t right = 0x300;
+    constexpr uint64_t sums = 0x400;
+    constexpr uint64_t products = 0x500;
+    constexpr uint64_t interrupts = 0x800;
+    constexpr uint64_t lane_count = max_vector_width / sizeof(uint64_t);
+
+    /** bytes of double words, for data regions */
+    auto bytes_of(std::vector<uint64_t> const &words) -> std::vector<uint8_t>
+    {
+        std::vector<uint8_t> bytes(words.size() * sizeof(uint64_t));
+        std::memcpy(bytes.data(), words.data(), bytes.size());
+        return bytes;
+    }
+
+    /** load a program followed by the `MemoryLimit` handler halting, with both operands as many lanes as fit */
+    auto make_thread(ProgramBuilder &program) -> Thread
+    {
+        std::vector<uint64_t> first(lane_count);
+        std::vector<uint64_t> second(lane_count);
+        for (uint64_t i = 0; i < lane_count; i++)
+        {
+            first[i] = i + 1;
+            second[i] = 10 * (i + 1);
+        }
+
+        const auto handler = program.here();
+        program.halt()
+            .data(left, bytes_of(first))
+            .data(right, bytes_of(second))
+            .data(interrupts + ProcessorCall::MemoryLimit * sizeof(uint64_t), bytes_of({handler}))
+            .memory_size(memory_size);
+
+        auto image = program.load();
+        auto thread = Thread{std::move(image.memory_pointer), memory_size, nullptr, image.entry_point};
+        thread.intvec() = interrupts;
+        thread.registers(1) = 0xC00;
+        return thread;
+    }
+
+    int check_width(uint64_t width)
+    {
+        const auto lanes = width / sizeof(uint64_t);
+        ProgramBuilder program{};
+        program.emit(SInstruction(vld_instrc, 0, 1, left))
+            .emit(SInstruction(vld_instrc, 0, 2, right))
+            .emit(RInstruction(vadd_instrc, 1, 2, 3))
+            .emit(RInstruction(vmul_instrc, 1, 2, 4))
+            .emit(SInstruction(subi_instrc, 0, 7, 1))
+            .emit(RInstruction(vbrd_instrc, 7, 0, 6))
+            .emit(RInstruction(vcgts_instrc, 1, 6, 5))
+            .emit(RInstruction(vcgtu_instrc, 1, 6, 8))
+            .emit(SInstruction(vst_instrc, 3, 0, sums))
+            .emit(SInstruction(vst_instrc, 4, 0, products))
+            .emit(SInstruction(vext_instrc, 5, 9, lanes - 1))
+            .emit(SInstruction(vext_instrc, 8, 10, 0))
+            // `pcall -1` 2:1 gives back the flags and the width
+            .constant(Thread::pcall_reg, (2ULL << 32U) | 1U)
+            .emit(LInstruction(pcall_instrc, 0, ProcessorCall::Functions))
+            // a whole vector does not fit on the last double word
+            .emit(SInstruction(vld_instrc, 0, 11, memory_size - sizeof(uint64_t) / 2));
+
+        auto thread = make_thread(program);
+        if (!thread.use_vector_width(width))
+        {
+            std::cerr << "== vector width " << width << ": not supported by the host\n";
+            return 0;
+        }
+
+        run(0, nullptr, thread);
+
+        const auto *words = reinterpret_cast<uint64_t const *>(thread.memory().get());
+        auto result = thread.signal() != ProgramEnd || thread.pcall() != ProcessorCall::MemoryLimit ||
+                      thread.registers(9) != ~0ULL || thread.registers(10) != 0 ||
+                      thread.registers(Thread::pcall_1stret) != config_flags(width) || thread.registers(Thread::pcall_2ndret) != width;
+
+        for (uint64_t i = 0; i < lane_count; i++)
+        {
+            const auto sum = i < lanes ? 11 * (i + 1) : 0;
+            const auto product = i < lanes ? 10 * (i + 1) * (i + 1) : 0;
+            result = result || words[sums / sizeof(uint64_t) + i] != sum || words[products / sizeof(uint64_t) + i] != product;
+        }
+
+        std::cerr << "== vector width " << width << ": flags 0x" << std::hex << thread.registers(Thread::pcall_1stret) << std::dec
+                  << ", " << (result ? "in" : "") << "correct\n";
+        return result;
+    }
+
+    int check_host()
+    {
+        ProgramBuilder program{};
+        auto thread = make_thread(program);
+        const auto width = thread.vector_width();
+
+        // widths the host lacks or that are no power of two leave the thread as it was
+        const auto result = width != host_vector_width() || width < sizeof(uint64_t) || width > max_vector_width ||
+                            thread.use_vector_width(2 * max_vector_width) || thread.use_vector_width(24) ||
+                            thread.vector_width() != width || (config_flags(width) & confflags_multi64) == 0;
+
+        std::cerr << "== host vectors: " << width << " bytes, " << (result ? "in" : "") << "correct\n";
+        return result;
+    }
+} // namespace
+
+int vector(int, char **)
+{
+    return check_host() + check_width(8) + check_width(16) + check_width(32) + check_width(64);
+}
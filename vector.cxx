@@ -0,0 +1,221 @@
+#include "supernova.h"
+#include <cstring>
+
+// gcc and clang lower vector types to whatever the target has
+#if defined(__GNUC__)
+#define SUPERNOVA_VECTOR_EXTENSIONS 1
+#endif
+
+// wider kernels get compiled for their own instruction sets and picked at runtime
+#if defined(__x86_64__) && defined(SUPERNOVA_VECTOR_EXTENSIONS)
+#define SUPERNOVA_VECTOR_X86_64 1
+#endif
+
+namespace
+{
+    using Opcodes = supernova::inspx;
+    using vector_register = supernova::vector_register;
+
+    /**
+     * @brief single double word kernel, every host is able to run it
+     */
+    void kernel64(Opcodes opcode, vector_register &rd, vector_register const &r1, vector_register const &r2) noexcept
+    {
+        const auto left = r1.lanes[0];
+        const auto right = r2.lanes[0];
+
+        switch (opcode)
+        {
+        case Opcodes::vadd_instrc:
+            rd.lanes[0] = left + right;
+            break;
+        case Opcodes::vsub_instrc:
+            rd.lanes[0] = left - right;
+            break;
+        case Opcodes::vmul_instrc:
+            rd.lanes[0] = left * right;
+            break;
+        case Opcodes::vand_instrc:
+            rd.lanes[0] = left & right;
+            break;
+        case Opcodes::vor_instrc:
+            rd.lanes[0] = left | right;
+            break;
+        case Opcodes::vxor_instrc:
+            rd.lanes[0] = left ^ right;
+            break;
+        case Opcodes::vceq_instrc:
+            rd.lanes[0] = left == right ? ~0LLU : 0;
+            break;
+        case Opcodes::vcgtu_instrc:
+            rd.lanes[0] = left > right ? ~0LLU : 0;
+            break;
+        case Opcodes::vcgts_instrc:
+            rd.lanes[0] = static_cast<int64_t>(left) > static_cast<int64_t>(right) ? ~0LLU : 0;
+            break;
+        default:
+            break;
+        }
+    }
+
+#ifdef SUPERNOVA_VECTOR_EXTENSIONS
+    using lanes128 = uint64_t __attribute__((vector_size(16)));
+    using signed128 = int64_t __attribute__((vector_size(16)));
+    using lanes256 = uint64_t __attribute__((vector_size(32)));
+    using signed256 = int64_t __attribute__((vector_size(32)));
+    using lanes512 = uint64_t __attribute__((vector_size(64)));
+    using signed512 = int64_t __attribute__((vector_size(64)));
+
+    /**
+     * @brief lane-wise operation on host vectors, inlined into a kernel compiled for their width
+     *
+     * @tparam lanes unsigned vector type
+     * @tparam signed_lanes signed vector type of the same width
+     */
+    template <typename lanes, typename signed_lanes>
+    [[gnu::always_inline]] inline void apply(Opcodes opcode, vector_register &rd, vector_register const &r1, vector_register const &r2) noexcept
+    {
+        lanes left;
+        lanes right;
+        lanes result;
+        std::memcpy(&left, r1.lanes.data(), sizeof(lanes));
+        std::memcpy(&right, r2.lanes.data(), sizeof(lanes));
+
+        // compares give signed lanes, all ones when true
+        signed_lanes mask;
+
+        switch (opcode)
+        {
+        case Opcodes::vadd_instrc:
+            result = left + right;
+            break;
+        case Opcodes::vsub_instrc:
+            result = left - right;
+            break;
+        case Opcodes::vmul_instrc:
+            result = left * right;
+            break;
+        case Opcodes::vand_instrc:
+            result = left & right;
+            break;
+        case Opcodes::vor_instrc:
+            result = left | right;
+            break;
+        case Opcodes::vxor_instrc:
+            result = left ^ right;
+            break;
+        case Opcodes::vceq_instrc:
+            mask = left == right;
+            std::memcpy(&result, &mask, sizeof(lanes));
+            break;
+        case Opcodes::vcgtu_instrc:
+            mask = left > right;
+            std::memcpy(&result, &mask, sizeof(lanes));
+            break;
+        case Opcodes::vcgts_instrc:
+        {
+            signed_lanes signed_left;
+            signed_lanes signed_right;
+            std::memcpy(&signed_left, &left, sizeof(lanes));
+            std::memcpy(&signed_right, &right, sizeof(lanes));
+            mask = signed_left > signed_right;
+            std::memcpy(&result, &mask, sizeof(lanes));
+            break;
+        }
+        default:
+            return;
+        }
+
+        std::memcpy(rd.lanes.data(), &result, sizeof(lanes));
+    }
+
+    /**
+     * @brief 128 bit kernel, SSE2 on x86-64 and whatever the compiler targets elsewhere
+     */
+    void kernel128(Opcodes opcode, vector_register &rd, vector_register const &r1, vector_register const &r2) noexcept
+    {
+        apply<lanes128, signed128>(opcode, rd, r1, r2);
+    }
+#endif
+
+#ifdef SUPERNOVA_VECTOR_X86_64
+    /**
+     * @brief 256 bit kernel, only called on hosts with AVX2
+     */
+    [[gnu::target("avx2")]] void kernel256(Opcodes opcode, vector_register &rd, vector_register const &r1, vector_register const &r2) noexcept
+    {
+        apply<lanes256, signed256>(opcode, rd, r1, r2);
+    }
+
+    /**
+     * @brief 512 bit kernel, only called on hosts with AVX-512
+     */
+    [[gnu::target("avx512f")]] void kernel512(Opcodes opcode, vector_register &rd, vector_register const &r1, vector_register const &r2) noexcept
+    {
+        apply<lanes512, signed512>(opcode, rd, r1, r2);
+    }
+#endif
+} // namespace
+
+namespace supernova
+{
+    auto host_vector_width() noexcept -> uint64_t
+    {
+        static const auto width = []() -> uint64_t
+        {
+#if defined(SUPERNOVA_VECTOR_X86_64)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+            {
+                return 64;
+            }
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return 32;
+            }
+            return 16;
+#elif defined(SUPERNOVA_VECTOR_EXTENSIONS)
+            return 16;
+#else
+            return 8;
+#endif
+        }();
+        return width;
+    }
+
+    auto vector_kernel_for(uint64_t width) noexcept -> vector_kernel
+    {
+        if (width > host_vector_width())
+        {
+            return nullptr;
+        }
+
+        switch (width)
+        {
+        case 8:
+            return kernel64;
+#ifdef SUPERNOVA_VECTOR_EXTENSIONS
+        case 16:
+            return kernel128;
+#endif
+#ifdef SUPERNOVA_VECTOR_X86_64
+        case 32:
+            return kernel256;
+        case 64:
+            return kernel512;
+#endif
+        default:
+            return nullptr;
+        }
+    }
+
+    auto config_flags(uint64_t vector_width) noexcept -> uint64_t
+    {
+        auto flags = config_value;
+        flags |= vector_width >= 8 ? confflags_multi64 : 0;
+        flags |= vector_width >= 16 ? confflags_multi128 : 0;
+        flags |= vector_width >= 32 ? confflags_multi256 : 0;
+        flags |= vector_width >= 64 ? confflags_multi512 : 0;
+        return flags;
+    }
+} // namespace supernova